@@ -0,0 +1,431 @@
+/**
+ * Per-note hot path microbenchmarks (host build)
+ *
+ * Runs each hot path a fixed number of times after a warm-up and reports
+ * the best of several runs as ns/op and, where the kernel allows user-space
+ * perf counters, retired instructions/op. With --baseline the results are
+ * compared against a stored JSON file and the program exits non-zero on a
+ * regression, which makes the `bench` target fail.
+ *
+ *   firmware_bench [--baseline FILE] [--write-baseline FILE]
+ */
+
+#include "hal_host.h"
+#include "midi_synthesizer.h"
+#include "midi_handler.h"
+#include "usb_midi.h"
+#include "configuration_settings.h"
+#include "i2c_midi.h"
+#include "i2c_pca9685_midi.h"
+#include "mallet_midi.h"
+#include "oled_display.h"
+#include "lissajous_screensaver.h"
+#include "menu_handler.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define BENCH_RUNS                10      // Best of N runs is reported
+#define BENCH_WARMUP_DIVISOR      10      // Warm-up = iterations / 10
+
+// Allowed slowdown against the baseline before a benchmark fails
+#define BENCH_DEFAULT_INSTR_TOLERANCE  0.05   // Instruction counts are stable
+#define BENCH_DEFAULT_TIME_TOLERANCE   0.50   // Wall time is noisy on shared machines
+
+// Board setup shared with the firmware (see src/midi_synthesizer.c)
+#define BENCH_SDA_PIN      2
+#define BENCH_SCL_PIN      3
+#define BENCH_I2C_FREQ     400000
+#define BENCH_SERVO_PIN    16
+#define BENCH_STRIKER_PIN  17
+
+//--------------------------------------------------------------------+
+// Benchmark Cases
+//--------------------------------------------------------------------+
+
+typedef struct {
+    const char *name;
+    void (*run)(uint32_t i);      // One operation; i is the iteration number
+    uint32_t iterations;
+} bench_case_t;
+
+typedef struct {
+    double ns_per_op;
+    double instructions_per_op;   // < 0 if counters are not available
+} bench_result_t;
+
+static i2c_midi_t bench_i2c_midi;
+static pca9685_midi_t bench_pca9685;
+static mallet_midi_t bench_mallet;
+static usb_midi_rx_callback_t firmware_rx;
+static volatile uint32_t sink;    // Keeps pure functions from being optimized away
+
+static const uint8_t sysex_set_channel[] = { 0xF0, 0x7D, 0x00, 0x02, 0x09, 0xF7 };
+
+static void run_i2c_midi_process_message(uint32_t i) {
+    uint8_t status = (i & 1) ? 0x89 : 0x99;  // Alternate note on / off, channel 10
+    sink += i2c_midi_process_message(&bench_i2c_midi, status, 60 + ((i >> 1) & 7), 100);
+}
+
+static void run_pca9685_midi_note_to_servo(uint32_t i) {
+    uint8_t servo = 0;
+    sink += pca9685_midi_note_to_servo(&bench_pca9685, 60 + (i & 15), &servo) + servo;
+}
+
+static void run_mallet_midi_note_to_degree(uint32_t i) {
+    uint16_t degree = 0;
+    sink += mallet_midi_note_to_degree(&bench_mallet, 60 + (i & 15), &degree) + degree;
+}
+
+static void run_internal_midi_handler(uint32_t i) {
+    uint8_t status = (i & 1) ? 0x89 : 0x99;
+    firmware_rx(status, 60 + ((i >> 1) & 7), 100, NULL);
+}
+
+static void run_process_sysex_message(uint32_t i) {
+    (void)i;
+    for (size_t n = 0; n < sizeof(sysex_set_channel); n++) {
+        firmware_rx(sysex_set_channel[n], 0, 0, NULL);
+    }
+}
+
+static void run_calculate_crc16(uint32_t i) {
+    static config_settings_t settings;
+    settings.midi_channel = (uint8_t)i;
+    sink += config_calculate_crc16((const uint8_t *)&settings,
+                                   sizeof(settings) - sizeof(settings.crc));
+}
+
+static void run_oled_draw_string(uint32_t i) {
+    (void)i;
+    oled_draw_string(0, 16, " Note: C4 (60)");
+}
+
+static void run_oled_display_single_note(uint32_t i) {
+    oled_display_single_note(60 + (i & 7), 100, 9);
+}
+
+static void run_lissajous_screensaver_update(uint32_t i) {
+    (void)i;
+    lissajous_screensaver_update();
+}
+
+static void run_oled_screensaver_update(uint32_t i) {
+    (void)i;
+    oled_screensaver_update();
+}
+
+// Last in the table: the menu stays open once entered. Each operation is
+// one click, so the highlighted option moves every time.
+static void run_menu_update_display(uint32_t i) {
+    (void)i;
+    if (!menu_is_active()) {
+        menu_enter();
+    }
+    menu_next();
+}
+
+static const bench_case_t bench_cases[] = {
+    { "i2c_midi_process_message",     run_i2c_midi_process_message,     100000 },
+    { "pca9685_midi_note_to_servo",   run_pca9685_midi_note_to_servo,   1000000 },
+    { "mallet_midi_note_to_degree",   run_mallet_midi_note_to_degree,   1000000 },
+    { "internal_midi_handler",        run_internal_midi_handler,        10000 },
+    { "process_sysex_message",        run_process_sysex_message,        10000 },
+    { "calculate_crc16",              run_calculate_crc16,              100000 },
+    { "oled_draw_string",             run_oled_draw_string,             100000 },
+    { "oled_display_single_note",     run_oled_display_single_note,     5000 },
+    { "lissajous_screensaver_update", run_lissajous_screensaver_update, 2000 },
+    { "oled_screensaver_update",      run_oled_screensaver_update,      20000 },
+    { "menu_update_display",          run_menu_update_display,          5000 },
+};
+
+#define BENCH_NUM_CASES (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+/**
+ * Bring the firmware up the way main() does, then create standalone player
+ * contexts for the mapping benchmarks
+ */
+static bool bench_setup(void) {
+    hal_host_reset();
+
+    uint32_t blink_ms = 0;
+    if (!midi_synthesizer_setup(&blink_ms)) {
+        return false;
+    }
+    hal_host_usb_set_mounted(true);
+    firmware_rx = (usb_midi_rx_callback_t)midi_handler_get_callback();
+
+    i2c_midi_config_t midi_config = {
+        .note_range = 8,
+        .low_note = 60,
+        .high_note = 67,
+        .midi_channel = 10,
+        .io_address = 0x20,
+        .i2c_port = i2c1,
+        .io_type = IO_EXPANDER_PCF8574,
+        .semitone_mode = I2C_MIDI_SEMITONE_PLAY
+    };
+    if (!i2c_midi_init_with_config(&bench_i2c_midi, &midi_config, BENCH_SDA_PIN, BENCH_SCL_PIN, BENCH_I2C_FREQ) ||
+        !pca9685_midi_init(&bench_pca9685, i2c1, BENCH_SDA_PIN, BENCH_SCL_PIN, BENCH_I2C_FREQ) ||
+        !mallet_midi_init(&bench_mallet, BENCH_SERVO_PIN, BENCH_STRIKER_PIN)) {
+        return false;
+    }
+
+    lissajous_screensaver_init();
+    oled_screensaver_init();
+    return true;
+}
+
+//--------------------------------------------------------------------+
+// Measurement
+//--------------------------------------------------------------------+
+
+static int perf_fd = -1;
+
+static void perf_open(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static bench_result_t bench_run(const bench_case_t *c) {
+    bench_result_t best = { -1.0, -1.0 };
+
+    for (uint32_t i = 0; i < c->iterations / BENCH_WARMUP_DIVISOR; i++) {
+        c->run(i);
+    }
+
+    for (int r = 0; r < BENCH_RUNS; r++) {
+        if (perf_fd >= 0) {
+            ioctl(perf_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        uint64_t start = now_ns();
+        for (uint32_t i = 0; i < c->iterations; i++) {
+            c->run(i);
+        }
+        uint64_t elapsed = now_ns() - start;
+
+        double ns = (double)elapsed / c->iterations;
+        if (best.ns_per_op < 0 || ns < best.ns_per_op) {
+            best.ns_per_op = ns;
+        }
+
+        if (perf_fd >= 0) {
+            uint64_t count = 0;
+            ioctl(perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(perf_fd, &count, sizeof(count)) == sizeof(count)) {
+                double instr = (double)count / c->iterations;
+                if (best.instructions_per_op < 0 || instr < best.instructions_per_op) {
+                    best.instructions_per_op = instr;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+//--------------------------------------------------------------------+
+// Baseline File
+//--------------------------------------------------------------------+
+
+static bool write_baseline(const char *path, const bench_result_t *results) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "{\n  \"compiler\": \"%s\",\n  \"benchmarks\": {\n", __VERSION__);
+    for (size_t i = 0; i < BENCH_NUM_CASES; i++) {
+        fprintf(f, "    \"%s\": { \"ns_per_op\": %.1f, \"instructions_per_op\": %.1f }%s\n",
+                bench_cases[i].name, results[i].ns_per_op, results[i].instructions_per_op,
+                i + 1 < BENCH_NUM_CASES ? "," : "");
+    }
+    fprintf(f, "  }\n}\n");
+    fclose(f);
+    return true;
+}
+
+/**
+ * Read the baseline written by write_baseline()
+ *
+ * Only that layout is understood: one benchmark per line. Benchmarks not
+ * in the file are left at -1 and reported as new.
+ */
+static bool read_baseline(const char *path, bench_result_t *baseline) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+
+    for (size_t i = 0; i < BENCH_NUM_CASES; i++) {
+        baseline[i].ns_per_op = -1.0;
+        baseline[i].instructions_per_op = -1.0;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char name[64];
+        double ns, instr;
+        if (sscanf(line, " \"%63[^\"]\": { \"ns_per_op\": %lf, \"instructions_per_op\": %lf",
+                   name, &ns, &instr) != 3) {
+            continue;
+        }
+        for (size_t i = 0; i < BENCH_NUM_CASES; i++) {
+            if (strcmp(name, bench_cases[i].name) == 0) {
+                baseline[i].ns_per_op = ns;
+                baseline[i].instructions_per_op = instr;
+            }
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static double change_percent(double value, double base) {
+    return base > 0 ? (value - base) * 100.0 / base : 0.0;
+}
+
+//--------------------------------------------------------------------+
+// Main
+//--------------------------------------------------------------------+
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --baseline FILE         compare against FILE, exit 1 on regression\n"
+        "  --write-baseline FILE   store the results as the new baseline\n"
+        "  --instr-tolerance X     allowed instruction increase (default %.2f)\n"
+        "  --time-tolerance X      allowed ns/op increase (default %.2f)\n"
+        "  --filter TEXT           only run benchmarks whose name contains TEXT\n",
+        argv0, BENCH_DEFAULT_INSTR_TOLERANCE, BENCH_DEFAULT_TIME_TOLERANCE);
+}
+
+int main(int argc, char **argv) {
+    const char *baseline_path = NULL;
+    const char *write_path = NULL;
+    const char *filter = NULL;
+    double instr_tolerance = BENCH_DEFAULT_INSTR_TOLERANCE;
+    double time_tolerance = BENCH_DEFAULT_TIME_TOLERANCE;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--baseline") == 0) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--write-baseline") == 0) {
+            write_path = argv[++i];
+        } else if (strcmp(argv[i], "--instr-tolerance") == 0) {
+            instr_tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--time-tolerance") == 0) {
+            time_tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0) {
+            filter = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!bench_setup()) {
+        fprintf(stderr, "firmware_bench: firmware setup failed\n");
+        return 1;
+    }
+
+    perf_open();
+    if (perf_fd < 0) {
+        printf("Instruction counters not available (perf_event_paranoid?), timing only\n");
+    }
+
+    bench_result_t baseline[BENCH_NUM_CASES];
+    bool have_baseline = false;
+    if (baseline_path) {
+        have_baseline = read_baseline(baseline_path, baseline);
+        if (!have_baseline) {
+            fprintf(stderr, "firmware_bench: can't read %s\n", baseline_path);
+            return 1;
+        }
+    }
+
+    bench_result_t results[BENCH_NUM_CASES];
+    int regressions = 0;
+
+    printf("%-30s %10s %12s", "benchmark", "ns/op", "instr/op");
+    if (have_baseline) {
+        printf(" %9s %9s", "ns", "instr");
+    }
+    printf("\n");
+
+    for (size_t i = 0; i < BENCH_NUM_CASES; i++) {
+        const bench_case_t *c = &bench_cases[i];
+        if (filter && !strstr(c->name, filter)) {
+            results[i].ns_per_op = -1.0;
+            results[i].instructions_per_op = -1.0;
+            continue;
+        }
+
+        results[i] = bench_run(c);
+        printf("%-30s %10.1f %12.1f", c->name, results[i].ns_per_op, results[i].instructions_per_op);
+
+        if (have_baseline) {
+            const bench_result_t *b = &baseline[i];
+            if (b->ns_per_op < 0) {
+                printf("  (new)\n");
+                continue;
+            }
+
+            bool slow = results[i].ns_per_op > b->ns_per_op * (1.0 + time_tolerance);
+            bool bloated = results[i].instructions_per_op >= 0 && b->instructions_per_op > 0 &&
+                           results[i].instructions_per_op > b->instructions_per_op * (1.0 + instr_tolerance);
+            printf(" %+8.1f%%", change_percent(results[i].ns_per_op, b->ns_per_op));
+            if (results[i].instructions_per_op >= 0 && b->instructions_per_op > 0) {
+                printf(" %+8.1f%%", change_percent(results[i].instructions_per_op, b->instructions_per_op));
+            }
+            if (slow || bloated) {
+                printf("  REGRESSION");
+                regressions++;
+            }
+        }
+        printf("\n");
+    }
+
+    if (write_path) {
+        if (!write_baseline(write_path, results)) {
+            fprintf(stderr, "firmware_bench: can't write %s\n", write_path);
+            return 1;
+        }
+        printf("Baseline written to %s\n", write_path);
+    }
+
+    if (perf_fd >= 0) {
+        close(perf_fd);
+    }
+
+    if (regressions) {
+        printf("%d benchmark(s) regressed against %s\n", regressions, baseline_path);
+        return 1;
+    }
+    return 0;
+}
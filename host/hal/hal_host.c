@@ -0,0 +1,795 @@
+#include "hal_host.h"
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/uart.h"
+#include "hardware/clocks.h"
+#include "tusb.h"
+#include <stdio.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Internal State
+//--------------------------------------------------------------------+
+
+#define HAL_HOST_MAX_ALARMS 16
+#define HAL_HOST_USB_QUEUE_SIZE 256
+#define HAL_HOST_SYS_CLOCK_HZ 125000000u
+
+typedef struct {
+    bool active;
+    alarm_id_t id;
+    uint64_t target_us;
+    alarm_callback_t callback;
+    void *user_data;
+} hal_alarm_t;
+
+typedef struct {
+    bool out;
+    bool level;
+    bool pull_up;
+    bool pull_down;
+    bool input_driven;
+    bool input_level;
+    enum gpio_function function;
+} hal_gpio_t;
+
+// A DMA transfer is in flight from start until it is waited for or polled
+typedef struct {
+    bool claimed;
+    bool busy;
+    volatile void *write_addr;
+    const volatile void *read_addr;
+    uint32_t count;
+} hal_dma_channel_t;
+
+typedef struct {
+    bool enabled;
+    float clkdiv;
+    uint16_t wrap;
+    uint16_t level[2];
+} hal_pwm_slice_t;
+
+i2c_inst_t i2c0_inst = { .index = 0 };
+i2c_inst_t i2c1_inst = { .index = 1 };
+spi_inst_t spi0_inst = { .index = 0 };
+spi_inst_t spi1_inst = { .index = 1 };
+uart_inst_t uart0_inst = { .index = 0 };
+uart_inst_t uart1_inst = { .index = 1 };
+
+static uint64_t now_us = 0;
+static hal_alarm_t alarms[HAL_HOST_MAX_ALARMS];
+static alarm_id_t next_alarm_id = 1;
+static bool in_alarm = false;
+
+static hal_gpio_t gpios[NUM_BANK0_GPIOS];
+static hal_pwm_slice_t pwm_slices[NUM_PWM_SLICES];
+
+static hal_host_gpio_observer_t gpio_observer = NULL;
+static void *gpio_observer_data = NULL;
+static hal_host_gpio_dir_observer_t gpio_dir_observer = NULL;
+static void *gpio_dir_observer_data = NULL;
+static hal_host_pwm_observer_t pwm_observer = NULL;
+static void *pwm_observer_data = NULL;
+
+static hal_host_i2c_handler_t i2c_handler = NULL;
+static void *i2c_handler_data = NULL;
+static uint32_t i2c_program_count[2];      // i2c_init() and i2c_set_baudrate() calls
+static uint32_t i2c_timeout_us = 0;        // Timeout of the transfer in the handler
+
+static hal_dma_channel_t dma_channels[NUM_DMA_CHANNELS];
+static hal_host_spi_handler_t spi_handler = NULL;
+static void *spi_handler_data = NULL;
+
+static hal_host_uart_sink_t uart_sink = NULL;
+static void *uart_sink_data = NULL;
+
+static bool usb_mounted = false;
+static uint8_t usb_queue[HAL_HOST_USB_QUEUE_SIZE][4];
+static uint16_t usb_queue_head = 0;
+static uint16_t usb_queue_count = 0;
+static hal_host_usb_tx_handler_t usb_tx_handler = NULL;
+static void *usb_tx_handler_data = NULL;
+static uint32_t usb_tx_limit = 0;
+
+//--------------------------------------------------------------------+
+// General
+//--------------------------------------------------------------------+
+
+void hal_host_reset(void) {
+    now_us = 0;
+    memset(alarms, 0, sizeof(alarms));
+    next_alarm_id = 1;
+    in_alarm = false;
+
+    memset(gpios, 0, sizeof(gpios));
+    memset(pwm_slices, 0, sizeof(pwm_slices));
+    gpio_observer = NULL;
+    gpio_observer_data = NULL;
+    gpio_dir_observer = NULL;
+    gpio_dir_observer_data = NULL;
+    pwm_observer = NULL;
+    pwm_observer_data = NULL;
+
+    i2c0_inst.baudrate = 0;
+    i2c1_inst.baudrate = 0;
+    i2c_handler = NULL;
+    i2c_handler_data = NULL;
+    memset(i2c_program_count, 0, sizeof(i2c_program_count));
+
+    spi0_inst.baudrate = 0;
+    spi1_inst.baudrate = 0;
+    memset(dma_channels, 0, sizeof(dma_channels));
+    spi_handler = NULL;
+    spi_handler_data = NULL;
+
+    uart_sink = NULL;
+    uart_sink_data = NULL;
+
+    usb_mounted = false;
+    usb_queue_head = 0;
+    usb_queue_count = 0;
+    usb_tx_handler = NULL;
+    usb_tx_handler_data = NULL;
+    usb_tx_limit = 0;
+}
+
+//--------------------------------------------------------------------+
+// Virtual Clock and Alarms
+//--------------------------------------------------------------------+
+
+/**
+ * Fire the earliest alarm due at or before the current time
+ *
+ * @return true if an alarm fired
+ */
+static bool fire_next_alarm(void) {
+    hal_alarm_t *due = NULL;
+    for (uint8_t i = 0; i < HAL_HOST_MAX_ALARMS; i++) {
+        if (alarms[i].active && alarms[i].target_us <= now_us &&
+            (!due || alarms[i].target_us < due->target_us)) {
+            due = &alarms[i];
+        }
+    }
+    if (!due) {
+        return false;
+    }
+
+    // Alarms run "in interrupt context": no nested alarms from sleeps inside
+    uint64_t scheduled = due->target_us;
+    in_alarm = true;
+    int64_t reschedule = due->callback(due->id, due->user_data);
+    in_alarm = false;
+
+    if (!due->active) {
+        return true;  // Cancelled from its own callback
+    }
+    if (reschedule > 0) {
+        due->target_us = now_us + (uint64_t)reschedule;
+    } else if (reschedule < 0) {
+        due->target_us = scheduled + (uint64_t)(-reschedule);
+    } else {
+        due->active = false;
+    }
+    return true;
+}
+
+/**
+ * Move the clock forward, stopping at each alarm on the way
+ */
+static void advance_to(uint64_t target_us) {
+    if (in_alarm) {
+        if (target_us > now_us) {
+            now_us = target_us;
+        }
+        return;
+    }
+
+    while (true) {
+        uint64_t next = target_us;
+        for (uint8_t i = 0; i < HAL_HOST_MAX_ALARMS; i++) {
+            if (alarms[i].active && alarms[i].target_us < next) {
+                next = alarms[i].target_us;
+            }
+        }
+        if (next > now_us) {
+            now_us = next;
+        }
+        if (!fire_next_alarm() && now_us >= target_us) {
+            break;
+        }
+    }
+}
+
+uint64_t hal_host_time_us(void) {
+    return now_us;
+}
+
+void hal_host_time_set_us(uint64_t us) {
+    now_us = us;
+}
+
+void hal_host_time_advance_us(uint64_t us) {
+    advance_to(now_us + us);
+}
+
+uint64_t time_us_64(void) {
+    return now_us;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)now_us;
+}
+
+absolute_time_t get_absolute_time(void) {
+    return now_us;
+}
+
+void sleep_us(uint64_t us) {
+    advance_to(now_us + us);
+}
+
+void sleep_ms(uint32_t ms) {
+    advance_to(now_us + (uint64_t)ms * 1000);
+}
+
+void busy_wait_us(uint64_t us) {
+    advance_to(now_us + us);
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    (void)fire_if_past;
+    if (!callback) {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < HAL_HOST_MAX_ALARMS; i++) {
+        if (!alarms[i].active) {
+            alarms[i].active = true;
+            alarms[i].id = next_alarm_id++;
+            alarms[i].target_us = now_us + us;
+            alarms[i].callback = callback;
+            alarms[i].user_data = user_data;
+            return alarms[i].id;
+        }
+    }
+    return -1;
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t)ms * 1000, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    for (uint8_t i = 0; i < HAL_HOST_MAX_ALARMS; i++) {
+        if (alarms[i].active && alarms[i].id == alarm_id) {
+            alarms[i].active = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+//--------------------------------------------------------------------+
+// Clocks
+//--------------------------------------------------------------------+
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    switch (clk_index) {
+        case clk_ref:
+        case clk_rtc:
+            return 12000000u;
+        case clk_usb:
+        case clk_adc:
+            return 48000000u;
+        default:
+            return HAL_HOST_SYS_CLOCK_HZ;
+    }
+}
+
+//--------------------------------------------------------------------+
+// GPIO
+//--------------------------------------------------------------------+
+
+static hal_gpio_t* get_gpio(uint gpio) {
+    return gpio < NUM_BANK0_GPIOS ? &gpios[gpio] : NULL;
+}
+
+void gpio_init(uint gpio) {
+    hal_gpio_t *g = get_gpio(gpio);
+    if (g) {
+        g->out = false;
+        g->level = false;
+        g->function = GPIO_FUNC_SIO;
+    }
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    hal_gpio_t *g = get_gpio(gpio);
+    if (g) {
+        g->function = fn;
+    }
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    hal_gpio_t *g = get_gpio(gpio);
+    if (g) {
+        bool changed = g->out != out;
+        g->out = out;
+        if (changed && gpio_dir_observer) {
+            gpio_dir_observer(gpio, out, gpio_dir_observer_data);
+        }
+    }
+}
+
+void gpio_put(uint gpio, bool value) {
+    hal_gpio_t *g = get_gpio(gpio);
+    if (g) {
+        bool changed = g->level != value;
+        g->level = value;
+        if (changed && gpio_observer) {
+            gpio_observer(gpio, value, gpio_observer_data);
+        }
+    }
+}
+
+bool gpio_get(uint gpio) {
+    hal_gpio_t *g = get_gpio(gpio);
+    if (!g) {
+        return false;
+    }
+    if (g->out) {
+        return g->level;
+    }
+    if (g->input_driven) {
+        return g->input_level;
+    }
+    return g->pull_up;
+}
+
+void gpio_pull_up(uint gpio) {
+    hal_gpio_t *g = get_gpio(gpio);
+    if (g) {
+        g->pull_up = true;
+        g->pull_down = false;
+    }
+}
+
+void gpio_pull_down(uint gpio) {
+    hal_gpio_t *g = get_gpio(gpio);
+    if (g) {
+        g->pull_up = false;
+        g->pull_down = true;
+    }
+}
+
+void gpio_disable_pulls(uint gpio) {
+    hal_gpio_t *g = get_gpio(gpio);
+    if (g) {
+        g->pull_up = false;
+        g->pull_down = false;
+    }
+}
+
+void hal_host_gpio_set_input(uint pin, bool level) {
+    hal_gpio_t *g = get_gpio(pin);
+    if (g) {
+        g->input_driven = true;
+        g->input_level = level;
+    }
+}
+
+void hal_host_gpio_release_input(uint pin) {
+    hal_gpio_t *g = get_gpio(pin);
+    if (g) {
+        g->input_driven = false;
+    }
+}
+
+void hal_host_gpio_set_observer(hal_host_gpio_observer_t observer, void *user_data) {
+    gpio_observer = observer;
+    gpio_observer_data = user_data;
+}
+
+void hal_host_gpio_set_dir_observer(hal_host_gpio_dir_observer_t observer, void *user_data) {
+    gpio_dir_observer = observer;
+    gpio_dir_observer_data = user_data;
+}
+
+bool hal_host_gpio_get_output(uint pin) {
+    hal_gpio_t *g = get_gpio(pin);
+    return g ? g->level : false;
+}
+
+//--------------------------------------------------------------------+
+// PWM
+//--------------------------------------------------------------------+
+
+pwm_config pwm_get_default_config(void) {
+    pwm_config c = { .clkdiv = 1.0f, .top = 0xFFFF };
+    return c;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start) {
+    if (slice_num >= NUM_PWM_SLICES || !c) {
+        return;
+    }
+    pwm_slices[slice_num].clkdiv = c->clkdiv;
+    pwm_slices[slice_num].wrap = c->top;
+    pwm_slices[slice_num].level[0] = 0;
+    pwm_slices[slice_num].level[1] = 0;
+    pwm_slices[slice_num].enabled = start;
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+    if (slice_num < NUM_PWM_SLICES) {
+        pwm_slices[slice_num].clkdiv = divider;
+    }
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+    if (slice_num < NUM_PWM_SLICES) {
+        pwm_slices[slice_num].wrap = wrap;
+    }
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+    if (slice_num < NUM_PWM_SLICES && chan < 2) {
+        bool changed = pwm_slices[slice_num].level[chan] != level;
+        pwm_slices[slice_num].level[chan] = level;
+        if (changed && pwm_observer) {
+            pwm_observer(slice_num, chan, level, pwm_observer_data);
+        }
+    }
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+    if (slice_num < NUM_PWM_SLICES) {
+        pwm_slices[slice_num].enabled = enabled;
+    }
+}
+
+void hal_host_pwm_set_observer(hal_host_pwm_observer_t observer, void *user_data) {
+    pwm_observer = observer;
+    pwm_observer_data = user_data;
+}
+
+uint16_t hal_host_pwm_get_level(uint pin) {
+    hal_pwm_slice_t *s = &pwm_slices[pwm_gpio_to_slice_num(pin)];
+    return s->enabled ? s->level[pwm_gpio_to_channel(pin)] : 0;
+}
+
+uint16_t hal_host_pwm_get_wrap(uint pin) {
+    return pwm_slices[pwm_gpio_to_slice_num(pin)].wrap;
+}
+
+float hal_host_pwm_get_pulse_us(uint pin) {
+    hal_pwm_slice_t *s = &pwm_slices[pwm_gpio_to_slice_num(pin)];
+    if (!s->enabled) {
+        return 0.0f;
+    }
+    float tick_us = s->clkdiv * 1000000.0f / HAL_HOST_SYS_CLOCK_HZ;
+    return s->level[pwm_gpio_to_channel(pin)] * tick_us;
+}
+
+//--------------------------------------------------------------------+
+// UART
+//--------------------------------------------------------------------+
+
+uint uart_init(uart_inst_t *uart, uint baudrate) {
+    (void)uart;
+    return baudrate;
+}
+
+void uart_puts(uart_inst_t *uart, const char *s) {
+    (void)uart;
+    if (uart_sink && s) {
+        uart_sink(s, uart_sink_data);
+    }
+}
+
+void hal_host_uart_set_sink(hal_host_uart_sink_t sink, void *user_data) {
+    uart_sink = sink;
+    uart_sink_data = user_data;
+}
+
+void hal_host_uart_stdout_sink(const char *s, void *user_data) {
+    (void)user_data;
+    fputs(s, stdout);
+}
+
+//--------------------------------------------------------------------+
+// I2C
+//--------------------------------------------------------------------+
+
+static int i2c_transfer(i2c_inst_t *i2c, uint8_t addr, bool read, uint8_t *data, size_t len, bool nostop,
+                        uint timeout_us) {
+    if (!i2c || i2c->baudrate == 0) {
+        return PICO_ERROR_GENERIC;
+    }
+    if (i2c_handler) {
+        i2c_timeout_us = timeout_us;
+        int result = i2c_handler(i2c->index, addr, read, data, len, nostop, i2c_handler_data);
+        i2c_timeout_us = 0;
+        return result;
+    }
+    if (read && data) {
+        memset(data, 0, len);
+    }
+    return (int)len;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    i2c_program_count[i2c->index]++;
+    return baudrate;
+}
+
+void i2c_deinit(i2c_inst_t *i2c) {
+    i2c->baudrate = 0;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    i2c_program_count[i2c->index]++;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    return i2c_transfer(i2c, addr, false, (uint8_t *)src, len, nostop, 0);
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    return i2c_transfer(i2c, addr, true, dst, len, nostop, 0);
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us) {
+    return i2c_transfer(i2c, addr, false, (uint8_t *)src, len, nostop, timeout_us);
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us) {
+    return i2c_transfer(i2c, addr, true, dst, len, nostop, timeout_us);
+}
+
+void hal_host_i2c_set_handler(hal_host_i2c_handler_t handler, void *user_data) {
+    i2c_handler = handler;
+    i2c_handler_data = user_data;
+}
+
+uint32_t hal_host_i2c_get_baudrate(uint8_t bus) {
+    return bus == 0 ? i2c0_inst.baudrate : (bus == 1 ? i2c1_inst.baudrate : 0);
+}
+
+uint32_t hal_host_i2c_get_program_count(uint8_t bus) {
+    return bus < 2 ? i2c_program_count[bus] : 0;
+}
+
+uint32_t hal_host_i2c_get_timeout_us(void) {
+    return i2c_timeout_us;
+}
+
+//--------------------------------------------------------------------+
+// SPI and DMA
+//--------------------------------------------------------------------+
+
+uint spi_init(spi_inst_t *spi, uint baudrate) {
+    spi->baudrate = baudrate;
+    return baudrate;
+}
+
+void spi_deinit(spi_inst_t *spi) {
+    spi->baudrate = 0;
+}
+
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {
+    (void)spi;
+    (void)data_bits;
+    (void)cpol;
+    (void)cpha;
+    (void)order;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len) {
+    if (spi_handler && spi->baudrate) {
+        spi_handler(spi->index, src, len, false, spi_handler_data);
+    }
+    return (int)len;
+}
+
+bool spi_is_busy(const spi_inst_t *spi) {
+    (void)spi;
+    return false;
+}
+
+void hal_host_spi_set_handler(hal_host_spi_handler_t handler, void *user_data) {
+    spi_handler = handler;
+    spi_handler_data = user_data;
+}
+
+uint32_t hal_host_spi_get_baudrate(uint8_t bus) {
+    return bus == 0 ? spi0_inst.baudrate : (bus == 1 ? spi1_inst.baudrate : 0);
+}
+
+static hal_dma_channel_t* get_dma_channel(uint channel) {
+    return channel < NUM_DMA_CHANNELS ? &dma_channels[channel] : NULL;
+}
+
+// End the transfer in flight, handing it to the SPI it writes to
+static void finish_dma(hal_dma_channel_t *ch) {
+    if (!ch->busy) {
+        return;
+    }
+    ch->busy = false;
+
+    spi_inst_t *spi = NULL;
+    if (ch->write_addr == &spi0_inst.hw.dr) {
+        spi = &spi0_inst;
+    } else if (ch->write_addr == &spi1_inst.hw.dr) {
+        spi = &spi1_inst;
+    }
+    if (spi && spi_handler && spi->baudrate) {
+        spi_handler(spi->index, (const uint8_t *)ch->read_addr, ch->count, true, spi_handler_data);
+    }
+}
+
+int dma_claim_unused_channel(bool required) {
+    for (uint channel = 0; channel < NUM_DMA_CHANNELS; channel++) {
+        if (!dma_channels[channel].claimed) {
+            dma_channels[channel].claimed = true;
+            return (int)channel;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "hal_host: no free DMA channel\n");
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    hal_dma_channel_t *ch = get_dma_channel(channel);
+    if (ch) {
+        ch->claimed = false;
+    }
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    dma_channel_config c = {
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = 0x3f,   // Unpaced
+    };
+    return c;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    (void)config;
+    hal_dma_channel_t *ch = get_dma_channel(channel);
+    if (!ch) {
+        return;
+    }
+    finish_dma(ch);
+    ch->write_addr = write_addr;
+    ch->read_addr = read_addr;
+    ch->count = transfer_count;
+    ch->busy = trigger && transfer_count > 0;
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+    hal_dma_channel_t *ch = get_dma_channel(channel);
+    if (!ch) {
+        return;
+    }
+    finish_dma(ch);
+    ch->read_addr = read_addr;
+    ch->count = transfer_count;
+    ch->busy = transfer_count > 0;
+}
+
+bool dma_channel_is_busy(uint channel) {
+    hal_dma_channel_t *ch = get_dma_channel(channel);
+    if (ch) {
+        finish_dma(ch);
+    }
+    return false;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    hal_dma_channel_t *ch = get_dma_channel(channel);
+    if (ch) {
+        finish_dma(ch);
+    }
+}
+
+//--------------------------------------------------------------------+
+// USB MIDI (TinyUSB subset)
+//--------------------------------------------------------------------+
+
+// Default device callbacks for programs that don't link src/usb_midi.c
+__attribute__((weak)) void tud_mount_cb(void) {}
+__attribute__((weak)) void tud_umount_cb(void) {}
+__attribute__((weak)) void tud_suspend_cb(bool remote_wakeup_en) { (void)remote_wakeup_en; }
+__attribute__((weak)) void tud_resume_cb(void) {}
+
+bool tusb_init(void) {
+    return true;
+}
+
+void tud_task(void) {
+}
+
+bool tud_mounted(void) {
+    return usb_mounted;
+}
+
+uint32_t tud_midi_available(void) {
+    return usb_mounted ? usb_queue_count : 0;
+}
+
+bool tud_midi_packet_read(uint8_t packet[4]) {
+    if (!usb_mounted || usb_queue_count == 0) {
+        return false;
+    }
+    memcpy(packet, usb_queue[usb_queue_head], 4);
+    usb_queue_head = (usb_queue_head + 1) % HAL_HOST_USB_QUEUE_SIZE;
+    usb_queue_count--;
+    return true;
+}
+
+uint32_t tud_midi_stream_write(uint8_t cable_num, const uint8_t *buffer, uint32_t bufsize) {
+    (void)cable_num;
+    if (!usb_mounted || !buffer) {
+        return 0;
+    }
+    if (usb_tx_limit && bufsize > usb_tx_limit) {
+        bufsize = usb_tx_limit;
+    }
+    if (usb_tx_handler) {
+        usb_tx_handler(buffer, bufsize, usb_tx_handler_data);
+    }
+    return bufsize;
+}
+
+void hal_host_usb_set_mounted(bool mounted) {
+    if (mounted == usb_mounted) {
+        return;
+    }
+    usb_mounted = mounted;
+    if (mounted) {
+        tud_mount_cb();
+    } else {
+        tud_umount_cb();
+    }
+}
+
+bool hal_host_usb_push_packet(const uint8_t packet[4]) {
+    if (usb_queue_count >= HAL_HOST_USB_QUEUE_SIZE) {
+        return false;
+    }
+    uint16_t tail = (usb_queue_head + usb_queue_count) % HAL_HOST_USB_QUEUE_SIZE;
+    memcpy(usb_queue[tail], packet, 4);
+    usb_queue_count++;
+    return true;
+}
+
+void hal_host_usb_set_tx_handler(hal_host_usb_tx_handler_t handler, void *user_data) {
+    usb_tx_handler = handler;
+    usb_tx_handler_data = user_data;
+}
+
+void hal_host_usb_set_tx_limit(uint32_t limit) {
+    usb_tx_limit = limit;
+}
@@ -0,0 +1,335 @@
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/types.h"
+
+/**
+ * Host HAL shim - control side
+ *
+ * The shim implements the Pico SDK functions used by lib/ and src/ so they
+ * build as native libraries. This header lets host programs (tests,
+ * benchmarks, simulators) drive it: set the virtual clock, plug in I2C
+ * device models, feed GPIO inputs and USB MIDI packets, and capture SPI
+ * writes, the debug UART and USB output.
+ */
+
+//--------------------------------------------------------------------+
+// General
+//--------------------------------------------------------------------+
+
+/**
+ * Reset the shim to power-on state
+ *
+ * Clock back to 0, alarms cancelled, GPIO/PWM cleared, DMA channels
+ * released, handlers and USB queues removed.
+ */
+void hal_host_reset(void);
+
+//--------------------------------------------------------------------+
+// Virtual Clock
+//--------------------------------------------------------------------+
+
+/**
+ * Get the virtual time in microseconds since boot
+ */
+uint64_t hal_host_time_us(void);
+
+/**
+ * Set the virtual time without firing alarms
+ *
+ * @param us Microseconds since boot
+ */
+void hal_host_time_set_us(uint64_t us);
+
+/**
+ * Advance the virtual time, firing alarms that come due on the way
+ *
+ * sleep_us()/sleep_ms() in firmware code do the same thing.
+ *
+ * @param us Microseconds to advance
+ */
+void hal_host_time_advance_us(uint64_t us);
+
+//--------------------------------------------------------------------+
+// I2C
+//--------------------------------------------------------------------+
+
+/**
+ * I2C transfer handler
+ *
+ * @param bus Controller index (0 or 1)
+ * @param address 7-bit device address
+ * @param read true for reads, false for writes
+ * @param data Write data, or buffer to fill on reads
+ * @param len Number of bytes
+ * @param nostop true if the transfer ends without STOP
+ * @param user_data Pointer given to hal_host_i2c_set_handler()
+ * @see hal_host_i2c_get_timeout_us() for the transfer's timeout
+ * @return Number of bytes transferred, PICO_ERROR_GENERIC for a NAK or
+ *         PICO_ERROR_TIMEOUT for a timeout
+ */
+typedef int (*hal_host_i2c_handler_t)(uint8_t bus, uint8_t address, bool read, uint8_t *data,
+                                      size_t len, bool nostop, void *user_data);
+
+/**
+ * Install the I2C transfer handler
+ *
+ * Without a handler every device ACKs and reads return zeros.
+ *
+ * @param handler Transfer handler, or NULL for the default
+ * @param user_data Passed to the handler
+ */
+void hal_host_i2c_set_handler(hal_host_i2c_handler_t handler, void *user_data);
+
+/**
+ * Get the baud rate a controller is currently programmed to
+ *
+ * @param bus Controller index (0 or 1)
+ * @return Baud rate in Hz, 0 if not initialized
+ */
+uint32_t hal_host_i2c_get_baudrate(uint8_t bus);
+
+/**
+ * Get the number of times a controller's baud rate has been programmed
+ *
+ * Counts i2c_init() and i2c_set_baudrate() calls since hal_host_reset().
+ *
+ * @param bus Controller index (0 or 1)
+ * @return Number of calls
+ */
+uint32_t hal_host_i2c_get_program_count(uint8_t bus);
+
+/**
+ * Get the timeout of the transfer the I2C handler is running
+ *
+ * @return Timeout in microseconds given to i2c_write_timeout_us() or
+ *         i2c_read_timeout_us(), 0 for the blocking calls (no timeout)
+ */
+uint32_t hal_host_i2c_get_timeout_us(void);
+
+//--------------------------------------------------------------------+
+// SPI and DMA
+//--------------------------------------------------------------------+
+
+/**
+ * SPI write handler
+ *
+ * Called with the bytes of each spi_write_blocking() when it is made, and
+ * with those of a DMA transfer into an SPI data register when the transfer
+ * is waited for (dma_channel_wait_for_finish_blocking()) or polled with
+ * dma_channel_is_busy(): until then the hardware could still be reading
+ * its buffer, so GPIO levels seen by the handler are those at that point.
+ *
+ * @param bus Controller index (0 or 1)
+ * @param data Bytes written
+ * @param len Number of bytes
+ * @param dma true if the bytes came from a DMA transfer
+ * @param user_data Pointer given to hal_host_spi_set_handler()
+ */
+typedef void (*hal_host_spi_handler_t)(uint8_t bus, const uint8_t *data, size_t len, bool dma,
+                                       void *user_data);
+
+/**
+ * Install the SPI write handler
+ *
+ * Without a handler writes are discarded.
+ *
+ * @param handler Write handler, or NULL to discard writes
+ * @param user_data Passed to the handler
+ */
+void hal_host_spi_set_handler(hal_host_spi_handler_t handler, void *user_data);
+
+/**
+ * Get the baud rate an SPI controller is currently programmed to
+ *
+ * @param bus Controller index (0 or 1)
+ * @return Baud rate in Hz, 0 if not initialized
+ */
+uint32_t hal_host_spi_get_baudrate(uint8_t bus);
+
+//--------------------------------------------------------------------+
+// GPIO and PWM
+//--------------------------------------------------------------------+
+
+/**
+ * Drive the level a pin reads as while it is an input
+ *
+ * Pins nobody drives read their pull (pull-up = 1, otherwise 0).
+ *
+ * @param pin GPIO number
+ * @param level Input level
+ */
+void hal_host_gpio_set_input(uint pin, bool level);
+
+/**
+ * Release a pin driven with hal_host_gpio_set_input() back to its pull
+ *
+ * @param pin GPIO number
+ */
+void hal_host_gpio_release_input(uint pin);
+
+/**
+ * Get the level firmware last wrote to a pin
+ *
+ * @param pin GPIO number
+ * @return Output level
+ */
+bool hal_host_gpio_get_output(uint pin);
+
+/**
+ * Output change observer
+ *
+ * @param pin GPIO number
+ * @param level New output level
+ * @param user_data Pointer given to hal_host_gpio_set_observer()
+ */
+typedef void (*hal_host_gpio_observer_t)(uint pin, bool level, void *user_data);
+
+/**
+ * Set a function called whenever gpio_put() changes a pin's level
+ *
+ * @param observer Observer, or NULL to remove it
+ * @param user_data Passed to the observer
+ */
+void hal_host_gpio_set_observer(hal_host_gpio_observer_t observer, void *user_data);
+
+/**
+ * Direction change observer
+ *
+ * @param pin GPIO number
+ * @param out true if the pin became an output, false if an input
+ * @param user_data Pointer given to hal_host_gpio_set_dir_observer()
+ */
+typedef void (*hal_host_gpio_dir_observer_t)(uint pin, bool out, void *user_data);
+
+/**
+ * Set a function called whenever gpio_set_dir() changes a pin's direction
+ *
+ * Lines driven open-drain style (output low to pull down, input to let
+ * the pull-up release) only change direction, e.g. SCL clocked by hand
+ * in an I2C bus recovery.
+ *
+ * @param observer Observer, or NULL to remove it
+ * @param user_data Passed to the observer
+ */
+void hal_host_gpio_set_dir_observer(hal_host_gpio_dir_observer_t observer, void *user_data);
+
+/**
+ * PWM level change observer
+ *
+ * @param slice_num PWM slice
+ * @param chan Channel (PWM_CHAN_A or PWM_CHAN_B)
+ * @param level New compare level
+ * @param user_data Pointer given to hal_host_pwm_set_observer()
+ */
+typedef void (*hal_host_pwm_observer_t)(uint slice_num, uint chan, uint16_t level, void *user_data);
+
+/**
+ * Set a function called whenever a PWM compare level changes
+ *
+ * @param observer Observer, or NULL to remove it
+ * @param user_data Passed to the observer
+ */
+void hal_host_pwm_set_observer(hal_host_pwm_observer_t observer, void *user_data);
+
+/**
+ * Get the PWM compare level of a pin
+ *
+ * @param pin GPIO number
+ * @return Level, 0 if the slice is disabled
+ */
+uint16_t hal_host_pwm_get_level(uint pin);
+
+/**
+ * Get the PWM wrap (TOP) value of the slice driving a pin
+ *
+ * @param pin GPIO number
+ * @return Wrap value
+ */
+uint16_t hal_host_pwm_get_wrap(uint pin);
+
+/**
+ * Get the high time of a PWM pin from its level and clock divider
+ *
+ * @param pin GPIO number
+ * @return Pulse width in microseconds, 0 if the slice is disabled
+ */
+float hal_host_pwm_get_pulse_us(uint pin);
+
+//--------------------------------------------------------------------+
+// UART
+//--------------------------------------------------------------------+
+
+/**
+ * UART output sink
+ *
+ * @param s NUL-terminated text written with uart_puts()
+ * @param user_data Pointer given to hal_host_uart_set_sink()
+ */
+typedef void (*hal_host_uart_sink_t)(const char *s, void *user_data);
+
+/**
+ * Set where UART output goes
+ *
+ * @param sink Output sink, or NULL to discard output (default)
+ * @param user_data Passed to the sink
+ */
+void hal_host_uart_set_sink(hal_host_uart_sink_t sink, void *user_data);
+
+/**
+ * Sink that writes UART output to stdout
+ */
+void hal_host_uart_stdout_sink(const char *s, void *user_data);
+
+//--------------------------------------------------------------------+
+// USB MIDI
+//--------------------------------------------------------------------+
+
+/**
+ * USB MIDI stream write handler
+ *
+ * @param data Bytes written with tud_midi_stream_write()
+ * @param len Number of bytes
+ * @param user_data Pointer given to hal_host_usb_set_tx_handler()
+ */
+typedef void (*hal_host_usb_tx_handler_t)(const uint8_t *data, uint32_t len, void *user_data);
+
+/**
+ * Mount or unmount the virtual USB device
+ *
+ * Calls tud_mount_cb() / tud_umount_cb().
+ *
+ * @param mounted true to mount
+ */
+void hal_host_usb_set_mounted(bool mounted);
+
+/**
+ * Queue a USB-MIDI event packet for the firmware to read
+ *
+ * @param packet 4-byte USB-MIDI event packet
+ * @return true if queued, false if the queue is full
+ */
+bool hal_host_usb_push_packet(const uint8_t packet[4]);
+
+/**
+ * Set the handler receiving USB MIDI output
+ *
+ * @param handler Handler, or NULL to discard output
+ * @param user_data Passed to the handler
+ */
+void hal_host_usb_set_tx_handler(hal_host_usb_tx_handler_t handler, void *user_data);
+
+/**
+ * Limit the bytes each tud_midi_stream_write() takes
+ *
+ * The device FIFO takes what fits and leaves the rest to the caller; a
+ * limit has the shim do the same.
+ *
+ * @param limit Bytes per write, 0 for no limit (the default)
+ */
+void hal_host_usb_set_tx_limit(uint32_t limit);
+
+#endif // HAL_HOST_H
@@ -0,0 +1,36 @@
+#ifndef HOST_HARDWARE_PWM_H
+#define HOST_HARDWARE_PWM_H
+
+// Host build: PWM slice settings are recorded in the HAL shim
+
+#include "pico/types.h"
+
+#define NUM_PWM_SLICES 8
+
+enum pwm_chan {
+    PWM_CHAN_A = 0,
+    PWM_CHAN_B = 1,
+};
+
+typedef struct {
+    float clkdiv;
+    uint16_t top;
+} pwm_config;
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1u) & 7u;
+}
+
+static inline uint pwm_gpio_to_channel(uint gpio) {
+    return gpio & 1u;
+}
+
+pwm_config pwm_get_default_config(void);
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+void pwm_set_clkdiv(uint slice_num, float divider);
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_set_enabled(uint slice_num, bool enabled);
+
+#endif // HOST_HARDWARE_PWM_H
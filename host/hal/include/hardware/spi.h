@@ -0,0 +1,61 @@
+#ifndef HOST_HARDWARE_SPI_H
+#define HOST_HARDWARE_SPI_H
+
+// Host build: writes are handed to the handler installed with
+// hal_host_spi_set_handler(), directly or at the end of a DMA transfer
+
+#include "pico/types.h"
+#include "pico/stdlib.h"    // The SDK's pulls in tight_loop_contents() too
+
+typedef enum {
+    SPI_CPHA_0 = 0,
+    SPI_CPHA_1 = 1
+} spi_cpha_t;
+
+typedef enum {
+    SPI_CPOL_0 = 0,
+    SPI_CPOL_1 = 1
+} spi_cpol_t;
+
+typedef enum {
+    SPI_LSB_FIRST = 0,
+    SPI_MSB_FIRST = 1
+} spi_order_t;
+
+// Data register: the address a DMA channel writes to
+typedef struct {
+    volatile uint32_t dr;
+} spi_hw_t;
+
+typedef struct spi_inst {
+    uint8_t index;
+    uint baudrate;
+    spi_hw_t hw;
+} spi_inst_t;
+
+extern spi_inst_t spi0_inst;
+extern spi_inst_t spi1_inst;
+
+#define spi0 (&spi0_inst)
+#define spi1 (&spi1_inst)
+
+uint spi_init(spi_inst_t *spi, uint baudrate);
+void spi_deinit(spi_inst_t *spi);
+void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *src, size_t len);
+bool spi_is_busy(const spi_inst_t *spi);
+
+static inline uint spi_get_index(const spi_inst_t *spi) {
+    return spi->index;
+}
+
+static inline spi_hw_t* spi_get_hw(spi_inst_t *spi) {
+    return &spi->hw;
+}
+
+// DREQ numbers as on the RP2040 (DREQ_SPI0_TX = 16)
+static inline uint spi_get_dreq(spi_inst_t *spi, bool is_tx) {
+    return 16 + spi->index * 2 + (is_tx ? 0 : 1);
+}
+
+#endif // HOST_HARDWARE_SPI_H
@@ -0,0 +1,13 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+// Host build: __dmb() is a full compiler and CPU fence, so code sharing
+// memory between the two cores can run on two host threads
+
+#include "pico/types.h"
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif // HOST_HARDWARE_SYNC_H
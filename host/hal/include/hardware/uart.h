@@ -0,0 +1,21 @@
+#ifndef HOST_HARDWARE_UART_H
+#define HOST_HARDWARE_UART_H
+
+// Host build: UART output goes to the sink set with hal_host_uart_set_sink()
+
+#include "pico/types.h"
+
+typedef struct uart_inst {
+    uint8_t index;
+} uart_inst_t;
+
+extern uart_inst_t uart0_inst;
+extern uart_inst_t uart1_inst;
+
+#define uart0 (&uart0_inst)
+#define uart1 (&uart1_inst)
+
+uint uart_init(uart_inst_t *uart, uint baudrate);
+void uart_puts(uart_inst_t *uart, const char *s);
+
+#endif // HOST_HARDWARE_UART_H
@@ -0,0 +1,14 @@
+#ifndef HOST_PICO_ERROR_H
+#define HOST_PICO_ERROR_H
+
+// Host build: Pico SDK error codes (same values as the SDK)
+
+enum pico_error_codes {
+    PICO_OK = 0,
+    PICO_ERROR_NONE = 0,
+    PICO_ERROR_TIMEOUT = -1,
+    PICO_ERROR_GENERIC = -2,
+    PICO_ERROR_NO_DATA = -3,
+};
+
+#endif // HOST_PICO_ERROR_H
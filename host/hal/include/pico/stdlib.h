@@ -0,0 +1,16 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Host build: stand-in for the Pico SDK's pico/stdlib.h
+
+#include "pico/types.h"
+#include "pico/error.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+static inline void tight_loop_contents(void) {}
+
+bool stdio_init_all(void);
+
+#endif // HOST_PICO_STDLIB_H
@@ -0,0 +1,15 @@
+#ifndef HOST_PICO_TYPES_H
+#define HOST_PICO_TYPES_H
+
+// Host build: Pico SDK basic types
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// The SDK uses an opaque type in debug builds; microseconds since boot here
+typedef uint64_t absolute_time_t;
+
+#endif // HOST_PICO_TYPES_H
@@ -0,0 +1,25 @@
+#ifndef HOST_TUSB_H
+#define HOST_TUSB_H
+
+// Host build: the subset of TinyUSB used by src/usb_midi.c. Packets are
+// injected with hal_host_usb_push_packet() and stream writes are passed to
+// the handler set with hal_host_usb_set_tx_handler().
+
+#include <stdint.h>
+#include <stdbool.h>
+
+bool tusb_init(void);
+void tud_task(void);
+bool tud_mounted(void);
+
+uint32_t tud_midi_available(void);
+bool tud_midi_packet_read(uint8_t packet[4]);
+uint32_t tud_midi_stream_write(uint8_t cable_num, const uint8_t *buffer, uint32_t bufsize);
+
+// Device callbacks (implemented by the application)
+void tud_mount_cb(void);
+void tud_umount_cb(void);
+void tud_suspend_cb(bool remote_wakeup_en);
+void tud_resume_cb(void);
+
+#endif // HOST_TUSB_H
@@ -0,0 +1,541 @@
+/**
+ * Bus traffic report (host build)
+ *
+ * Replays the notes of a Standard MIDI File through each player backend on
+ * the simulated I2C bus and reports how many I2C transactions and bytes on
+ * the wire every Note On and Note Off costs, the background traffic from
+ * the backends' update functions and the peak bus utilization over sliding
+ * windows. Gives an I/O-efficiency number for comparing drivers and
+ * expanders without the hardware.
+ *
+ *   bus_report [options] song.mid
+ */
+
+#include "hal_host.h"
+#include "i2c_sim.h"
+#include "smf.h"
+#include "pcf857x_model.h"
+#include "ch423_model.h"
+#include "pca9685_model.h"
+#include "i2c_bus.h"
+#include "i2c_midi.h"
+#include "i2c_pca9685_midi.h"
+#include "mallet_midi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+// Board (mirrors src/midi_synthesizer.c)
+#define REPORT_SDA_PIN          2
+#define REPORT_SCL_PIN          3
+#define REPORT_BUS_FREQ         400000
+#define REPORT_ACTUATOR_FREQ    1000000
+#define REPORT_PCF_ADDRESS      0x20
+#define REPORT_CH423_ADDRESS    0x24
+#define REPORT_PCA9685_ADDRESS  0x40
+#define REPORT_SERVO_PIN        16
+#define REPORT_STRIKER_PIN      17
+
+#define REPORT_LEAD_IN_US       1000
+#define REPORT_TAIL_US          500000
+#define REPORT_UPDATE_STEP_US   100       // Main loop pass between events
+#define REPORT_TIMELINE         (1u << 20)
+#define REPORT_MAX_WINDOWS      8
+
+//--------------------------------------------------------------------+
+// Backends
+//--------------------------------------------------------------------+
+
+typedef struct {
+    const char *name;
+    uint8_t max_range;
+    bool (*setup)(void);
+    bool (*process)(uint8_t status, uint8_t data1, uint8_t data2);
+    void (*update)(void);
+} backend_t;
+
+/**
+ * Traffic charged to one kind of message
+ */
+typedef struct {
+    uint32_t messages;
+    uint32_t transactions;
+    uint64_t bytes;            // Address byte + payload
+    uint64_t wire_ns;
+    uint32_t max_transactions; // Most for a single message
+    uint32_t max_bytes;
+} bucket_t;
+
+enum { BUCKET_NOTE_ON, BUCKET_NOTE_OFF, BUCKET_BACKGROUND, BUCKET_COUNT };
+
+typedef struct {
+    // Options
+    const char *midi_path;
+    const char *only;          // Run one backend
+    int channel;               // 1-16, 0 = all channels
+    int low_note;              // -1 = lowest note in the file
+    int note_range;
+    uint32_t windows_ms[REPORT_MAX_WINDOWS];
+    int window_count;
+    bool csv;
+
+    // Models (one backend on the bus at a time)
+    pcf857x_model_t pcf;
+    ch423_model_t ch423;
+    pca9685_model_t pca;
+
+    // Backend contexts
+    i2c_midi_t i2c_midi;
+    pca9685_midi_t pca_midi;
+    mallet_midi_t mallet;
+    uint8_t range;             // Range of the backend being measured
+
+    // Attribution of transfers to the message being handled
+    bucket_t buckets[BUCKET_COUNT];
+    int current;
+    uint32_t current_transactions;
+    uint32_t current_bytes;
+} report_t;
+
+static report_t report;
+
+static uint8_t backend_channel(void) {
+    return report.channel ? (uint8_t)(report.channel - 1) : 9;
+}
+
+static bool setup_pcf(bool is_16bit) {
+    pcf857x_model_init(&report.pcf, 1, REPORT_PCF_ADDRESS, is_16bit);
+    i2c_sim_attach(&report.pcf.base);
+    i2c_bus_set_device_speed(i2c1, REPORT_PCF_ADDRESS, i2c_midi_get_io_max_freq(IO_EXPANDER_PCF8574));
+
+    i2c_midi_config_t config = {
+        .note_range = report.range,
+        .low_note = (uint8_t)report.low_note,
+        .midi_channel = backend_channel() + 1,
+        .io_address = REPORT_PCF_ADDRESS,
+        .i2c_port = i2c1,
+        .io_type = IO_EXPANDER_PCF8574,
+        .semitone_mode = I2C_MIDI_SEMITONE_PLAY,
+    };
+    if (!i2c_midi_init_with_config(&report.i2c_midi, &config, REPORT_SDA_PIN, REPORT_SCL_PIN,
+                                   REPORT_ACTUATOR_FREQ)) {
+        return false;
+    }
+    // i2c_midi always drives a PCF8575; re-init as the 8-bit part, which
+    // only does Standard-mode
+    if (is_16bit) {
+        return true;
+    }
+    i2c_bus_set_device_speed(i2c1, REPORT_PCF_ADDRESS, PCF8574_MAX_FREQ);
+    return pcf857x_init(&report.i2c_midi.driver.pcf857x, i2c1, REPORT_PCF_ADDRESS, PCF8574_CHIP);
+}
+
+static bool setup_pcf8574(void) {
+    return setup_pcf(false);
+}
+
+static bool setup_pcf8575(void) {
+    return setup_pcf(true);
+}
+
+static bool setup_ch423(void) {
+    ch423_model_init(&report.ch423, 1, REPORT_CH423_ADDRESS);
+    i2c_sim_attach(&report.ch423.base);
+    i2c_bus_set_device_speed(i2c1, REPORT_CH423_ADDRESS, i2c_midi_get_io_max_freq(IO_EXPANDER_CH423));
+
+    i2c_midi_config_t config = {
+        .note_range = report.range,
+        .low_note = (uint8_t)report.low_note,
+        .midi_channel = backend_channel() + 1,
+        .io_address = REPORT_CH423_ADDRESS,
+        .i2c_port = i2c1,
+        .io_type = IO_EXPANDER_CH423,
+        .semitone_mode = I2C_MIDI_SEMITONE_PLAY,
+    };
+    return i2c_midi_init_with_config(&report.i2c_midi, &config, REPORT_SDA_PIN, REPORT_SCL_PIN,
+                                     REPORT_ACTUATOR_FREQ);
+}
+
+static bool process_i2c_midi(uint8_t status, uint8_t data1, uint8_t data2) {
+    return i2c_midi_process_message(&report.i2c_midi, status, data1, data2);
+}
+
+static bool setup_pca(pca9685_strike_mode_t mode) {
+    pca9685_model_init(&report.pca, 1, REPORT_PCA9685_ADDRESS);
+    i2c_sim_attach(&report.pca.base);
+
+    // Start from the library defaults
+    if (!pca9685_midi_init(&report.pca_midi, i2c1, REPORT_SDA_PIN, REPORT_SCL_PIN, REPORT_ACTUATOR_FREQ)) {
+        return false;
+    }
+    pca9685_midi_config_t config = report.pca_midi.config;
+    config.note_range = report.range;
+    config.low_note = (uint8_t)report.low_note;
+    config.midi_channel = backend_channel();
+    config.strike_mode = mode;
+    return pca9685_midi_init_with_config(&report.pca_midi, &config, REPORT_SDA_PIN, REPORT_SCL_PIN,
+                                         REPORT_ACTUATOR_FREQ);
+}
+
+static bool setup_pca_simple(void) {
+    return setup_pca(PCA9685_STRIKE_MODE_SIMPLE);
+}
+
+static bool setup_pca_position(void) {
+    return setup_pca(PCA9685_STRIKE_MODE_POSITION);
+}
+
+static bool process_pca(uint8_t status, uint8_t data1, uint8_t data2) {
+    return pca9685_midi_process_message(&report.pca_midi, status, data1, data2);
+}
+
+static void update_pca(void) {
+    pca9685_midi_update(&report.pca_midi);
+}
+
+static bool setup_mallet(void) {
+    if (!mallet_midi_init(&report.mallet, REPORT_SERVO_PIN, REPORT_STRIKER_PIN)) {
+        return false;
+    }
+    mallet_midi_config_t config = report.mallet.config;
+    config.note_range = report.range;
+    config.low_note = (uint8_t)report.low_note;
+    config.midi_channel = backend_channel();
+    return mallet_midi_init_with_config(&report.mallet, &config);
+}
+
+static bool process_mallet(uint8_t status, uint8_t data1, uint8_t data2) {
+    return mallet_midi_process_message(&report.mallet, status, data1, data2);
+}
+
+static void update_mallet(void) {
+    mallet_midi_update(&report.mallet);
+}
+
+static const backend_t backends[] = {
+    { "pcf8574",      8,  setup_pcf8574,      process_i2c_midi, NULL },
+    { "pcf8575",      8,  setup_pcf8575,      process_i2c_midi, NULL },
+    { "ch423",        16, setup_ch423,        process_i2c_midi, NULL },
+    { "pca9685",      16, setup_pca_simple,   process_pca,      update_pca },
+    { "pca9685-pos",  16, setup_pca_position, process_pca,      update_pca },
+    { "mallet",       16, setup_mallet,       process_mallet,   update_mallet },
+};
+
+#define BACKEND_COUNT (sizeof(backends) / sizeof(backends[0]))
+
+//--------------------------------------------------------------------+
+// Traffic Accounting
+//--------------------------------------------------------------------+
+
+static void on_transfer(const i2c_sim_event_t *event, void *user_data) {
+    (void)user_data;
+    bucket_t *b = &report.buckets[report.current];
+    uint32_t bytes = event->length + 1u;
+
+    b->transactions++;
+    b->bytes += bytes;
+    b->wire_ns += event->wire_time_ns;
+    report.current_transactions++;
+    report.current_bytes += bytes;
+}
+
+/**
+ * Hand one message to the backend and charge its transfers to a bucket
+ */
+static void deliver(const backend_t *backend, int bucket, uint8_t status, uint8_t data1, uint8_t data2) {
+    bucket_t *b = &report.buckets[bucket];
+
+    report.current = bucket;
+    report.current_transactions = 0;
+    report.current_bytes = 0;
+    backend->process(status, data1, data2);
+    report.current = BUCKET_BACKGROUND;
+
+    b->messages++;
+    if (report.current_transactions > b->max_transactions) {
+        b->max_transactions = report.current_transactions;
+    }
+    if (report.current_bytes > b->max_bytes) {
+        b->max_bytes = report.current_bytes;
+    }
+}
+
+/**
+ * Run the backend's main loop work until the virtual clock reaches a time
+ */
+static void run_until(const backend_t *backend, uint64_t time_us) {
+    while (hal_host_time_us() < time_us) {
+        if (backend->update) {
+            backend->update();
+        }
+        uint64_t step = time_us - hal_host_time_us();
+        sleep_us(step < REPORT_UPDATE_STEP_US ? step : REPORT_UPDATE_STEP_US);
+    }
+}
+
+/**
+ * Highest share of a window the bus was busy, over every window that
+ * starts with a transfer
+ */
+static double peak_utilization(const i2c_sim_event_t *timeline, size_t count, uint64_t window_us) {
+    uint64_t window_ns = window_us * 1000;
+    uint64_t peak_ns = 0;
+    uint64_t busy_ns = 0;
+    size_t end = 0;
+
+    for (size_t start = 0; start < count; start++) {
+        uint64_t limit_ns = timeline[start].timestamp_us * 1000 + window_ns;
+        while (end < count && timeline[end].timestamp_us * 1000 < limit_ns) {
+            busy_ns += timeline[end].wire_time_ns;
+            end++;
+        }
+        // The last transfer may run past the end of the window
+        const i2c_sim_event_t *last = &timeline[end - 1];
+        uint64_t last_end_ns = last->timestamp_us * 1000 + last->wire_time_ns;
+        uint64_t overrun_ns = last_end_ns > limit_ns ? last_end_ns - limit_ns : 0;
+        if (busy_ns - overrun_ns > peak_ns) {
+            peak_ns = busy_ns - overrun_ns;
+        }
+        busy_ns -= timeline[start].wire_time_ns;
+    }
+    return 100.0 * (double)peak_ns / (double)window_ns;
+}
+
+//--------------------------------------------------------------------+
+// Replay
+//--------------------------------------------------------------------+
+
+static bool is_note(const smf_event_t *e) {
+    uint8_t type = e->status & 0xF0;
+    return e->status != 0xF0 && (type == 0x80 || type == 0x90) &&
+           (!report.channel || (e->status & 0x0F) == report.channel - 1);
+}
+
+static bool run_backend(const backend_t *backend, const smf_file_t *smf) {
+    memset(report.buckets, 0, sizeof(report.buckets));
+    report.current = BUCKET_BACKGROUND;
+    report.range = report.note_range < backend->max_range ? (uint8_t)report.note_range : backend->max_range;
+
+    if (!i2c_sim_init(REPORT_TIMELINE)) {
+        fprintf(stderr, "bus_report: can't allocate the bus timeline\n");
+        return false;
+    }
+    if (!backend->setup()) {
+        fprintf(stderr, "bus_report: %s setup failed\n", backend->name);
+        return false;
+    }
+    i2c_sim_clear();
+    i2c_sim_set_observer(on_transfer, NULL);
+
+    // Every note goes to the backend's channel
+    uint64_t origin_us = hal_host_time_us() + REPORT_LEAD_IN_US;
+    uint8_t channel = backend_channel();
+    for (size_t i = 0; i < smf->event_count; i++) {
+        const smf_event_t *e = &smf->events[i];
+        if (!is_note(e)) {
+            continue;
+        }
+        run_until(backend, origin_us + e->time_us);
+
+        uint8_t status = (e->status & 0xF0) | channel;
+        bool note_on = (e->status & 0xF0) == 0x90 && e->data2 > 0;
+        bool in_range = e->data1 >= report.low_note && e->data1 < report.low_note + report.range;
+        if (in_range) {
+            deliver(backend, note_on ? BUCKET_NOTE_ON : BUCKET_NOTE_OFF, status, e->data1, e->data2);
+        } else {
+            backend->process(status, e->data1, e->data2);
+        }
+    }
+    run_until(backend, hal_host_time_us() + REPORT_TAIL_US);
+    i2c_sim_set_observer(NULL, NULL);
+    return true;
+}
+
+//--------------------------------------------------------------------+
+// Output
+//--------------------------------------------------------------------+
+
+static double per_message(uint64_t total, uint32_t messages) {
+    return messages ? (double)total / messages : 0.0;
+}
+
+static void print_header(void) {
+    if (report.csv) {
+        printf("backend,note_on,txn_per_on,bytes_per_on,max_bytes_on,note_off,txn_per_off,bytes_per_off,"
+               "max_bytes_off,background_txn,background_bytes,bus_time_us");
+        for (int w = 0; w < report.window_count; w++) {
+            printf(",peak_%ums_percent", report.windows_ms[w]);
+        }
+        printf("\n");
+        return;
+    }
+    printf("%-12s %6s %8s %8s %8s %6s %8s %8s %8s %9s %10s %10s",
+           "backend", "on", "txn/on", "B/on", "maxB/on", "off", "txn/off", "B/off", "maxB/off",
+           "bg txn", "bg B", "bus us");
+    for (int w = 0; w < report.window_count; w++) {
+        char label[16];
+        snprintf(label, sizeof(label), "peak %ums", report.windows_ms[w]);
+        printf(" %10s", label);
+    }
+    printf("\n");
+}
+
+static void print_backend(const backend_t *backend) {
+    const bucket_t *on = &report.buckets[BUCKET_NOTE_ON];
+    const bucket_t *off = &report.buckets[BUCKET_NOTE_OFF];
+    const bucket_t *bg = &report.buckets[BUCKET_BACKGROUND];
+    uint64_t bus_ns = on->wire_ns + off->wire_ns + bg->wire_ns;
+
+    size_t count;
+    const i2c_sim_event_t *timeline = i2c_sim_get_timeline(&count);
+    if (count < on->transactions + off->transactions + bg->transactions) {
+        fprintf(stderr, "bus_report: %s: timeline full, peaks cover the first %zu transfers\n",
+                backend->name, count);
+    }
+
+    const char *fmt = report.csv ? "%s,%u,%.2f,%.2f,%u,%u,%.2f,%.2f,%u,%u,%llu,%llu"
+                                 : "%-12s %6u %8.2f %8.2f %8u %6u %8.2f %8.2f %8u %9u %10llu %10llu";
+    printf(fmt, backend->name,
+           on->messages, per_message(on->transactions, on->messages),
+           per_message(on->bytes, on->messages), on->max_bytes,
+           off->messages, per_message(off->transactions, off->messages),
+           per_message(off->bytes, off->messages), off->max_bytes,
+           bg->transactions, (unsigned long long)bg->bytes,
+           (unsigned long long)(bus_ns / 1000));
+
+    for (int w = 0; w < report.window_count; w++) {
+        double peak = count ? peak_utilization(timeline, count, (uint64_t)report.windows_ms[w] * 1000) : 0.0;
+        printf(report.csv ? ",%.1f" : " %9.1f%%", peak);
+    }
+    printf("\n");
+}
+
+//--------------------------------------------------------------------+
+// Main
+//--------------------------------------------------------------------+
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [options] file.mid\n"
+        "  --backend NAME   measure one backend:", argv0);
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        fprintf(stderr, " %s", backends[i].name);
+    }
+    fprintf(stderr, "\n"
+        "  --channel N      only notes on MIDI channel 1-16 (default all channels)\n"
+        "  --low-note N     lowest note played (default lowest note in the file)\n"
+        "  --range N        number of notes (default 16, i2c_midi drives 8 PCF857x pins)\n"
+        "  --window-ms N    sliding window for peak utilization, repeatable (default 1, 10, 100)\n"
+        "  --csv            CSV output\n");
+}
+
+static bool parse_args(int argc, char **argv) {
+    report.low_note = -1;
+    report.note_range = 16;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *next = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--csv") == 0) {
+            report.csv = true;
+        } else if (arg[0] == '-' && !next) {
+            fprintf(stderr, "%s needs a value\n", arg);
+            return false;
+        } else if (strcmp(arg, "--backend") == 0) {
+            report.only = argv[++i];
+        } else if (strcmp(arg, "--channel") == 0) {
+            report.channel = atoi(argv[++i]);
+        } else if (strcmp(arg, "--low-note") == 0) {
+            report.low_note = atoi(argv[++i]);
+        } else if (strcmp(arg, "--range") == 0) {
+            report.note_range = atoi(argv[++i]);
+        } else if (strcmp(arg, "--window-ms") == 0) {
+            int ms = atoi(argv[++i]);
+            if (ms <= 0 || report.window_count == REPORT_MAX_WINDOWS) {
+                fprintf(stderr, "bad or too many windows\n");
+                return false;
+            }
+            report.windows_ms[report.window_count++] = (uint32_t)ms;
+        } else if (arg[0] == '-') {
+            return false;
+        } else {
+            report.midi_path = arg;
+        }
+    }
+
+    if (report.window_count == 0) {
+        report.windows_ms[0] = 1;
+        report.windows_ms[1] = 10;
+        report.windows_ms[2] = 100;
+        report.window_count = 3;
+    }
+    if (report.channel < 0 || report.channel > 16 || report.low_note > 127 ||
+        report.note_range < 2 || report.note_range > 16) {
+        fprintf(stderr, "channel, low note or range out of range\n");
+        return false;
+    }
+    return report.midi_path != NULL;
+}
+
+int main(int argc, char **argv) {
+    if (!parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    smf_file_t smf;
+    char error[128];
+    if (!smf_load(report.midi_path, &smf, error, sizeof(error))) {
+        fprintf(stderr, "bus_report: %s\n", error);
+        return 1;
+    }
+
+    if (report.low_note < 0) {
+        report.low_note = 127;
+        for (size_t i = 0; i < smf.event_count; i++) {
+            const smf_event_t *e = &smf.events[i];
+            if (is_note(e) && (e->status & 0xF0) == 0x90 && e->data1 < report.low_note) {
+                report.low_note = e->data1;
+            }
+        }
+    }
+
+    // One bus shared by every backend: the PCA9685 at Fast-mode Plus, the
+    // expanders at their chip maximum (set up with each backend)
+    hal_host_reset();
+    i2c_bus_init(i2c1, REPORT_SDA_PIN, REPORT_SCL_PIN, REPORT_BUS_FREQ);
+    i2c_bus_set_device_speed(i2c1, REPORT_PCA9685_ADDRESS, REPORT_ACTUATOR_FREQ);
+
+    print_header();
+    int status = 0;
+    bool found = false;
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        if (report.only && strcmp(report.only, backends[i].name) != 0) {
+            continue;
+        }
+        found = true;
+        if (!run_backend(&backends[i], &smf)) {
+            status = 1;
+            continue;
+        }
+        print_backend(&backends[i]);
+    }
+    if (!found) {
+        fprintf(stderr, "bus_report: unknown backend %s\n", report.only);
+        status = 2;
+    }
+
+    if (!report.csv) {
+        printf("notes from %d, range %d (8 on the PCF857x); bytes include the address byte; "
+               "mallet drives GPIO/PWM only\n", report.low_note, report.note_range);
+    }
+
+    i2c_sim_deinit();
+    smf_free(&smf);
+    return status;
+}
@@ -0,0 +1,360 @@
+/**
+ * Whole-firmware harness (host build)
+ */
+
+#include "firmware_harness.h"
+#include "hal_host.h"
+#include "i2c_sim.h"
+#include "midi_synthesizer.h"
+#include "midi_handler.h"
+#include "configuration_settings.h"
+#include "usb_midi.h"
+#include "i2c_bus.h"
+#include <stdio.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define HARNESS_SDA_PIN       2
+#define HARNESS_SCL_PIN       3
+#define HARNESS_BUS_FREQ      400000
+#define HARNESS_EEPROM_BYTES  4096    // AT24C32
+#define HARNESS_EEPROM_PAGE   32
+
+// Servo pulse range shared by mallet_midi and the PCA9685 driver
+#define HARNESS_SERVO_MIN_PULSE_US 500.0f
+#define HARNESS_SERVO_MAX_PULSE_US 2500.0f
+
+//--------------------------------------------------------------------+
+// Harness State
+//--------------------------------------------------------------------+
+
+static struct {
+    firmware_harness_models_t models;
+    uint8_t io_type;
+
+    // Actuator state seen so far
+    uint16_t last_expander;
+    float last_pca_pulse[16];
+    float last_servo_pulse;
+
+    // Messages handed to the firmware, oldest first
+    firmware_harness_event_t pending[FIRMWARE_HARNESS_PENDING_SIZE];
+    uint16_t pending_head, pending_count;
+    firmware_harness_event_t current;   // Message the firmware is handling
+    bool in_callback;
+    usb_midi_rx_callback_t firmware_rx;
+
+    firmware_harness_change_cb_t change_cb;
+    void *change_user_data;
+    firmware_harness_dispatch_cb_t dispatch_cb;
+    void *dispatch_user_data;
+} harness;
+
+//--------------------------------------------------------------------+
+// Change Detection
+//--------------------------------------------------------------------+
+
+static float pulse_to_degrees(float pulse_us) {
+    if (pulse_us <= 0.0f) {
+        return 0.0f;
+    }
+    float deg = (pulse_us - HARNESS_SERVO_MIN_PULSE_US) * 180.0f /
+                (HARNESS_SERVO_MAX_PULSE_US - HARNESS_SERVO_MIN_PULSE_US);
+    return deg < 0.0f ? 0.0f : (deg > 180.0f ? 180.0f : deg);
+}
+
+static void report_change(uint64_t time_us, const char *actuator, const char *value) {
+    if (!harness.change_cb) {
+        return;
+    }
+    firmware_harness_change_t change;
+    change.time_us = time_us;
+    snprintf(change.actuator, sizeof(change.actuator), "%s", actuator);
+    snprintf(change.value, sizeof(change.value), "%s", value);
+    change.event = harness.in_callback ? &harness.current : NULL;
+    harness.change_cb(&change, harness.change_user_data);
+}
+
+static void check_expander(uint64_t time_us, uint16_t state, const char *name) {
+    uint16_t changed = state ^ harness.last_expander;
+    for (uint8_t pin = 0; pin < 16; pin++) {
+        if (changed & (1u << pin)) {
+            char actuator[24];
+            snprintf(actuator, sizeof(actuator), "%s.P%u", name, pin);
+            report_change(time_us, actuator, (state >> pin) & 1 ? "1" : "0");
+        }
+    }
+    harness.last_expander = state;
+}
+
+static void on_i2c_transfer(const i2c_sim_event_t *event, void *user_data) {
+    (void)user_data;
+    if (event->flags & (I2C_SIM_FLAG_READ | I2C_SIM_FLAG_NAK)) {
+        return;
+    }
+
+    // Outputs latch at STOP
+    uint64_t time_us = event->timestamp_us + (event->wire_time_ns + 999) / 1000;
+    firmware_harness_models_t *m = &harness.models;
+
+    if (event->address == m->pcf.base.address) {
+        check_expander(time_us, m->pcf.latch, "pcf8575");
+    } else if (event->address == m->ch423.base.address) {
+        check_expander(time_us, ch423_model_get_outputs(&m->ch423), "ch423");
+    } else if (event->address == m->pca.base.address || event->address == I2C_SIM_GENERAL_CALL) {
+        for (uint8_t ch = 0; ch < 16; ch++) {
+            float pulse = pca9685_model_get_pulse_us(&m->pca, ch);
+            if (pulse != harness.last_pca_pulse[ch]) {
+                char actuator[24], value[16];
+                snprintf(actuator, sizeof(actuator), "pca9685.ch%u", ch);
+                snprintf(value, sizeof(value), "%.1f", pulse_to_degrees(pulse));
+                report_change(time_us, actuator, value);
+                harness.last_pca_pulse[ch] = pulse;
+            }
+        }
+    }
+}
+
+static void on_gpio(uint pin, bool level, void *user_data) {
+    (void)user_data;
+    if (pin == FIRMWARE_HARNESS_STRIKER_PIN) {
+        report_change(hal_host_time_us(), "striker", level ? "1" : "0");
+    }
+}
+
+static void on_pwm(uint slice_num, uint chan, uint16_t level, void *user_data) {
+    (void)level;
+    (void)user_data;
+    if (slice_num == (FIRMWARE_HARNESS_SERVO_PIN >> 1) % 8 && chan == (FIRMWARE_HARNESS_SERVO_PIN & 1)) {
+        float pulse = hal_host_pwm_get_pulse_us(FIRMWARE_HARNESS_SERVO_PIN);
+        if (pulse > 0.0f && pulse != harness.last_servo_pulse) {
+            char value[16];
+            snprintf(value, sizeof(value), "%.1f", pulse_to_degrees(pulse));
+            report_change(hal_host_time_us(), "servo", value);
+            harness.last_servo_pulse = pulse;
+        }
+    }
+}
+
+/**
+ * Sits between usb_midi and the MIDI handler to know which message the
+ * firmware is working on
+ */
+static void harness_rx_callback(uint8_t status, uint8_t data1, uint8_t data2, void *user_data) {
+    // Channel messages map 1:1 to tracked packets; SysEx arrives byte by byte
+    // and is tracked by its closing F7
+    bool tracked = (status >= 0x80 && status < 0xF0) || status == 0xF7;
+    if (tracked && harness.pending_count) {
+        harness.current = harness.pending[harness.pending_head];
+        harness.pending_head = (harness.pending_head + 1) % FIRMWARE_HARNESS_PENDING_SIZE;
+        harness.pending_count--;
+        harness.in_callback = true;
+        if (harness.dispatch_cb) {
+            harness.dispatch_cb(&harness.current, hal_host_time_us(), harness.dispatch_user_data);
+        }
+    }
+
+    harness.firmware_rx(status, data1, data2, user_data);
+    harness.in_callback = false;
+}
+
+static void uart_to_stderr(const char *s, void *user_data) {
+    (void)user_data;
+    fputs(s, stderr);
+}
+
+//--------------------------------------------------------------------+
+// Setup
+//--------------------------------------------------------------------+
+
+static void attach_models(void) {
+    firmware_harness_models_t *m = &harness.models;
+
+    pcf857x_model_init(&m->pcf, FIRMWARE_HARNESS_BUS, FIRMWARE_HARNESS_PCF8575_ADDRESS, true);
+    ch423_model_init(&m->ch423, FIRMWARE_HARNESS_BUS, FIRMWARE_HARNESS_CH423_ADDRESS);
+    pca9685_model_init(&m->pca, FIRMWARE_HARNESS_BUS, FIRMWARE_HARNESS_PCA9685_ADDRESS);
+    at24cxx_model_init(&m->eeprom, FIRMWARE_HARNESS_BUS, FIRMWARE_HARNESS_EEPROM_ADDRESS,
+                       HARNESS_EEPROM_BYTES, HARNESS_EEPROM_PAGE);
+    ssd1306_model_init(&m->oled, FIRMWARE_HARNESS_BUS, FIRMWARE_HARNESS_OLED_ADDRESS);
+
+    i2c_sim_attach(&m->pcf.base);
+    i2c_sim_attach(&m->ch423.base);
+    i2c_sim_attach(&m->pca.base);
+    i2c_sim_attach(&m->eeprom.base);
+    i2c_sim_attach(&m->oled.base);
+}
+
+/**
+ * Store the requested settings in the EEPROM model the way the menu or
+ * SysEx commands would, so the firmware boots with them
+ */
+static bool preload_config(const firmware_harness_config_t *c) {
+    if (c->player < 0 && c->io_type < 0 && c->channel == 0 && c->low_note < 0 && c->note_range == 0) {
+        return true;
+    }
+
+    static config_manager_t config;
+    i2c_bus_init(i2c1, HARNESS_SDA_PIN, HARNESS_SCL_PIN, HARNESS_BUS_FREQ);
+    if (!config_init(&config, i2c1, FIRMWARE_HARNESS_EEPROM_ADDRESS, HARNESS_EEPROM_BYTES / 1024, 0x0000)) {
+        return false;
+    }
+
+    config_settings_t *s = config_get_settings(&config);
+    if (c->player >= 0) s->player_type = (uint8_t)c->player;
+    if (c->channel > 0) s->midi_channel = (uint8_t)c->channel;
+    if (c->low_note >= 0) s->low_note = (uint8_t)c->low_note;
+    if (c->note_range > 0) s->note_range = (uint8_t)c->note_range;
+    if (c->io_type >= 0) {
+        s->io_expander_type = (uint8_t)c->io_type;
+        s->io_expander_address = c->io_type == 1 ? FIRMWARE_HARNESS_CH423_ADDRESS
+                                                 : FIRMWARE_HARNESS_PCF8575_ADDRESS;
+    }
+    return config_save(&config);
+}
+
+bool firmware_harness_start(const firmware_harness_config_t *config) {
+    static const firmware_harness_config_t defaults = {
+        .player = -1, .io_type = -1, .channel = 0, .low_note = -1, .note_range = 0
+    };
+    if (!config) {
+        config = &defaults;
+    }
+
+    firmware_harness_change_cb_t change_cb = harness.change_cb;
+    void *change_user_data = harness.change_user_data;
+    firmware_harness_dispatch_cb_t dispatch_cb = harness.dispatch_cb;
+    void *dispatch_user_data = harness.dispatch_user_data;
+    memset(&harness, 0, sizeof(harness));
+    harness.change_cb = change_cb;
+    harness.change_user_data = change_user_data;
+    harness.dispatch_cb = dispatch_cb;
+    harness.dispatch_user_data = dispatch_user_data;
+
+    // Power on
+    hal_host_reset();
+    if (!i2c_sim_init(config->timeline_capacity)) {
+        return false;
+    }
+    attach_models();
+    if (config->show_uart) {
+        hal_host_uart_set_sink(uart_to_stderr, NULL);
+    }
+    if (!preload_config(config)) {
+        fprintf(stderr, "firmware_harness: failed to store the configuration\n");
+        return false;
+    }
+
+    uint32_t blink_ms = 0;
+    if (!midi_synthesizer_setup(&blink_ms)) {
+        fprintf(stderr, "firmware_harness: firmware setup failed (LED blink %u ms)\n", blink_ms);
+        return false;
+    }
+    if (config->omni) {
+        midi_handler_set_channel(0xFF);
+    }
+
+    // Watch the actuators from here on; boot-time writes are not reported
+    firmware_harness_models_t *m = &harness.models;
+    harness.io_type = config->io_type == 1 ? 1 : 0;
+    harness.firmware_rx = (usb_midi_rx_callback_t)midi_handler_get_callback();
+    usb_midi_set_rx_callback(harness_rx_callback, NULL);
+    harness.last_expander = harness.io_type == 1 ? ch423_model_get_outputs(&m->ch423) : m->pcf.latch;
+    for (uint8_t ch = 0; ch < 16; ch++) {
+        harness.last_pca_pulse[ch] = pca9685_model_get_pulse_us(&m->pca, ch);
+    }
+    harness.last_servo_pulse = hal_host_pwm_get_pulse_us(FIRMWARE_HARNESS_SERVO_PIN);
+
+    i2c_sim_clear();
+    i2c_sim_set_observer(on_i2c_transfer, NULL);
+    hal_host_gpio_set_observer(on_gpio, NULL);
+    hal_host_pwm_set_observer(on_pwm, NULL);
+    hal_host_usb_set_mounted(true);
+    return true;
+}
+
+void firmware_harness_stop(void) {
+    hal_host_gpio_set_observer(NULL, NULL);
+    hal_host_pwm_set_observer(NULL, NULL);
+    i2c_sim_deinit();
+}
+
+void firmware_harness_set_change_callback(firmware_harness_change_cb_t callback, void *user_data) {
+    harness.change_cb = callback;
+    harness.change_user_data = user_data;
+}
+
+void firmware_harness_set_dispatch_callback(firmware_harness_dispatch_cb_t callback, void *user_data) {
+    harness.dispatch_cb = callback;
+    harness.dispatch_user_data = user_data;
+}
+
+//--------------------------------------------------------------------+
+// MIDI Input
+//--------------------------------------------------------------------+
+
+bool firmware_harness_push_packet(const uint8_t packet[4], uint64_t intended_us) {
+    uint8_t cin = packet[0] & 0x0F;
+    bool channel_message = cin >= 0x08 && cin <= 0x0E;
+    bool sysex_end = cin >= 0x05 && cin <= 0x07;
+    bool tracked = channel_message || sysex_end;
+
+    if (tracked && harness.pending_count == FIRMWARE_HARNESS_PENDING_SIZE) {
+        return false;
+    }
+    if (!hal_host_usb_push_packet(packet)) {
+        return false;
+    }
+
+    if (tracked) {
+        firmware_harness_event_t *e = &harness.pending[(harness.pending_head + harness.pending_count) %
+                                                       FIRMWARE_HARNESS_PENDING_SIZE];
+        e->intended_us = intended_us;
+        e->status = channel_message ? packet[1] : 0xF0;
+        e->data1 = channel_message ? packet[2] : 0;
+        e->data2 = channel_message ? packet[3] : 0;
+        harness.pending_count++;
+    }
+    return true;
+}
+
+bool firmware_harness_push_sysex(const uint8_t *data, size_t length, uint64_t intended_us) {
+    size_t i = 0;
+    while (i < length) {
+        uint8_t packet[4] = {0};
+        size_t remaining = length - i;
+        if (remaining > 3) {
+            packet[0] = 0x04;  // SysEx start/continue
+            memcpy(&packet[1], &data[i], 3);
+            i += 3;
+        } else {
+            packet[0] = (uint8_t)(0x04 + remaining);  // SysEx end with 1-3 bytes
+            memcpy(&packet[1], &data[i], remaining);
+            i += remaining;
+        }
+        if (!firmware_harness_push_packet(packet, intended_us)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------+
+// Main Loop
+//--------------------------------------------------------------------+
+
+void firmware_harness_poll(void) {
+    midi_synthesizer_poll();
+}
+
+void firmware_harness_run_until(uint64_t time_us) {
+    while (hal_host_time_us() < time_us) {
+        midi_synthesizer_poll();
+    }
+}
+
+firmware_harness_models_t* firmware_harness_get_models(void) {
+    return &harness.models;
+}
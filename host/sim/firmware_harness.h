@@ -0,0 +1,155 @@
+#ifndef FIRMWARE_HARNESS_H
+#define FIRMWARE_HARNESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pcf857x_model.h"
+#include "ch423_model.h"
+#include "pca9685_model.h"
+#include "at24cxx_model.h"
+#include "ssd1306_model.h"
+
+/**
+ * Whole-firmware harness (host build)
+ *
+ * Boots the firmware (midi_synthesizer_setup()) on the virtual clock with
+ * the device models attached to the simulated I2C bus, feeds it USB-MIDI
+ * packets and reports every actuator change and every MIDI message the
+ * firmware picks up, each with the time it was meant to happen. Used by
+ * firmware_sim and the latency tests.
+ */
+
+// Board (mirrors src/midi_synthesizer.c and midi_handler.c)
+#define FIRMWARE_HARNESS_BUS              1       // i2c1 - actuators, OLED and EEPROM
+#define FIRMWARE_HARNESS_EEPROM_ADDRESS   0x50
+#define FIRMWARE_HARNESS_OLED_ADDRESS     0x3C
+#define FIRMWARE_HARNESS_PCF8575_ADDRESS  0x20
+#define FIRMWARE_HARNESS_CH423_ADDRESS    0x24
+#define FIRMWARE_HARNESS_PCA9685_ADDRESS  0x40
+#define FIRMWARE_HARNESS_SERVO_PIN        16      // Mallet servo PWM
+#define FIRMWARE_HARNESS_STRIKER_PIN      17      // Mallet striker GPIO
+
+// Messages handed to the firmware but not read yet (USB queue depth)
+#define FIRMWARE_HARNESS_PENDING_SIZE 256
+
+/**
+ * Settings stored in the EEPROM model before boot
+ *
+ * Negative (or 0 for channel and range) keeps the firmware defaults.
+ */
+typedef struct {
+    int player;        // PLAYER_TYPE_I2C_MIDI or PLAYER_TYPE_MALLET_MIDI
+    int io_type;       // 0 = PCF8575, 1 = CH423
+    int channel;       // 1-16
+    int low_note;      // 0-127
+    int note_range;    // 1-16
+    bool omni;         // Listen to all channels after boot
+    bool show_uart;    // Copy the debug UART to stderr
+    size_t timeline_capacity;  // Bus timeline entries (0 = I2C_SIM_TIMELINE_DEFAULT)
+} firmware_harness_config_t;
+
+/**
+ * A MIDI message handed to the firmware
+ */
+typedef struct {
+    uint64_t intended_us;   // Virtual time it should take effect
+    uint8_t status;         // 0xF0 for SysEx
+    uint8_t data1;
+    uint8_t data2;
+} firmware_harness_event_t;
+
+/**
+ * One actuator output change
+ */
+typedef struct {
+    uint64_t time_us;                        // Time the output changed
+    char actuator[24];                       // e.g. "pcf8575.P3", "servo"
+    char value[16];                          // Pin level or angle in degrees
+    const firmware_harness_event_t *event;   // Message being handled, NULL if from the main loop
+} firmware_harness_change_t;
+
+typedef void (*firmware_harness_change_cb_t)(const firmware_harness_change_t *change, void *user_data);
+
+/**
+ * Called when the firmware picks up a message, before it acts on it
+ *
+ * For SysEx this is when the closing F7 is read.
+ */
+typedef void (*firmware_harness_dispatch_cb_t)(const firmware_harness_event_t *event, uint64_t now_us,
+                                               void *user_data);
+
+/**
+ * Device models on the simulated bus
+ */
+typedef struct {
+    pcf857x_model_t pcf;
+    ch423_model_t ch423;
+    pca9685_model_t pca;
+    at24cxx_model_t eeprom;
+    ssd1306_model_t oled;
+} firmware_harness_models_t;
+
+/**
+ * Boot the firmware
+ *
+ * Resets the HAL shim and the simulated bus, attaches the models, stores
+ * the configuration, runs midi_synthesizer_setup() and mounts USB. The
+ * bus timeline and statistics are cleared afterwards, so they only cover
+ * what happens from here on.
+ *
+ * @param config Settings to boot with (NULL for firmware defaults)
+ * @return true if the firmware came up, false otherwise
+ */
+bool firmware_harness_start(const firmware_harness_config_t *config);
+
+/**
+ * Release the simulated bus
+ */
+void firmware_harness_stop(void);
+
+/**
+ * Set the actuator change callback
+ */
+void firmware_harness_set_change_callback(firmware_harness_change_cb_t callback, void *user_data);
+
+/**
+ * Set the dispatch callback
+ */
+void firmware_harness_set_dispatch_callback(firmware_harness_dispatch_cb_t callback, void *user_data);
+
+/**
+ * Hand one USB-MIDI packet to the firmware
+ *
+ * Channel messages and the packet that ends a SysEx are tracked with their
+ * intended time; other SysEx packets are passed through.
+ *
+ * @param packet USB-MIDI event packet (CIN in the low nibble of byte 0)
+ * @param intended_us Virtual time the message should take effect
+ * @return false if the USB queue or the tracking queue is full
+ */
+bool firmware_harness_push_packet(const uint8_t packet[4], uint64_t intended_us);
+
+/**
+ * Hand a complete SysEx message (F0 ... F7) to the firmware as packets
+ *
+ * @return false if the USB queue is full
+ */
+bool firmware_harness_push_sysex(const uint8_t *data, size_t length, uint64_t intended_us);
+
+/**
+ * Run one pass of the firmware main loop (midi_synthesizer_poll())
+ */
+void firmware_harness_poll(void);
+
+/**
+ * Run the main loop until the virtual clock reaches a time
+ */
+void firmware_harness_run_until(uint64_t time_us);
+
+/**
+ * Get the device models
+ */
+firmware_harness_models_t* firmware_harness_get_models(void);
+
+#endif // FIRMWARE_HARNESS_H
@@ -0,0 +1,299 @@
+/**
+ * Whole-firmware simulator (host build)
+ *
+ * Runs the firmware's own setup and main loop (src/midi_synthesizer.c)
+ * against the HAL shim's virtual clock and the simulated I2C bus, feeds it
+ * a Standard MIDI File over the stubbed USB MIDI interface and writes a
+ * timeline of every actuator change with its lateness against the time
+ * the MIDI event was meant to sound.
+ *
+ *   firmware_sim [options] song.mid > timeline.csv
+ */
+
+#include "firmware_harness.h"
+#include "hal_host.h"
+#include "i2c_sim.h"
+#include "smf.h"
+#include "configuration_settings.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+// Time between USB mount and the first note, and after the last one
+#define SIM_DEFAULT_LEAD_IN_MS 100
+#define SIM_DEFAULT_TAIL_MS    500
+
+//--------------------------------------------------------------------+
+// Simulator State
+//--------------------------------------------------------------------+
+
+typedef struct {
+    // Options
+    const char *midi_path;
+    const char *output_path;
+    const char *i2c_csv_path;
+    double speed;             // 0 = as fast as possible
+    firmware_harness_config_t config;
+    uint32_t tail_ms;
+
+    // Output and statistics
+    FILE *out;
+    uint64_t origin_us;       // Virtual time of MIDI file time 0
+    uint32_t changes;
+    uint32_t timed_changes;
+    uint64_t lateness_total_us;
+    uint64_t lateness_max_us;
+    uint32_t *lateness;       // All lateness values for percentiles
+    uint32_t lateness_capacity;
+} sim_t;
+
+static sim_t sim;
+
+//--------------------------------------------------------------------+
+// Timeline Output
+//--------------------------------------------------------------------+
+
+static void record_lateness(uint64_t lateness_us) {
+    if (sim.timed_changes == sim.lateness_capacity) {
+        uint32_t capacity = sim.lateness_capacity ? sim.lateness_capacity * 2 : 4096;
+        uint32_t *grown = realloc(sim.lateness, capacity * sizeof(uint32_t));
+        if (!grown) {
+            return;
+        }
+        sim.lateness = grown;
+        sim.lateness_capacity = capacity;
+    }
+    sim.lateness[sim.timed_changes++] = (uint32_t)lateness_us;
+    sim.lateness_total_us += lateness_us;
+    if (lateness_us > sim.lateness_max_us) {
+        sim.lateness_max_us = lateness_us;
+    }
+}
+
+/**
+ * Write one actuator change
+ *
+ * Changes made while the firmware handles a MIDI message are timed against
+ * that message. Changes from the main loop (striker release) have no
+ * intended time.
+ */
+static void on_change(const firmware_harness_change_t *change, void *user_data) {
+    (void)user_data;
+    const firmware_harness_event_t *e = change->event;
+
+    sim.changes++;
+    fprintf(sim.out, "%llu,%s,%s,", (unsigned long long)(change->time_us - sim.origin_us),
+            change->actuator, change->value);
+
+    if (e) {
+        uint64_t lateness = change->time_us > e->intended_us ? change->time_us - e->intended_us : 0;
+        record_lateness(lateness);
+        fprintf(sim.out, "%llu,%llu,%02X %02X %02X\n",
+                (unsigned long long)(e->intended_us - sim.origin_us),
+                (unsigned long long)lateness, e->status, e->data1, e->data2);
+    } else {
+        fprintf(sim.out, ",,loop\n");
+    }
+}
+
+//--------------------------------------------------------------------+
+// MIDI Input
+//--------------------------------------------------------------------+
+
+static bool push_event(const smf_event_t *e) {
+    uint64_t intended_us = sim.origin_us + e->time_us;
+    if (e->status == 0xF0) {
+        return firmware_harness_push_sysex(e->sysex, e->sysex_length, intended_us);
+    }
+    uint8_t packet[4] = { e->status >> 4, e->status, e->data1, e->data2 };
+    return firmware_harness_push_packet(packet, intended_us);
+}
+
+//--------------------------------------------------------------------+
+// Main Loop
+//--------------------------------------------------------------------+
+
+static uint64_t wall_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+/**
+ * One pass of the firmware main loop, paced against the wall clock when
+ * running at a fixed speed
+ */
+static void poll_firmware(uint64_t virtual_start_us, uint64_t wall_start_us) {
+    firmware_harness_poll();
+
+    if (sim.speed > 0.0) {
+        uint64_t target = wall_start_us +
+            (uint64_t)((hal_host_time_us() - virtual_start_us) / sim.speed);
+        uint64_t now = wall_us();
+        if (target > now) {
+            struct timespec ts = { (time_t)((target - now) / 1000000), (long)((target - now) % 1000000) * 1000 };
+            nanosleep(&ts, NULL);
+        }
+    }
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_summary(const smf_file_t *smf) {
+    fprintf(stderr, "firmware_sim: %zu events, %.3f s, %u actuator changes\n",
+            smf->event_count, smf->duration_us / 1e6, sim.changes);
+
+    if (sim.timed_changes) {
+        qsort(sim.lateness, sim.timed_changes, sizeof(uint32_t), compare_u32);
+        uint32_t p50 = sim.lateness[sim.timed_changes / 2];
+        uint32_t p99 = sim.lateness[(uint32_t)((sim.timed_changes - 1) * 0.99)];
+        fprintf(stderr, "lateness: mean %llu us, p50 %u us, p99 %u us, max %llu us\n",
+                (unsigned long long)(sim.lateness_total_us / sim.timed_changes), p50, p99,
+                (unsigned long long)sim.lateness_max_us);
+    }
+    i2c_sim_print_summary(stderr);
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [options] file.mid\n"
+        "  -o FILE          actuator timeline CSV (default stdout)\n"
+        "  --i2c-csv FILE   I2C bus timeline CSV\n"
+        "  --speed X        0 = as fast as possible (default), 1 = real time\n"
+        "  --player P       i2c | mallet (stored in the EEPROM config)\n"
+        "  --io T           pcf8575 | ch423 (stored in the EEPROM config)\n"
+        "  --channel N      MIDI channel 1-16 (stored in the EEPROM config)\n"
+        "  --low-note N     lowest note (stored in the EEPROM config)\n"
+        "  --range N        number of notes (stored in the EEPROM config)\n"
+        "  --omni           listen to all channels\n"
+        "  --tail-ms N      keep running after the last event (default %d)\n"
+        "  --uart           copy the debug UART to stderr\n",
+        argv0, SIM_DEFAULT_TAIL_MS);
+}
+
+static bool parse_args(int argc, char **argv) {
+    sim.config.player = -1;
+    sim.config.io_type = -1;
+    sim.config.low_note = -1;
+    sim.tail_ms = SIM_DEFAULT_TAIL_MS;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *next = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--omni") == 0) {
+            sim.config.omni = true;
+        } else if (strcmp(arg, "--uart") == 0) {
+            sim.config.show_uart = true;
+        } else if (arg[0] == '-' && !next) {
+            fprintf(stderr, "%s needs a value\n", arg);
+            return false;
+        } else if (strcmp(arg, "-o") == 0) {
+            sim.output_path = argv[++i];
+        } else if (strcmp(arg, "--i2c-csv") == 0) {
+            sim.i2c_csv_path = argv[++i];
+        } else if (strcmp(arg, "--speed") == 0) {
+            sim.speed = atof(argv[++i]);
+        } else if (strcmp(arg, "--player") == 0) {
+            i++;
+            sim.config.player = strcmp(next, "mallet") == 0 ? PLAYER_TYPE_MALLET_MIDI : PLAYER_TYPE_I2C_MIDI;
+        } else if (strcmp(arg, "--io") == 0) {
+            i++;
+            sim.config.io_type = strcmp(next, "ch423") == 0 ? 1 : 0;
+        } else if (strcmp(arg, "--channel") == 0) {
+            sim.config.channel = atoi(argv[++i]);
+        } else if (strcmp(arg, "--low-note") == 0) {
+            sim.config.low_note = atoi(argv[++i]);
+        } else if (strcmp(arg, "--range") == 0) {
+            sim.config.note_range = atoi(argv[++i]);
+        } else if (strcmp(arg, "--tail-ms") == 0) {
+            sim.tail_ms = (uint32_t)atoi(argv[++i]);
+        } else if (arg[0] == '-') {
+            return false;
+        } else {
+            sim.midi_path = arg;
+        }
+    }
+
+    if (sim.config.channel < 0 || sim.config.channel > 16 || sim.config.low_note > 127 ||
+        sim.config.note_range > 16) {
+        fprintf(stderr, "channel, low note or range out of range\n");
+        return false;
+    }
+    return sim.midi_path != NULL;
+}
+
+int main(int argc, char **argv) {
+    if (!parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    smf_file_t smf;
+    char error[128];
+    if (!smf_load(sim.midi_path, &smf, error, sizeof(error))) {
+        fprintf(stderr, "firmware_sim: %s\n", error);
+        return 1;
+    }
+
+    sim.out = sim.output_path ? fopen(sim.output_path, "w") : stdout;
+    if (!sim.out) {
+        fprintf(stderr, "firmware_sim: can't write %s\n", sim.output_path);
+        return 1;
+    }
+
+    firmware_harness_set_change_callback(on_change, NULL);
+    if (!firmware_harness_start(&sim.config)) {
+        return 1;
+    }
+
+    fprintf(sim.out, "time_us,actuator,value,event_time_us,lateness_us,event\n");
+
+    sim.origin_us = hal_host_time_us() + SIM_DEFAULT_LEAD_IN_MS * 1000;
+    uint64_t virtual_start = hal_host_time_us();
+    uint64_t wall_start = wall_us();
+
+    size_t next = 0;
+    while (next < smf.event_count) {
+        // Hand over everything that is due, as the host's USB stack would
+        while (next < smf.event_count && sim.origin_us + smf.events[next].time_us <= hal_host_time_us()) {
+            if (!push_event(&smf.events[next])) {
+                break;  // USB queue full - firmware has fallen behind
+            }
+            next++;
+        }
+        poll_firmware(virtual_start, wall_start);
+    }
+
+    uint64_t end_us = hal_host_time_us() + (uint64_t)sim.tail_ms * 1000;
+    while (hal_host_time_us() < end_us) {
+        poll_firmware(virtual_start, wall_start);
+    }
+
+    if (sim.i2c_csv_path) {
+        FILE *csv = fopen(sim.i2c_csv_path, "w");
+        if (csv) {
+            i2c_sim_write_timeline_csv(csv);
+            fclose(csv);
+        }
+    }
+
+    print_summary(&smf);
+
+    if (sim.out != stdout) {
+        fclose(sim.out);
+    }
+    free(sim.lateness);
+    smf_free(&smf);
+    firmware_harness_stop();
+    return 0;
+}
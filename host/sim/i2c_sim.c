@@ -0,0 +1,345 @@
+#include "i2c_sim.h"
+#include "hal_host.h"
+#include "pico/error.h"
+#include <stdlib.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Internal State
+//--------------------------------------------------------------------+
+
+#define I2C_SIM_NUM_BUSES 2
+
+static i2c_sim_device_t *devices[I2C_SIM_MAX_DEVICES];
+static uint8_t device_count = 0;
+
+static i2c_sim_event_t *timeline = NULL;
+static size_t timeline_capacity = 0;
+static size_t timeline_count = 0;
+
+static uint64_t bus_time_ns[I2C_SIM_NUM_BUSES];
+static uint32_t pending_ns = 0;  // Sub-microsecond remainder not yet charged
+static bool charge_time = true;
+
+static i2c_sim_observer_t observer = NULL;
+static void *observer_data = NULL;
+
+// A device holding SDA low on a bus, see i2c_sim_stick_sda()
+typedef struct {
+    bool stuck;
+    uint sda_pin;
+    uint scl_pin;
+    uint8_t clocks;                // SCL clocks still needed to let go (above 9: never)
+} sda_fault_t;
+
+static sda_fault_t sda_faults[I2C_SIM_NUM_BUSES];
+
+//--------------------------------------------------------------------+
+// Helpers
+//--------------------------------------------------------------------+
+
+static i2c_sim_device_t* find_device(uint8_t bus, uint8_t address) {
+    for (uint8_t i = 0; i < device_count; i++) {
+        if (devices[i]->bus == bus && devices[i]->address == address) {
+            return devices[i];
+        }
+    }
+    return NULL;
+}
+
+static const char* device_name(uint8_t bus, uint8_t address) {
+    if (address == I2C_SIM_GENERAL_CALL) {
+        return "general_call";
+    }
+    i2c_sim_device_t *dev = find_device(bus, address);
+    return dev && dev->name ? dev->name : "-";
+}
+
+/**
+ * Log a transfer and charge its wire time to the virtual clock
+ */
+static void charge(uint8_t bus, uint8_t address, uint8_t flags, size_t len, uint64_t start_us,
+                   uint32_t timeout_us) {
+    uint32_t baudrate = hal_host_i2c_get_baudrate(bus);
+    // A NAKed address ends the transfer after the address byte; a timed
+    // out one holds the bus until the controller gives up
+    uint32_t wire_ns = i2c_sim_wire_time_ns((flags & I2C_SIM_FLAG_NAK) ? 0 : len, baudrate);
+    if (flags & I2C_SIM_FLAG_TIMEOUT) {
+        wire_ns = timeout_us * 1000u;
+    }
+
+    bus_time_ns[bus] += wire_ns;
+
+    i2c_sim_event_t event = {
+        .timestamp_us = start_us,
+        .wire_time_ns = wire_ns,
+        .baudrate = baudrate,
+        .length = (uint16_t)len,
+        .bus = bus,
+        .address = address,
+        .flags = flags,
+    };
+    if (timeline_count < timeline_capacity) {
+        timeline[timeline_count++] = event;
+    }
+
+    i2c_sim_device_t *dev = find_device(bus, address);
+    if (dev) {
+        dev->stats.transactions++;
+        dev->stats.wire_time_ns += wire_ns;
+        if (flags & I2C_SIM_FLAG_TIMEOUT) {
+            dev->stats.timeouts++;
+        } else if (flags & I2C_SIM_FLAG_NAK) {
+            dev->stats.naks++;
+        } else {
+            dev->stats.bytes += len;
+        }
+    }
+
+    if (charge_time) {
+        pending_ns += wire_ns;
+        uint32_t us = pending_ns / 1000;
+        pending_ns %= 1000;
+        if (us) {
+            hal_host_time_advance_us(us);
+        }
+    }
+
+    if (observer) {
+        observer(&event, observer_data);
+    }
+}
+
+/**
+ * Take one transfer's worth of a device's fault
+ */
+static i2c_sim_fault_t take_fault(i2c_sim_device_t *dev) {
+    i2c_sim_fault_t fault = dev->fault;
+    if (fault != I2C_SIM_FAULT_NONE && dev->fault_transfers && --dev->fault_transfers == 0) {
+        dev->fault = I2C_SIM_FAULT_NONE;
+    }
+    return fault;
+}
+
+/**
+ * SCL let go by hand while SDA is held: one clock for the stuck device
+ */
+static void sda_fault_clock(uint pin, bool out, void *user_data) {
+    (void)user_data;
+    if (out) {
+        return;
+    }
+    for (uint8_t bus = 0; bus < I2C_SIM_NUM_BUSES; bus++) {
+        sda_fault_t *fault = &sda_faults[bus];
+        if (!fault->stuck || fault->scl_pin != pin || fault->clocks > 9) {
+            continue;
+        }
+        if (--fault->clocks == 0) {
+            fault->stuck = false;
+            hal_host_gpio_release_input(fault->sda_pin);
+        }
+    }
+}
+
+//--------------------------------------------------------------------+
+// HAL Handler
+//--------------------------------------------------------------------+
+
+static int sim_transfer(uint8_t bus, uint8_t address, bool read, uint8_t *data, size_t len,
+                        bool nostop, void *user_data) {
+    (void)user_data;
+    if (bus >= I2C_SIM_NUM_BUSES) {
+        return PICO_ERROR_GENERIC;
+    }
+
+    uint64_t start_us = hal_host_time_us();
+    uint32_t timeout_us = hal_host_i2c_get_timeout_us();
+    uint8_t flags = (read ? I2C_SIM_FLAG_READ : 0) | (nostop ? I2C_SIM_FLAG_NOSTOP : 0);
+    int result = PICO_ERROR_GENERIC;
+    i2c_sim_fault_t fault = I2C_SIM_FAULT_NONE;
+
+    if (sda_faults[bus].stuck) {
+        // No START gets through while SDA is low
+        fault = I2C_SIM_FAULT_TIMEOUT;
+    } else if (address == I2C_SIM_GENERAL_CALL && !read) {
+        // Broadcast; ACKed if any model on the bus listens
+        for (uint8_t i = 0; i < device_count; i++) {
+            if (devices[i]->bus == bus && devices[i]->ops->general_call) {
+                devices[i]->ops->general_call(devices[i], data, len);
+                result = (int)len;
+            }
+        }
+    } else {
+        i2c_sim_device_t *dev = find_device(bus, address);
+        if (dev) {
+            fault = take_fault(dev);
+        }
+        if (dev && fault == I2C_SIM_FAULT_NONE) {
+            if (read) {
+                result = dev->ops->read ? dev->ops->read(dev, data, len, nostop) : PICO_ERROR_GENERIC;
+            } else {
+                result = dev->ops->write ? dev->ops->write(dev, data, len, nostop) : PICO_ERROR_GENERIC;
+            }
+        }
+    }
+
+    if (fault == I2C_SIM_FAULT_TIMEOUT && timeout_us) {
+        flags |= I2C_SIM_FLAG_TIMEOUT;
+        result = PICO_ERROR_TIMEOUT;
+    } else if (fault != I2C_SIM_FAULT_NONE || result < 0) {
+        flags |= I2C_SIM_FLAG_NAK;
+        result = PICO_ERROR_GENERIC;
+    }
+
+    charge(bus, address, flags, len, start_us, timeout_us);
+    return result;
+}
+
+//--------------------------------------------------------------------+
+// Public API
+//--------------------------------------------------------------------+
+
+bool i2c_sim_init(size_t capacity) {
+    i2c_sim_deinit();
+
+    timeline_capacity = capacity ? capacity : I2C_SIM_TIMELINE_DEFAULT;
+    timeline = calloc(timeline_capacity, sizeof(i2c_sim_event_t));
+    if (!timeline) {
+        timeline_capacity = 0;
+        return false;
+    }
+
+    charge_time = true;
+    observer = NULL;
+    observer_data = NULL;
+    hal_host_i2c_set_handler(sim_transfer, NULL);
+    return true;
+}
+
+void i2c_sim_deinit(void) {
+    hal_host_i2c_set_handler(NULL, NULL);
+    for (uint8_t bus = 0; bus < I2C_SIM_NUM_BUSES; bus++) {
+        i2c_sim_stick_sda(bus, sda_faults[bus].sda_pin, sda_faults[bus].scl_pin, 0);
+    }
+    free(timeline);
+    timeline = NULL;
+    timeline_capacity = 0;
+    timeline_count = 0;
+    device_count = 0;
+    pending_ns = 0;
+    memset(bus_time_ns, 0, sizeof(bus_time_ns));
+}
+
+bool i2c_sim_attach(i2c_sim_device_t *dev) {
+    if (!dev || !dev->ops || dev->bus >= I2C_SIM_NUM_BUSES ||
+        device_count >= I2C_SIM_MAX_DEVICES || find_device(dev->bus, dev->address)) {
+        return false;
+    }
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->fault = I2C_SIM_FAULT_NONE;
+    dev->fault_transfers = 0;
+    devices[device_count++] = dev;
+    return true;
+}
+
+void i2c_sim_set_fault(i2c_sim_device_t *dev, i2c_sim_fault_t fault, uint32_t transfers) {
+    if (dev) {
+        dev->fault = fault;
+        dev->fault_transfers = transfers;
+    }
+}
+
+void i2c_sim_stick_sda(uint8_t bus, uint sda_pin, uint scl_pin, uint8_t clocks) {
+    if (bus >= I2C_SIM_NUM_BUSES) {
+        return;
+    }
+
+    sda_fault_t *fault = &sda_faults[bus];
+    if (fault->stuck) {
+        hal_host_gpio_release_input(fault->sda_pin);
+    }
+    fault->stuck = clocks > 0;
+    fault->sda_pin = sda_pin;
+    fault->scl_pin = scl_pin;
+    fault->clocks = clocks;
+
+    if (fault->stuck) {
+        hal_host_gpio_set_input(sda_pin, false);
+        hal_host_gpio_set_dir_observer(sda_fault_clock, NULL);
+    }
+}
+
+bool i2c_sim_is_sda_stuck(uint8_t bus) {
+    return bus < I2C_SIM_NUM_BUSES && sda_faults[bus].stuck;
+}
+
+void i2c_sim_set_observer(i2c_sim_observer_t fn, void *user_data) {
+    observer = fn;
+    observer_data = user_data;
+}
+
+void i2c_sim_set_charge_time(bool enable) {
+    charge_time = enable;
+}
+
+uint32_t i2c_sim_wire_time_ns(size_t len, uint32_t baudrate) {
+    if (baudrate == 0) {
+        return 0;
+    }
+    // START + (address + payload) x 9 clocks + STOP
+    uint64_t bits = 1 + 9 * ((uint64_t)len + 1) + 1;
+    return (uint32_t)((bits * 1000000000ull + baudrate / 2) / baudrate);
+}
+
+uint64_t i2c_sim_get_bus_time_ns(uint8_t bus) {
+    return bus < I2C_SIM_NUM_BUSES ? bus_time_ns[bus] : 0;
+}
+
+const i2c_sim_event_t* i2c_sim_get_timeline(size_t *count) {
+    if (count) {
+        *count = timeline_count;
+    }
+    return timeline;
+}
+
+void i2c_sim_clear(void) {
+    timeline_count = 0;
+    pending_ns = 0;
+    memset(bus_time_ns, 0, sizeof(bus_time_ns));
+    for (uint8_t i = 0; i < device_count; i++) {
+        memset(&devices[i]->stats, 0, sizeof(devices[i]->stats));
+    }
+}
+
+void i2c_sim_write_timeline_csv(FILE *out) {
+    fprintf(out, "timestamp_us,bus,address,device,dir,length,wire_ns,baud,nak,timeout\n");
+    for (size_t i = 0; i < timeline_count; i++) {
+        const i2c_sim_event_t *e = &timeline[i];
+        fprintf(out, "%llu,i2c%u,0x%02X,%s,%c,%u,%u,%u,%u,%u\n",
+                (unsigned long long)e->timestamp_us, e->bus, e->address,
+                device_name(e->bus, e->address),
+                (e->flags & I2C_SIM_FLAG_READ) ? 'R' : 'W',
+                e->length, e->wire_time_ns, e->baudrate,
+                (e->flags & I2C_SIM_FLAG_NAK) ? 1 : 0,
+                (e->flags & I2C_SIM_FLAG_TIMEOUT) ? 1 : 0);
+    }
+}
+
+void i2c_sim_print_summary(FILE *out) {
+    for (uint8_t bus = 0; bus < I2C_SIM_NUM_BUSES; bus++) {
+        if (bus_time_ns[bus]) {
+            fprintf(out, "i2c%u: %llu us bus time\n", bus,
+                    (unsigned long long)(bus_time_ns[bus] / 1000));
+        }
+    }
+    for (uint8_t i = 0; i < device_count; i++) {
+        const i2c_sim_device_t *dev = devices[i];
+        fprintf(out, "  0x%02X %-8s i2c%u: %u txn, %u bytes, %u nak, %u timeout, %llu us\n",
+                dev->address, dev->name ? dev->name : "-", dev->bus,
+                dev->stats.transactions, dev->stats.bytes, dev->stats.naks, dev->stats.timeouts,
+                (unsigned long long)(dev->stats.wire_time_ns / 1000));
+    }
+    if (timeline_count == timeline_capacity) {
+        fprintf(out, "  (timeline full at %zu entries)\n", timeline_capacity);
+    }
+}
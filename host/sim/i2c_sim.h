@@ -0,0 +1,239 @@
+#ifndef I2C_SIM_H
+#define I2C_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "pico/types.h"
+
+/**
+ * Simulated I2C bus (host build)
+ *
+ * Takes over the HAL shim's I2C handler and routes every transfer to a
+ * device model attached at that bus and address. Each transfer is charged
+ * its wire time at the bus speed the controller is programmed to: the
+ * virtual clock advances by that much and the transfer is added to a
+ * timestamped timeline. Addresses without a model NAK.
+ *
+ * Faults can be injected per device (NAK, SCL held past the transfer
+ * timeout) or per bus (a device holding SDA low until it is clocked free).
+ */
+
+// Maximum number of attached models
+#define I2C_SIM_MAX_DEVICES 16
+
+// Default timeline capacity (entries), see i2c_sim_init()
+#define I2C_SIM_TIMELINE_DEFAULT 8192
+
+// I2C general call address (PCA9685 SWRST)
+#define I2C_SIM_GENERAL_CALL 0x00
+
+// Timeline entry flags
+#define I2C_SIM_FLAG_READ    0x01  // Read transfer
+#define I2C_SIM_FLAG_NAK     0x02  // Not acknowledged
+#define I2C_SIM_FLAG_NOSTOP  0x04  // Ended with a repeated start
+#define I2C_SIM_FLAG_TIMEOUT 0x08  // Held until the controller's timeout
+
+/**
+ * Device faults, see i2c_sim_set_fault()
+ */
+typedef enum {
+    I2C_SIM_FAULT_NONE = 0,
+    I2C_SIM_FAULT_NAK,        // The address is not acknowledged
+    I2C_SIM_FAULT_TIMEOUT,    // SCL is held low (stretched) until the transfer times out
+} i2c_sim_fault_t;
+
+typedef struct i2c_sim_device i2c_sim_device_t;
+
+/**
+ * Device model callbacks
+ *
+ * write/read return the number of bytes acknowledged, or a negative value
+ * to NAK the address. general_call is optional.
+ */
+typedef struct {
+    int (*write)(i2c_sim_device_t *dev, const uint8_t *data, size_t len, bool nostop);
+    int (*read)(i2c_sim_device_t *dev, uint8_t *data, size_t len, bool nostop);
+    void (*general_call)(i2c_sim_device_t *dev, const uint8_t *data, size_t len);
+} i2c_sim_device_ops_t;
+
+/**
+ * Per-device traffic counters
+ */
+typedef struct {
+    uint32_t transactions;    // Transfers addressed to the device
+    uint32_t bytes;           // Payload bytes transferred
+    uint32_t naks;            // Transfers the device did not acknowledge
+    uint32_t timeouts;        // Transfers that ran into the controller's timeout
+    uint64_t wire_time_ns;    // Bus time taken by the device's transfers
+} i2c_sim_device_stats_t;
+
+/**
+ * Common part of every device model (first member of the model struct)
+ */
+struct i2c_sim_device {
+    const i2c_sim_device_ops_t *ops;
+    const char *name;
+    uint8_t bus;              // Controller index (0 or 1)
+    uint8_t address;          // 7-bit address
+    i2c_sim_device_stats_t stats;
+    i2c_sim_fault_t fault;    // Injected fault, see i2c_sim_set_fault()
+    uint32_t fault_transfers; // Transfers the fault still affects, 0 = all
+};
+
+/**
+ * One transfer on the timeline
+ */
+typedef struct {
+    uint64_t timestamp_us;    // Virtual time at START
+    uint32_t wire_time_ns;    // START to STOP/repeated START
+    uint32_t baudrate;        // Bus speed the transfer ran at
+    uint16_t length;          // Payload bytes
+    uint8_t bus;              // Controller index
+    uint8_t address;          // 7-bit address
+    uint8_t flags;            // I2C_SIM_FLAG_*
+} i2c_sim_event_t;
+
+/**
+ * Transfer observer
+ *
+ * Called after every transfer, once the device model has processed it and
+ * the wire time has been charged.
+ *
+ * @param event The transfer
+ * @param user_data Pointer given to i2c_sim_set_observer()
+ */
+typedef void (*i2c_sim_observer_t)(const i2c_sim_event_t *event, void *user_data);
+
+/**
+ * Initialize the simulated bus and install it as the HAL I2C handler
+ *
+ * Detaches all models and clears the timeline. Call after hal_host_reset().
+ *
+ * @param timeline_capacity Timeline entries to keep (0 = I2C_SIM_TIMELINE_DEFAULT);
+ *                          later transfers are still counted but not logged
+ * @return true if successful, false if the timeline can't be allocated
+ */
+bool i2c_sim_init(size_t timeline_capacity);
+
+/**
+ * Free the timeline and remove the HAL I2C handler
+ */
+void i2c_sim_deinit(void);
+
+/**
+ * Attach a device model
+ *
+ * The model must have been initialized by its *_model_init() function and
+ * must stay valid until i2c_sim_deinit().
+ *
+ * @param dev Model to attach
+ * @return true if successful, false if the address is taken or the table is full
+ */
+bool i2c_sim_attach(i2c_sim_device_t *dev);
+
+/**
+ * Inject a fault into an attached device
+ *
+ * A timed-out transfer holds the bus for the timeout the controller was
+ * given (hal_host_i2c_get_timeout_us()) and returns PICO_ERROR_TIMEOUT; a
+ * transfer without a timeout NAKs instead, as it would never end.
+ *
+ * @param dev Attached model
+ * @param fault Fault, or I2C_SIM_FAULT_NONE to clear it
+ * @param transfers Number of transfers it affects, 0 = until cleared
+ */
+void i2c_sim_set_fault(i2c_sim_device_t *dev, i2c_sim_fault_t fault, uint32_t transfers);
+
+/**
+ * Hold SDA low on a bus, as a device stuck in the middle of a byte does
+ *
+ * Every transfer on the bus times out and the SDA pin reads low until SCL
+ * has been clocked by hand (bus recovery, see hal_host_gpio_set_dir_observer())
+ * the given number of times.
+ *
+ * @param bus Controller index (0 or 1)
+ * @param sda_pin SDA GPIO
+ * @param scl_pin SCL GPIO
+ * @param clocks SCL clocks until SDA is let go; above 9 it never is, 0 lets go now
+ */
+void i2c_sim_stick_sda(uint8_t bus, uint sda_pin, uint scl_pin, uint8_t clocks);
+
+/**
+ * Check whether SDA is still held low on a bus
+ *
+ * @param bus Controller index (0 or 1)
+ * @return true while i2c_sim_stick_sda() holds it
+ */
+bool i2c_sim_is_sda_stuck(uint8_t bus);
+
+/**
+ * Set a function called after every transfer
+ *
+ * @param observer Observer, or NULL to remove it
+ * @param user_data Passed to the observer
+ */
+void i2c_sim_set_observer(i2c_sim_observer_t observer, void *user_data);
+
+/**
+ * Enable or disable charging wire time to the virtual clock
+ *
+ * Wire time is always recorded; when charging is off the clock does not
+ * move during transfers. Default: on.
+ *
+ * @param enable true to advance the clock by the wire time of each transfer
+ */
+void i2c_sim_set_charge_time(bool enable);
+
+/**
+ * Wire time of a transfer
+ *
+ * START + address byte + payload bytes (9 clocks each with ACK) + STOP.
+ *
+ * @param len Payload bytes
+ * @param baudrate Bus speed in Hz
+ * @return Wire time in nanoseconds
+ */
+uint32_t i2c_sim_wire_time_ns(size_t len, uint32_t baudrate);
+
+/**
+ * Get the total bus time used on a controller
+ *
+ * @param bus Controller index (0 or 1)
+ * @return Wire time in nanoseconds since i2c_sim_init()/i2c_sim_clear()
+ */
+uint64_t i2c_sim_get_bus_time_ns(uint8_t bus);
+
+/**
+ * Get the timeline
+ *
+ * @param count Pointer to store the number of entries
+ * @return Entries in time order
+ */
+const i2c_sim_event_t* i2c_sim_get_timeline(size_t *count);
+
+/**
+ * Clear the timeline, bus time totals and device counters
+ *
+ * Device model state (registers, memory contents) is kept.
+ */
+void i2c_sim_clear(void);
+
+/**
+ * Write the timeline as CSV
+ *
+ * Columns: timestamp_us, bus, address, device, dir, length, wire_ns, baud, nak, timeout
+ *
+ * @param out Output stream
+ */
+void i2c_sim_write_timeline_csv(FILE *out);
+
+/**
+ * Print per-device totals
+ *
+ * @param out Output stream
+ */
+void i2c_sim_print_summary(FILE *out);
+
+#endif // I2C_SIM_H
@@ -0,0 +1,94 @@
+#include "at24cxx_model.h"
+#include "hal_host.h"
+#include "pico/error.h"
+#include <string.h>
+
+static uint8_t address_bytes(const at24cxx_model_t *m) {
+    return m->capacity > 2048 ? 2 : 1;
+}
+
+bool at24cxx_model_is_busy(const at24cxx_model_t *model) {
+    return hal_host_time_us() < model->busy_until_us;
+}
+
+static int at24cxx_write(i2c_sim_device_t *dev, const uint8_t *data, size_t len, bool nostop) {
+    at24cxx_model_t *m = (at24cxx_model_t *)dev;
+
+    if (at24cxx_model_is_busy(m)) {
+        m->busy_naks++;
+        return PICO_ERROR_GENERIC;
+    }
+
+    uint8_t addr_len = address_bytes(m);
+    if (len < addr_len) {
+        return (int)len;  // Address probe or incomplete address
+    }
+
+    uint32_t word = addr_len == 2 ? ((uint32_t)data[0] << 8) | data[1] : data[0];
+    word %= m->capacity;
+    m->pointer = word;
+
+    size_t data_len = len - addr_len;
+    if (data_len == 0) {
+        return (int)len;  // Dummy write before a random read
+    }
+    if (nostop) {
+        return (int)len;  // Repeated START aborts the write, nothing is programmed
+    }
+
+    // Latch into the page buffer: the low address bits wrap, the page stays
+    uint32_t page_base = word - (word % m->page_size);
+    uint32_t offset = word % m->page_size;
+    if (offset + data_len > m->page_size) {
+        m->page_wraps++;
+    }
+    for (size_t i = 0; i < data_len; i++) {
+        m->mem[page_base + offset] = data[addr_len + i];
+        offset = (offset + 1) % m->page_size;
+    }
+    m->pointer = page_base + offset;
+
+    m->busy_until_us = hal_host_time_us() + m->write_cycle_us;
+    m->page_writes++;
+    return (int)len;
+}
+
+static int at24cxx_read(i2c_sim_device_t *dev, uint8_t *data, size_t len, bool nostop) {
+    at24cxx_model_t *m = (at24cxx_model_t *)dev;
+    (void)nostop;
+
+    if (at24cxx_model_is_busy(m)) {
+        m->busy_naks++;
+        return PICO_ERROR_GENERIC;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        data[i] = m->mem[m->pointer];
+        m->pointer = (m->pointer + 1) % m->capacity;
+    }
+    return (int)len;
+}
+
+static const i2c_sim_device_ops_t at24cxx_ops = {
+    .write = at24cxx_write,
+    .read = at24cxx_read,
+};
+
+bool at24cxx_model_init(at24cxx_model_t *model, uint8_t bus, uint8_t address,
+                        uint32_t capacity, uint16_t page_size) {
+    if (capacity == 0 || capacity > AT24CXX_MODEL_MAX_BYTES || page_size == 0 ||
+        capacity % page_size != 0) {
+        return false;
+    }
+
+    memset(model, 0, sizeof(*model));
+    model->base.ops = &at24cxx_ops;
+    model->base.name = "AT24Cxx";
+    model->base.bus = bus;
+    model->base.address = address;
+    model->capacity = capacity;
+    model->page_size = page_size;
+    model->write_cycle_us = AT24CXX_MODEL_WRITE_CYCLE_US;
+    memset(model->mem, 0xFF, capacity);
+    return true;
+}
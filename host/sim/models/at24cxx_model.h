@@ -0,0 +1,56 @@
+#ifndef AT24CXX_MODEL_H
+#define AT24CXX_MODEL_H
+
+#include "../i2c_sim.h"
+
+// Largest supported part (AT24C256)
+#define AT24CXX_MODEL_MAX_BYTES 32768
+
+// Self-timed write cycle (tWR max)
+#define AT24CXX_MODEL_WRITE_CYCLE_US 5000
+
+/**
+ * AT24Cxx EEPROM model
+ *
+ * A write starts with the word address (two bytes above 2KB, one byte
+ * otherwise); the following data bytes are latched and programmed at STOP.
+ * Data that runs past the end of a page wraps to the start of the same page,
+ * as on the real part. While the write cycle runs the device NAKs every
+ * transfer. Reads are sequential from the address pointer and roll over at
+ * the end of the memory. Power-on contents are 0xFF.
+ */
+typedef struct {
+    i2c_sim_device_t base;
+    uint8_t mem[AT24CXX_MODEL_MAX_BYTES];
+    uint32_t capacity;            // Bytes
+    uint16_t page_size;           // Bytes
+    uint32_t pointer;             // Current word address
+    uint32_t write_cycle_us;      // Busy time after a write (default AT24CXX_MODEL_WRITE_CYCLE_US)
+    uint64_t busy_until_us;       // End of the running write cycle
+    uint32_t page_writes;         // Write cycles started
+    uint32_t busy_naks;           // Transfers NAKed during a write cycle
+    uint32_t page_wraps;          // Writes that wrapped within a page
+} at24cxx_model_t;
+
+/**
+ * Initialize the model
+ *
+ * @param model Model to initialize
+ * @param bus Controller index (0 or 1)
+ * @param address 7-bit address
+ * @param capacity Memory size in bytes (e.g. 4096 for AT24C32)
+ * @param page_size Page size in bytes (e.g. 32 for AT24C32)
+ * @return true if successful, false if the size is not supported
+ */
+bool at24cxx_model_init(at24cxx_model_t *model, uint8_t bus, uint8_t address,
+                        uint32_t capacity, uint16_t page_size);
+
+/**
+ * Check whether a write cycle is running
+ *
+ * @param model Model
+ * @return true if the device would NAK now
+ */
+bool at24cxx_model_is_busy(const at24cxx_model_t *model);
+
+#endif // AT24CXX_MODEL_H
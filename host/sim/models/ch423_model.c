@@ -0,0 +1,74 @@
+#include "ch423_model.h"
+#include "pico/error.h"
+#include <string.h>
+
+static int ch423_write(i2c_sim_device_t *dev, const uint8_t *data, size_t len, bool nostop) {
+    ch423_model_t *m = (ch423_model_t *)dev;
+    (void)nostop;
+
+    if (len == 0) {
+        return 0;  // Address probe
+    }
+
+    switch (data[0]) {
+        case CH423_MODEL_CMD_WRITE_OC:
+            if (len >= 2) {
+                m->oc = data[1];
+                m->output_writes++;
+            }
+            break;
+        case CH423_MODEL_CMD_WRITE_PP:
+            if (len >= 2) {
+                m->pp = data[1];
+                m->output_writes++;
+            }
+            break;
+        case CH423_MODEL_CMD_SET_IO:
+            if (len >= 3) {
+                m->io_direction = (uint16_t)data[1] | ((uint16_t)data[2] << 8);
+            }
+            break;
+        case CH423_MODEL_CMD_READ_IO:
+            m->read_pending = true;
+            break;
+        default:
+            return PICO_ERROR_GENERIC;
+    }
+    return (int)len;
+}
+
+static int ch423_read(i2c_sim_device_t *dev, uint8_t *data, size_t len, bool nostop) {
+    ch423_model_t *m = (ch423_model_t *)dev;
+    (void)nostop;
+
+    // Input pins read the outside world, output pins read back their latch
+    uint16_t outputs = ch423_model_get_outputs(m);
+    uint16_t levels = (m->inputs & m->io_direction) | (outputs & ~m->io_direction);
+    if (!m->read_pending) {
+        levels = 0xFFFF;  // No register selected: bus idles high
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (i & 1) ? (uint8_t)(levels >> 8) : (uint8_t)levels;
+    }
+    m->read_pending = false;
+    return (int)len;
+}
+
+static const i2c_sim_device_ops_t ch423_ops = {
+    .write = ch423_write,
+    .read = ch423_read,
+};
+
+void ch423_model_init(ch423_model_t *model, uint8_t bus, uint8_t address) {
+    memset(model, 0, sizeof(*model));
+    model->base.ops = &ch423_ops;
+    model->base.name = "CH423";
+    model->base.bus = bus;
+    model->base.address = address;
+    model->inputs = 0xFFFF;
+}
+
+uint16_t ch423_model_get_outputs(const ch423_model_t *model) {
+    return ((uint16_t)model->pp << 8) | model->oc;
+}
@@ -0,0 +1,48 @@
+#ifndef CH423_MODEL_H
+#define CH423_MODEL_H
+
+#include "../i2c_sim.h"
+
+// Command bytes (see lib/i2c_midi/drivers/ch423_driver.h)
+#define CH423_MODEL_CMD_WRITE_OC  0x01
+#define CH423_MODEL_CMD_WRITE_PP  0x02
+#define CH423_MODEL_CMD_READ_IO   0x03
+#define CH423_MODEL_CMD_SET_IO    0x04
+
+/**
+ * CH423 model
+ *
+ * Command protocol as used by the driver: the first byte of a write is the
+ * command, followed by its data. WRITE_OC / WRITE_PP set the low and high
+ * output bytes, SET_IO takes a 16-bit direction mask (1 = input, low byte
+ * first) and READ_IO selects the input register for the following read,
+ * which returns two bytes (low first). Unknown commands are NAKed.
+ */
+typedef struct {
+    i2c_sim_device_t base;
+    uint8_t oc;              // Open-collector outputs OC0-OC7 (low byte)
+    uint8_t pp;              // Push-pull outputs PP0-PP7 (high byte)
+    uint16_t io_direction;   // 1 = input
+    uint16_t inputs;         // External pin levels for input pins
+    bool read_pending;       // READ_IO selected
+    uint32_t output_writes;  // WRITE_OC / WRITE_PP commands
+} ch423_model_t;
+
+/**
+ * Initialize the model
+ *
+ * @param model Model to initialize
+ * @param bus Controller index (0 or 1)
+ * @param address 7-bit address
+ */
+void ch423_model_init(ch423_model_t *model, uint8_t bus, uint8_t address);
+
+/**
+ * Get the 16-bit output state (PP high byte, OC low byte)
+ *
+ * @param model Model
+ * @return Output state
+ */
+uint16_t ch423_model_get_outputs(const ch423_model_t *model);
+
+#endif // CH423_MODEL_H
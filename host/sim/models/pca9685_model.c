@@ -0,0 +1,139 @@
+#include "pca9685_model.h"
+#include <string.h>
+
+static void pca9685_power_on(pca9685_model_t *m) {
+    memset(m->regs, 0, sizeof(m->regs));
+    m->regs[PCA9685_MODEL_MODE1] = PCA9685_MODEL_MODE1_SLEEP | 0x01;  // SLEEP, ALLCALL
+    m->regs[PCA9685_MODEL_MODE2] = 0x04;                              // OUTDRV
+    m->regs[0x02] = 0xE2;  // SUBADR1
+    m->regs[0x03] = 0xE4;  // SUBADR2
+    m->regs[0x04] = 0xE8;  // SUBADR3
+    m->regs[0x05] = 0xE0;  // ALLCALLADR
+    for (uint8_t ch = 0; ch < 16; ch++) {
+        m->regs[PCA9685_MODEL_LED0_ON_L + ch * 4 + 3] = 0x10;  // LEDn full off
+    }
+    m->regs[PCA9685_MODEL_PRESCALE] = 0x1E;  // 200 Hz
+    m->pointer = 0;
+}
+
+static void pca9685_write_register(pca9685_model_t *m, uint8_t reg, uint8_t value) {
+    if (reg == PCA9685_MODEL_MODE1) {
+        // RESTART is cleared by writing a 1, writing 0 has no effect
+        uint8_t restart = m->regs[reg] & PCA9685_MODEL_MODE1_RESTART;
+        if (value & PCA9685_MODEL_MODE1_RESTART) {
+            restart = 0;
+        }
+        m->regs[reg] = (value & ~PCA9685_MODEL_MODE1_RESTART) | restart;
+    } else if (reg <= PCA9685_MODEL_LED15_OFF_H) {
+        m->regs[reg] = value;
+        if (reg >= PCA9685_MODEL_LED0_ON_L && ((reg - PCA9685_MODEL_LED0_ON_L) & 3) == 3) {
+            m->channel_updates++;
+        }
+    } else if (reg >= PCA9685_MODEL_ALL_LED_ON_L && reg <= PCA9685_MODEL_ALL_LED_OFF_H) {
+        uint8_t offset = reg - PCA9685_MODEL_ALL_LED_ON_L;
+        for (uint8_t ch = 0; ch < 16; ch++) {
+            m->regs[PCA9685_MODEL_LED0_ON_L + ch * 4 + offset] = value;
+        }
+        if (offset == 3) {
+            m->channel_updates += 16;
+        }
+    } else if (reg == PCA9685_MODEL_PRESCALE &&
+               (m->regs[PCA9685_MODEL_MODE1] & PCA9685_MODEL_MODE1_SLEEP)) {
+        m->regs[reg] = value < 3 ? 3 : value;  // Hardware minimum
+    } else {
+        m->ignored_writes++;  // Reserved, TestMode, or PRESCALE while awake
+    }
+}
+
+static uint8_t pca9685_read_register(const pca9685_model_t *m, uint8_t reg) {
+    if (reg >= PCA9685_MODEL_ALL_LED_ON_L && reg <= PCA9685_MODEL_ALL_LED_OFF_H) {
+        return 0;
+    }
+    return m->regs[reg];
+}
+
+static bool auto_increment(const pca9685_model_t *m) {
+    return (m->regs[PCA9685_MODEL_MODE1] & PCA9685_MODEL_MODE1_AI) != 0;
+}
+
+static int pca9685_write(i2c_sim_device_t *dev, const uint8_t *data, size_t len, bool nostop) {
+    pca9685_model_t *m = (pca9685_model_t *)dev;
+    (void)nostop;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    m->pointer = data[0];
+    for (size_t i = 1; i < len; i++) {
+        pca9685_write_register(m, m->pointer, data[i]);
+        if (auto_increment(m)) {
+            m->pointer++;  // 8-bit register pointer rolls over 0xFF -> 0x00
+        }
+    }
+    return (int)len;
+}
+
+static int pca9685_read(i2c_sim_device_t *dev, uint8_t *data, size_t len, bool nostop) {
+    pca9685_model_t *m = (pca9685_model_t *)dev;
+    (void)nostop;
+
+    for (size_t i = 0; i < len; i++) {
+        data[i] = pca9685_read_register(m, m->pointer);
+        if (auto_increment(m)) {
+            m->pointer++;
+        }
+    }
+    return (int)len;
+}
+
+static void pca9685_general_call(i2c_sim_device_t *dev, const uint8_t *data, size_t len) {
+    if (len >= 1 && data[0] == PCA9685_MODEL_SWRST) {
+        pca9685_power_on((pca9685_model_t *)dev);
+    }
+}
+
+static const i2c_sim_device_ops_t pca9685_ops = {
+    .write = pca9685_write,
+    .read = pca9685_read,
+    .general_call = pca9685_general_call,
+};
+
+void pca9685_model_init(pca9685_model_t *model, uint8_t bus, uint8_t address) {
+    memset(model, 0, sizeof(*model));
+    model->base.ops = &pca9685_ops;
+    model->base.name = "PCA9685";
+    model->base.bus = bus;
+    model->base.address = address;
+    pca9685_power_on(model);
+}
+
+void pca9685_model_get_channel(const pca9685_model_t *model, uint8_t channel, uint16_t *on, uint16_t *off) {
+    const uint8_t *r = &model->regs[PCA9685_MODEL_LED0_ON_L + (channel & 15) * 4];
+    *on = (uint16_t)r[0] | ((uint16_t)(r[1] & 0x1F) << 8);
+    *off = (uint16_t)r[2] | ((uint16_t)(r[3] & 0x1F) << 8);
+}
+
+float pca9685_model_get_frequency(const pca9685_model_t *model) {
+    return (float)PCA9685_MODEL_OSC_HZ / (4096.0f * (model->regs[PCA9685_MODEL_PRESCALE] + 1));
+}
+
+float pca9685_model_get_pulse_us(const pca9685_model_t *model, uint8_t channel) {
+    if (model->regs[PCA9685_MODEL_MODE1] & PCA9685_MODEL_MODE1_SLEEP) {
+        return 0.0f;
+    }
+
+    uint16_t on, off;
+    pca9685_model_get_channel(model, channel, &on, &off);
+
+    float period_us = 1000000.0f / pca9685_model_get_frequency(model);
+    if (off & 0x1000) {
+        return 0.0f;  // Full off wins over full on
+    }
+    if (on & 0x1000) {
+        return period_us;
+    }
+
+    uint16_t ticks = (off - on) & 0x0FFF;
+    return period_us * ticks / 4096.0f;
+}
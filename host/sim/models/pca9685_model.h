@@ -0,0 +1,79 @@
+#ifndef PCA9685_MODEL_H
+#define PCA9685_MODEL_H
+
+#include "../i2c_sim.h"
+
+// Register map (see lib/i2c_pca9685_midi/drivers/pca9685_driver.h)
+#define PCA9685_MODEL_MODE1        0x00
+#define PCA9685_MODEL_MODE2        0x01
+#define PCA9685_MODEL_LED0_ON_L    0x06
+#define PCA9685_MODEL_LED15_OFF_H  0x45
+#define PCA9685_MODEL_ALL_LED_ON_L 0xFA
+#define PCA9685_MODEL_ALL_LED_OFF_H 0xFD
+#define PCA9685_MODEL_PRESCALE     0xFE
+
+#define PCA9685_MODEL_MODE1_RESTART 0x80
+#define PCA9685_MODEL_MODE1_AI      0x20
+#define PCA9685_MODEL_MODE1_SLEEP   0x10
+
+// Software reset data byte on the general call address
+#define PCA9685_MODEL_SWRST 0x06
+
+#define PCA9685_MODEL_OSC_HZ 25000000
+
+/**
+ * PCA9685 model
+ *
+ * 256-byte register file behind a control (pointer) register. The first
+ * byte of a write sets the pointer; with MODE1.AI set it increments after
+ * every data byte, otherwise all data goes to the same register. Writes to
+ * ALL_LED_ON_L..ALL_LED_OFF_H are copied to the matching register of every
+ * channel and read back as 0. PRESCALE only takes writes while SLEEP is
+ * set. RESTART is cleared by writing 1. Reserved registers (0x46-0xF9)
+ * ignore writes. A general call with SWRST returns to power-on state.
+ */
+typedef struct {
+    i2c_sim_device_t base;
+    uint8_t regs[256];
+    uint8_t pointer;             // Control register
+    uint32_t channel_updates;    // Writes that completed an LEDn_OFF_H
+    uint32_t ignored_writes;     // Writes to reserved or protected registers
+} pca9685_model_t;
+
+/**
+ * Initialize the model (power-on register values)
+ *
+ * @param model Model to initialize
+ * @param bus Controller index (0 or 1)
+ * @param address 7-bit address
+ */
+void pca9685_model_init(pca9685_model_t *model, uint8_t bus, uint8_t address);
+
+/**
+ * Get the ON and OFF counts of a channel
+ *
+ * @param model Model
+ * @param channel Channel (0-15)
+ * @param on Pointer to store the 13-bit ON value (bit 12 = full on)
+ * @param off Pointer to store the 13-bit OFF value (bit 12 = full off)
+ */
+void pca9685_model_get_channel(const pca9685_model_t *model, uint8_t channel, uint16_t *on, uint16_t *off);
+
+/**
+ * Get the output frequency from PRESCALE
+ *
+ * @param model Model
+ * @return PWM frequency in Hz
+ */
+float pca9685_model_get_frequency(const pca9685_model_t *model);
+
+/**
+ * Get the high time of a channel
+ *
+ * @param model Model
+ * @param channel Channel (0-15)
+ * @return Pulse width in microseconds (0 if off or sleeping)
+ */
+float pca9685_model_get_pulse_us(const pca9685_model_t *model, uint8_t channel);
+
+#endif // PCA9685_MODEL_H
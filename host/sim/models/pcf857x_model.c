@@ -0,0 +1,60 @@
+#include "pcf857x_model.h"
+#include <string.h>
+
+static int pcf857x_write(i2c_sim_device_t *dev, const uint8_t *data, size_t len, bool nostop) {
+    pcf857x_model_t *m = (pcf857x_model_t *)dev;
+    (void)nostop;
+
+    // Byte phase restarts with every START
+    m->low_byte_next = true;
+    for (size_t i = 0; i < len; i++) {
+        if (!m->is_16bit) {
+            m->latch = data[i];
+            m->latch_updates++;
+        } else if (m->low_byte_next) {
+            m->latch = (m->latch & 0xFF00) | data[i];
+            m->low_byte_next = false;
+        } else {
+            m->latch = (m->latch & 0x00FF) | ((uint16_t)data[i] << 8);
+            m->low_byte_next = true;
+            m->latch_updates++;
+        }
+    }
+    return (int)len;
+}
+
+static int pcf857x_read(i2c_sim_device_t *dev, uint8_t *data, size_t len, bool nostop) {
+    pcf857x_model_t *m = (pcf857x_model_t *)dev;
+    (void)nostop;
+
+    uint16_t port = m->latch & m->inputs;
+    for (size_t i = 0; i < len; i++) {
+        if (m->is_16bit && (i & 1)) {
+            data[i] = (uint8_t)(port >> 8);
+        } else {
+            data[i] = (uint8_t)port;
+        }
+    }
+    return (int)len;
+}
+
+static const i2c_sim_device_ops_t pcf857x_ops = {
+    .write = pcf857x_write,
+    .read = pcf857x_read,
+};
+
+void pcf857x_model_init(pcf857x_model_t *model, uint8_t bus, uint8_t address, bool is_16bit) {
+    memset(model, 0, sizeof(*model));
+    model->base.ops = &pcf857x_ops;
+    model->base.name = is_16bit ? "PCF8575" : "PCF8574";
+    model->base.bus = bus;
+    model->base.address = address;
+    model->is_16bit = is_16bit;
+    model->latch = is_16bit ? 0xFFFF : 0x00FF;
+    model->inputs = 0xFFFF;
+    model->low_byte_next = true;
+}
+
+bool pcf857x_model_get_pin(const pcf857x_model_t *model, uint8_t pin) {
+    return ((model->latch & model->inputs) >> pin) & 1;
+}
@@ -0,0 +1,42 @@
+#ifndef PCF857X_MODEL_H
+#define PCF857X_MODEL_H
+
+#include "../i2c_sim.h"
+
+/**
+ * PCF8574 / PCF8575 model
+ *
+ * Quasi-bidirectional port without registers: every written byte (PCF8574)
+ * or byte pair (PCF8575, P0-P7 then P10-P17) sets the port latch. Reads
+ * return the latch ANDed with the external input levels, since a pin
+ * written high is only weakly pulled up and reads whatever drives it.
+ */
+typedef struct {
+    i2c_sim_device_t base;
+    bool is_16bit;           // PCF8575
+    uint16_t latch;          // Port latch (power-on: all high)
+    uint16_t inputs;         // External pin levels (default: all high)
+    bool low_byte_next;      // PCF8575 byte phase within a transfer
+    uint32_t latch_updates;  // Latch writes (byte or byte pair)
+} pcf857x_model_t;
+
+/**
+ * Initialize the model
+ *
+ * @param model Model to initialize
+ * @param bus Controller index (0 or 1)
+ * @param address 7-bit address
+ * @param is_16bit true for PCF8575, false for PCF8574
+ */
+void pcf857x_model_init(pcf857x_model_t *model, uint8_t bus, uint8_t address, bool is_16bit);
+
+/**
+ * Get the level of an output pin
+ *
+ * @param model Model
+ * @param pin Pin number (0-7 or 0-15)
+ * @return Pin level (latch AND inputs)
+ */
+bool pcf857x_model_get_pin(const pcf857x_model_t *model, uint8_t pin);
+
+#endif // PCF857X_MODEL_H
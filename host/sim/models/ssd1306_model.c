@@ -0,0 +1,220 @@
+#include "ssd1306_model.h"
+#include <string.h>
+
+// Control byte bits
+#define SSD1306_CTRL_CO 0x80  // Continuation: one byte follows, then another control byte
+#define SSD1306_CTRL_DC 0x40  // 1 = data, 0 = command
+
+//--------------------------------------------------------------------+
+// Command Decoder
+//--------------------------------------------------------------------+
+
+/**
+ * Number of argument bytes following a command byte
+ */
+static uint8_t command_arg_count(uint8_t cmd) {
+    switch (cmd) {
+        case 0x20:  // Memory addressing mode
+        case 0x81:  // Contrast
+        case 0x8D:  // Charge pump
+        case 0xA8:  // Multiplex ratio
+        case 0xD3:  // Display offset
+        case 0xD5:  // Clock divide
+        case 0xD9:  // Pre-charge
+        case 0xDA:  // COM pins
+        case 0xDB:  // VCOMH
+            return 1;
+        case 0x21:  // Column address
+        case 0x22:  // Page address
+        case 0xA3:  // Vertical scroll area
+            return 2;
+        case 0x29:  // Vertical and horizontal scroll setup
+        case 0x2A:
+            return 5;
+        case 0x26:  // Horizontal scroll setup
+        case 0x27:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+static void execute_command(ssd1306_model_t *m) {
+    uint8_t cmd = m->cmd;
+    const uint8_t *a = m->cmd_args;
+    m->commands++;
+
+    if (cmd <= 0x0F && m->addressing_mode == SSD1306_MODEL_ADDR_PAGE) {
+        m->column = (m->column & 0xF0) | cmd;  // Lower column nibble
+    } else if (cmd >= 0x10 && cmd <= 0x1F && m->addressing_mode == SSD1306_MODEL_ADDR_PAGE) {
+        m->column = (uint8_t)(((cmd & 0x07) << 4) | (m->column & 0x0F));  // Upper column nibble
+    } else if (cmd >= 0x40 && cmd <= 0x7F) {
+        m->start_line = cmd & 0x3F;
+    } else if (cmd >= 0xB0 && cmd <= 0xB7 && m->addressing_mode == SSD1306_MODEL_ADDR_PAGE) {
+        m->page = cmd & 0x07;
+    } else {
+        switch (cmd) {
+            case 0x20:
+                m->addressing_mode = a[0] & 0x03;
+                if (m->addressing_mode > SSD1306_MODEL_ADDR_PAGE) {
+                    m->addressing_mode = SSD1306_MODEL_ADDR_PAGE;  // 0b11 is invalid
+                }
+                break;
+            case 0x21:
+                m->column_start = a[0] & 0x7F;
+                m->column_end = a[1] & 0x7F;
+                m->column = m->column_start;
+                break;
+            case 0x22:
+                m->page_start = a[0] & 0x07;
+                m->page_end = a[1] & 0x07;
+                m->page = m->page_start;
+                break;
+            case 0x81: m->contrast = a[0]; break;
+            case 0x8D: m->charge_pump = (a[0] & 0x04) != 0; break;
+            case 0xA0: m->segment_remap = false; break;
+            case 0xA1: m->segment_remap = true; break;
+            case 0xA4: m->entire_on = false; break;
+            case 0xA5: m->entire_on = true; break;
+            case 0xA6: m->inverted = false; break;
+            case 0xA7: m->inverted = true; break;
+            case 0xAE: m->display_on = false; break;
+            case 0xAF: m->display_on = true; break;
+            case 0xC0: m->com_scan_reverse = false; break;
+            case 0xC8: m->com_scan_reverse = true; break;
+            case 0x2E: m->scroll_active = false; break;
+            case 0x2F: m->scroll_active = true; break;
+            default: break;  // Timing and hardware configuration: no visible state
+        }
+    }
+}
+
+static void command_byte(ssd1306_model_t *m, uint8_t byte) {
+    if (m->cmd_args_needed > m->cmd_arg_count) {
+        m->cmd_args[m->cmd_arg_count++] = byte;
+    } else {
+        m->cmd = byte;
+        m->cmd_arg_count = 0;
+        m->cmd_args_needed = command_arg_count(byte);
+    }
+
+    if (m->cmd_arg_count == m->cmd_args_needed) {
+        execute_command(m);
+        m->cmd_args_needed = 0;
+        m->cmd_arg_count = 0;
+    }
+}
+
+//--------------------------------------------------------------------+
+// GDDRAM
+//--------------------------------------------------------------------+
+
+static void data_byte(ssd1306_model_t *m, uint8_t byte) {
+    m->gddram[m->page & 7][m->column & 0x7F] = byte;
+    m->data_bytes++;
+
+    switch (m->addressing_mode) {
+        case SSD1306_MODEL_ADDR_HORIZONTAL:
+            if (m->column >= m->column_end) {
+                m->column = m->column_start;
+                m->page = m->page >= m->page_end ? m->page_start : m->page + 1;
+            } else {
+                m->column++;
+            }
+            break;
+        case SSD1306_MODEL_ADDR_VERTICAL:
+            if (m->page >= m->page_end) {
+                m->page = m->page_start;
+                m->column = m->column >= m->column_end ? m->column_start : m->column + 1;
+            } else {
+                m->page++;
+            }
+            break;
+        default:
+            m->column = (m->column + 1) & 0x7F;
+            break;
+    }
+}
+
+//--------------------------------------------------------------------+
+// Bus Interface
+//--------------------------------------------------------------------+
+
+static int ssd1306_write(i2c_sim_device_t *dev, const uint8_t *data, size_t len, bool nostop) {
+    ssd1306_model_t *m = (ssd1306_model_t *)dev;
+    (void)nostop;
+
+    size_t i = 0;
+    while (i < len) {
+        uint8_t control = data[i++];
+        bool is_data = (control & SSD1306_CTRL_DC) != 0;
+
+        if (control & SSD1306_CTRL_CO) {
+            // One byte, then another control byte
+            if (i < len) {
+                if (is_data) {
+                    data_byte(m, data[i]);
+                } else {
+                    command_byte(m, data[i]);
+                }
+                i++;
+            }
+            continue;
+        }
+
+        // Stream until STOP
+        for (; i < len; i++) {
+            if (is_data) {
+                data_byte(m, data[i]);
+            } else {
+                command_byte(m, data[i]);
+            }
+        }
+    }
+    return (int)len;
+}
+
+static int ssd1306_read(i2c_sim_device_t *dev, uint8_t *data, size_t len, bool nostop) {
+    ssd1306_model_t *m = (ssd1306_model_t *)dev;
+    (void)nostop;
+
+    // Status byte: bit 6 = display off
+    for (size_t i = 0; i < len; i++) {
+        data[i] = m->display_on ? 0x00 : 0x40;
+    }
+    return (int)len;
+}
+
+static const i2c_sim_device_ops_t ssd1306_ops = {
+    .write = ssd1306_write,
+    .read = ssd1306_read,
+};
+
+void ssd1306_model_init(ssd1306_model_t *model, uint8_t bus, uint8_t address) {
+    memset(model, 0, sizeof(*model));
+    model->base.ops = &ssd1306_ops;
+    model->base.name = "SSD1306";
+    model->base.bus = bus;
+    model->base.address = address;
+    model->addressing_mode = SSD1306_MODEL_ADDR_PAGE;
+    model->column_end = SSD1306_MODEL_WIDTH - 1;
+    model->page_end = SSD1306_MODEL_PAGES - 1;
+    model->contrast = 0x7F;
+}
+
+bool ssd1306_model_get_pixel(const ssd1306_model_t *model, uint8_t x, uint8_t y) {
+    if (x >= SSD1306_MODEL_WIDTH || y >= SSD1306_MODEL_HEIGHT) {
+        return false;
+    }
+    return (model->gddram[y >> 3][x] >> (y & 7)) & 1;
+}
+
+bool ssd1306_model_is_lit(const ssd1306_model_t *model, uint8_t x, uint8_t y) {
+    if (!model->display_on) {
+        return false;
+    }
+    if (model->entire_on) {
+        return true;
+    }
+    return ssd1306_model_get_pixel(model, x, y) != model->inverted;
+}
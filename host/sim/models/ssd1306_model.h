@@ -0,0 +1,90 @@
+#ifndef SSD1306_MODEL_H
+#define SSD1306_MODEL_H
+
+#include "../i2c_sim.h"
+
+#define SSD1306_MODEL_WIDTH  128
+#define SSD1306_MODEL_PAGES  8
+#define SSD1306_MODEL_HEIGHT (SSD1306_MODEL_PAGES * 8)
+
+// Memory addressing modes (command 0x20)
+#define SSD1306_MODEL_ADDR_HORIZONTAL 0
+#define SSD1306_MODEL_ADDR_VERTICAL   1
+#define SSD1306_MODEL_ADDR_PAGE       2
+
+/**
+ * SSD1306 model (128x64, I2C)
+ *
+ * Every transfer starts with control bytes: Co=0 makes the rest of the
+ * transfer a command (D/C#=0) or data (D/C#=1) stream; Co=1 means one byte
+ * follows before the next control byte. Commands are decoded with their
+ * argument bytes, which may arrive in later transfers. GDDRAM writes
+ * follow the addressing mode: horizontal and vertical wrap inside the
+ * COLUMNADDR / PAGEADDR window, page mode wraps the column inside the
+ * current page.
+ */
+typedef struct {
+    i2c_sim_device_t base;
+    uint8_t gddram[SSD1306_MODEL_PAGES][SSD1306_MODEL_WIDTH];
+
+    // Address pointer and window
+    uint8_t addressing_mode;
+    uint8_t column, page;
+    uint8_t column_start, column_end;
+    uint8_t page_start, page_end;
+
+    // Display state
+    bool display_on;
+    bool inverted;
+    bool entire_on;           // 0xA5: all pixels on regardless of GDDRAM
+    uint8_t contrast;
+    uint8_t start_line;
+    bool segment_remap;
+    bool com_scan_reverse;
+    bool charge_pump;
+    bool scroll_active;
+
+    // Command decoder
+    uint8_t cmd;              // Command waiting for arguments
+    uint8_t cmd_args[6];
+    uint8_t cmd_arg_count;
+    uint8_t cmd_args_needed;
+
+    // Counters
+    uint32_t commands;        // Commands decoded
+    uint32_t data_bytes;      // GDDRAM bytes written
+} ssd1306_model_t;
+
+/**
+ * Initialize the model (reset state: display off, page addressing, GDDRAM cleared)
+ *
+ * @param model Model to initialize
+ * @param bus Controller index (0 or 1)
+ * @param address 7-bit address (0x3C or 0x3D)
+ */
+void ssd1306_model_init(ssd1306_model_t *model, uint8_t bus, uint8_t address);
+
+/**
+ * Get a GDDRAM pixel (RAM layout, before remap/scan direction)
+ *
+ * @param model Model
+ * @param x Column (0-127)
+ * @param y Row (0-63)
+ * @return Pixel value
+ */
+bool ssd1306_model_get_pixel(const ssd1306_model_t *model, uint8_t x, uint8_t y);
+
+/**
+ * Get a pixel as seen on the panel
+ *
+ * Applies display on/off, entire-display-on and inverse display; with the
+ * panel off everything is dark.
+ *
+ * @param model Model
+ * @param x Column (0-127)
+ * @param y Row (0-63)
+ * @return true if the pixel is lit
+ */
+bool ssd1306_model_is_lit(const ssd1306_model_t *model, uint8_t x, uint8_t y);
+
+#endif // SSD1306_MODEL_H
@@ -0,0 +1,368 @@
+#include "smf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+//--------------------------------------------------------------------+
+// Internal Types
+//--------------------------------------------------------------------+
+
+#define SMF_DEFAULT_TEMPO_US 500000  // 120 BPM
+#define SMF_META_TEMPO 0x51
+
+typedef struct {
+    uint64_t tick;
+    uint16_t track;
+    uint32_t seq;            // Order within the track
+    bool is_tempo;
+    uint32_t tempo_us;       // Microseconds per quarter note (tempo events)
+    smf_event_t event;
+    uint32_t sysex_offset;   // Offset into the SysEx pool
+} raw_event_t;
+
+typedef struct {
+    raw_event_t *items;
+    size_t count;
+    size_t capacity;
+    uint8_t *pool;
+    size_t pool_size;
+    size_t pool_capacity;
+} raw_list_t;
+
+//--------------------------------------------------------------------+
+// Helpers
+//--------------------------------------------------------------------+
+
+static bool fail(char *error, size_t error_size, const char *fmt, ...) {
+    if (error && error_size) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(error, error_size, fmt, args);
+        va_end(args);
+    }
+    return false;
+}
+
+static uint32_t read_be(const uint8_t *p, uint8_t bytes) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < bytes; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static bool read_vlq(const uint8_t **p, const uint8_t *end, uint32_t *value) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (*p >= end) {
+            return false;
+        }
+        uint8_t b = *(*p)++;
+        v = (v << 7) | (b & 0x7F);
+        if (!(b & 0x80)) {
+            *value = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+static raw_event_t* list_add(raw_list_t *list) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 1024;
+        raw_event_t *items = realloc(list->items, capacity * sizeof(raw_event_t));
+        if (!items) {
+            return NULL;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    raw_event_t *e = &list->items[list->count++];
+    memset(e, 0, sizeof(*e));
+    return e;
+}
+
+static bool pool_add(raw_list_t *list, const uint8_t *data, size_t len, uint32_t *offset) {
+    if (list->pool_size + len > list->pool_capacity) {
+        size_t capacity = list->pool_capacity ? list->pool_capacity : 256;
+        while (capacity < list->pool_size + len) {
+            capacity *= 2;
+        }
+        uint8_t *pool = realloc(list->pool, capacity);
+        if (!pool) {
+            return false;
+        }
+        list->pool = pool;
+        list->pool_capacity = capacity;
+    }
+    memcpy(list->pool + list->pool_size, data, len);
+    *offset = (uint32_t)list->pool_size;
+    list->pool_size += len;
+    return true;
+}
+
+static int compare_raw(const void *a, const void *b) {
+    const raw_event_t *x = a;
+    const raw_event_t *y = b;
+    if (x->tick != y->tick) {
+        return x->tick < y->tick ? -1 : 1;
+    }
+    // Tempo changes apply before notes on the same tick
+    if (x->is_tempo != y->is_tempo) {
+        return x->is_tempo ? -1 : 1;
+    }
+    if (x->track != y->track) {
+        return x->track < y->track ? -1 : 1;
+    }
+    return x->seq < y->seq ? -1 : (x->seq > y->seq);
+}
+
+//--------------------------------------------------------------------+
+// Track Parser
+//--------------------------------------------------------------------+
+
+static bool parse_track(const uint8_t *p, const uint8_t *end, uint16_t track, raw_list_t *list,
+                        char *error, size_t error_size) {
+    uint64_t tick = 0;
+    uint8_t running_status = 0;
+    uint32_t seq = 0;
+
+    while (p < end) {
+        uint32_t delta;
+        if (!read_vlq(&p, end, &delta)) {
+            return fail(error, error_size, "track %u: bad delta time", track);
+        }
+        tick += delta;
+        if (p >= end) {
+            return fail(error, error_size, "track %u: truncated event", track);
+        }
+
+        uint8_t status = *p;
+        if (status & 0x80) {
+            p++;
+        } else if (running_status) {
+            status = running_status;
+        } else {
+            return fail(error, error_size, "track %u: data byte without status", track);
+        }
+
+        if (status == 0xFF) {
+            // Meta event
+            if (p >= end) {
+                return fail(error, error_size, "track %u: truncated meta event", track);
+            }
+            uint8_t type = *p++;
+            uint32_t len;
+            if (!read_vlq(&p, end, &len) || (uint32_t)(end - p) < len) {
+                return fail(error, error_size, "track %u: bad meta length", track);
+            }
+            if (type == SMF_META_TEMPO && len == 3) {
+                raw_event_t *e = list_add(list);
+                if (!e) {
+                    return fail(error, error_size, "out of memory");
+                }
+                e->tick = tick;
+                e->track = track;
+                e->seq = seq++;
+                e->is_tempo = true;
+                e->tempo_us = read_be(p, 3);
+            }
+            p += len;
+            if (type == 0x2F) {
+                break;  // End of track
+            }
+            continue;
+        }
+
+        if (status == 0xF0 || status == 0xF7) {
+            // SysEx (F0) or escaped data (F7); running status is cancelled
+            running_status = 0;
+            uint32_t len;
+            if (!read_vlq(&p, end, &len) || (uint32_t)(end - p) < len) {
+                return fail(error, error_size, "track %u: bad SysEx length", track);
+            }
+            if (status == 0xF0) {
+                raw_event_t *e = list_add(list);
+                if (!e) {
+                    return fail(error, error_size, "out of memory");
+                }
+                // Stored with its F0 so the message is complete
+                uint8_t start = 0xF0;
+                uint32_t offset, data_offset;
+                if (!pool_add(list, &start, 1, &offset) || !pool_add(list, p, len, &data_offset)) {
+                    return fail(error, error_size, "out of memory");
+                }
+                e->tick = tick;
+                e->track = track;
+                e->seq = seq++;
+                e->event.status = 0xF0;
+                e->event.sysex_length = len + 1;
+                e->sysex_offset = offset;
+            }
+            p += len;
+            continue;
+        }
+
+        if (status >= 0xF0) {
+            return fail(error, error_size, "track %u: unexpected status 0x%02X", track, status);
+        }
+
+        // Channel message
+        running_status = status;
+        uint8_t type = status & 0xF0;
+        uint8_t data_len = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+        if ((size_t)(end - p) < data_len) {
+            return fail(error, error_size, "track %u: truncated channel message", track);
+        }
+
+        raw_event_t *e = list_add(list);
+        if (!e) {
+            return fail(error, error_size, "out of memory");
+        }
+        e->tick = tick;
+        e->track = track;
+        e->seq = seq++;
+        e->event.status = status;
+        e->event.data1 = p[0];
+        e->event.data2 = data_len == 2 ? p[1] : 0;
+        e->event.length = 1 + data_len;
+        p += data_len;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------+
+// Public API
+//--------------------------------------------------------------------+
+
+bool smf_parse(const uint8_t *data, size_t size, smf_file_t *smf, char *error, size_t error_size) {
+    memset(smf, 0, sizeof(*smf));
+
+    if (size < 14 || memcmp(data, "MThd", 4) != 0) {
+        return fail(error, error_size, "not a Standard MIDI File");
+    }
+    uint32_t header_len = read_be(data + 4, 4);
+    if (header_len < 6 || 8 + header_len > size) {
+        return fail(error, error_size, "bad header length");
+    }
+
+    smf->format = (uint16_t)read_be(data + 8, 2);
+    smf->track_count = (uint16_t)read_be(data + 10, 2);
+    uint16_t division = (uint16_t)read_be(data + 12, 2);
+    if (smf->format > 1) {
+        return fail(error, error_size, "format %u not supported", smf->format);
+    }
+    if (division == 0) {
+        return fail(error, error_size, "bad time division");
+    }
+
+    raw_list_t list = {0};
+    const uint8_t *p = data + 8 + header_len;
+    const uint8_t *end = data + size;
+
+    for (uint16_t track = 0; track < smf->track_count; track++) {
+        if (end - p < 8 || memcmp(p, "MTrk", 4) != 0) {
+            free(list.items);
+            free(list.pool);
+            return fail(error, error_size, "track %u: missing MTrk chunk", track);
+        }
+        uint32_t len = read_be(p + 4, 4);
+        p += 8;
+        if ((size_t)(end - p) < len) {
+            free(list.items);
+            free(list.pool);
+            return fail(error, error_size, "track %u: truncated", track);
+        }
+        if (!parse_track(p, p + len, track, &list, error, error_size)) {
+            free(list.items);
+            free(list.pool);
+            return false;
+        }
+        p += len;
+    }
+
+    qsort(list.items, list.count, sizeof(raw_event_t), compare_raw);
+
+    // Convert ticks to microseconds along the tempo map
+    smf->events = calloc(list.count ? list.count : 1, sizeof(smf_event_t));
+    if (!smf->events) {
+        free(list.items);
+        free(list.pool);
+        return fail(error, error_size, "out of memory");
+    }
+
+    bool smpte = (division & 0x8000) != 0;
+    uint64_t ticks_per_second = 0;
+    if (smpte) {
+        int8_t fps = (int8_t)(division >> 8);
+        ticks_per_second = (uint64_t)(-fps) * (division & 0xFF);
+    }
+
+    uint32_t tempo = SMF_DEFAULT_TEMPO_US;
+    uint64_t tempo_tick = 0;
+    uint64_t tempo_time_us = 0;
+
+    for (size_t i = 0; i < list.count; i++) {
+        raw_event_t *r = &list.items[i];
+        uint64_t time_us;
+        if (smpte) {
+            time_us = r->tick * 1000000ull / ticks_per_second;
+        } else {
+            time_us = tempo_time_us + (r->tick - tempo_tick) * tempo / division;
+        }
+
+        if (r->is_tempo) {
+            tempo_time_us = time_us;
+            tempo_tick = r->tick;
+            tempo = r->tempo_us;
+            continue;
+        }
+
+        smf_event_t *e = &smf->events[smf->event_count++];
+        *e = r->event;
+        e->time_us = time_us;
+        if (e->status == 0xF0) {
+            e->sysex = list.pool + r->sysex_offset;  // Pool is complete after parsing
+        }
+        smf->duration_us = time_us;
+    }
+
+    smf->sysex_data = list.pool;
+    free(list.items);
+    return true;
+}
+
+bool smf_load(const char *path, smf_file_t *smf, char *error, size_t error_size) {
+    memset(smf, 0, sizeof(*smf));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return fail(error, error_size, "can't open %s", path);
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0) {
+        fclose(f);
+        return fail(error, error_size, "%s is empty", path);
+    }
+
+    uint8_t *data = malloc((size_t)size);
+    if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+        free(data);
+        fclose(f);
+        return fail(error, error_size, "can't read %s", path);
+    }
+    fclose(f);
+
+    bool ok = smf_parse(data, (size_t)size, smf, error, error_size);
+    free(data);
+    return ok;
+}
+
+void smf_free(smf_file_t *smf) {
+    free(smf->events);
+    free(smf->sysex_data);
+    memset(smf, 0, sizeof(*smf));
+}
@@ -0,0 +1,72 @@
+#ifndef SMF_H
+#define SMF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Standard MIDI File reader (host build)
+ *
+ * Loads format 0 and 1 files into a single list of events in playback
+ * order with absolute times in microseconds. The tempo map (from any
+ * track) and SMPTE time division are applied; running status is
+ * supported. Meta events other than tempo are dropped.
+ */
+
+/**
+ * One event of the merged playback list
+ */
+typedef struct {
+    uint64_t time_us;        // Time from the start of the file
+    uint8_t status;          // Channel status byte, or 0xF0 for SysEx
+    uint8_t data1;
+    uint8_t data2;
+    uint8_t length;          // Channel message bytes (1-3), 0 for SysEx
+    const uint8_t *sysex;    // Complete SysEx message (F0 ... F7)
+    uint32_t sysex_length;
+} smf_event_t;
+
+/**
+ * A loaded file
+ */
+typedef struct {
+    smf_event_t *events;
+    size_t event_count;
+    uint16_t format;
+    uint16_t track_count;
+    uint64_t duration_us;    // Time of the last event
+    uint8_t *sysex_data;     // Storage for SysEx payloads
+} smf_file_t;
+
+/**
+ * Load a Standard MIDI File
+ *
+ * @param path File path
+ * @param smf File to fill in (free with smf_free())
+ * @param error Buffer for an error message (may be NULL)
+ * @param error_size Size of the error buffer
+ * @return true if successful, false otherwise
+ */
+bool smf_load(const char *path, smf_file_t *smf, char *error, size_t error_size);
+
+/**
+ * Parse a Standard MIDI File from memory
+ *
+ * @param data File contents
+ * @param size Number of bytes
+ * @param smf File to fill in (free with smf_free())
+ * @param error Buffer for an error message (may be NULL)
+ * @param error_size Size of the error buffer
+ * @return true if successful, false otherwise
+ */
+bool smf_parse(const uint8_t *data, size_t size, smf_file_t *smf, char *error, size_t error_size);
+
+/**
+ * Free a loaded file
+ *
+ * @param smf File to free
+ */
+void smf_free(smf_file_t *smf);
+
+#endif // SMF_H
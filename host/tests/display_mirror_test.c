@@ -0,0 +1,294 @@
+/**
+ * Display mirror test (host build)
+ *
+ * Boots the firmware (see sim/firmware_harness.h), turns the framebuffer
+ * mirror on with its SysEx command and decodes every mirror message the
+ * firmware sends over USB, the way a host viewer would. After each step
+ * the decoded frame must match the SSD1306 model's GDDRAM and start line.
+ * Also checks the message framing (size, 7-bit data) and the pacing, and
+ * that a message the USB FIFO takes only part of is finished rather than
+ * started over (a step with the writes cut short, see
+ * hal_host_usb_set_tx_limit()).
+ *
+ *   display_mirror_test
+ */
+
+#include "firmware_harness.h"
+#include "hal_host.h"
+#include "display_handler.h"
+#include "menu_handler.h"
+#include "midi_handler.h"
+#include "oled_display.h"
+#include "pico/time.h"
+#include <stdio.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define MIRROR_TEST_SETTLE_US       2000000 // Most a step may take to catch up
+#define MIRROR_TEST_POLL_US         1000    // Main loop passes between checks
+#define MIRROR_TEST_MIN_GAP_US      10000   // Pacing: one message per 10 ms at most
+#define MIRROR_TEST_SYSEX_MAX       256
+#define MIRROR_TEST_TX_LIMIT        16      // Bytes per USB write in the partial_writes step
+
+//--------------------------------------------------------------------+
+// Host Side Decoder
+//--------------------------------------------------------------------+
+
+static uint8_t host_frame[SSD1306_MODEL_PAGES][SSD1306_MODEL_WIDTH];
+static uint8_t host_start_line;
+static bool host_mirror_on;
+
+static uint8_t sysex[MIRROR_TEST_SYSEX_MAX];
+static size_t sysex_length;
+static bool in_sysex;
+static uint64_t sysex_start_us;     // When the message's first byte went out
+
+static uint32_t mirror_messages;
+static uint32_t mirror_bytes;
+static uint64_t last_message_us;
+static int errors;
+
+static void fail(const char *what) {
+    printf("  error: %s\n", what);
+    errors++;
+}
+
+// Unpack 7-bit data: a byte of top bits, then up to 7 low parts
+static size_t unpack7(const uint8_t *in, size_t length, uint8_t *out) {
+    size_t n = 0;
+    for (size_t i = 0; i < length; i += 8) {
+        uint8_t msbs = in[i];
+        for (size_t j = 1; j < 8 && i + j < length; j++) {
+            out[n++] = in[i + j] | (((msbs >> (j - 1)) & 1) << 7);
+        }
+    }
+    return n;
+}
+
+static void apply_frame_message(const uint8_t *msg, size_t length) {
+    if (mirror_messages && sysex_start_us - last_message_us < MIRROR_TEST_MIN_GAP_US) {
+        fail("mirror messages closer than the pacing interval");
+    }
+    last_message_us = sysex_start_us;
+    mirror_messages++;
+    mirror_bytes += length;
+
+    if (length > DISPLAY_MIRROR_MESSAGE_MAX) {
+        fail("mirror message longer than DISPLAY_MIRROR_MESSAGE_MAX");
+    }
+    if (length < 8 || !host_mirror_on) {
+        fail("unexpected or short mirror message");
+        return;
+    }
+
+    uint8_t page = msg[4];
+    uint16_t x = msg[5];
+    host_start_line = msg[6];
+    if (page >= SSD1306_MODEL_PAGES || x >= SSD1306_MODEL_WIDTH || host_start_line >= SSD1306_MODEL_HEIGHT) {
+        fail("mirror message position out of range");
+        return;
+    }
+
+    uint8_t data[MIRROR_TEST_SYSEX_MAX];
+    size_t n = unpack7(&msg[7], length - 8, data);
+
+    // PackBits over the XOR of the new frame with the old one
+    size_t i = 0;
+    while (i < n) {
+        uint8_t header = data[i++];
+        if (header < 128) {
+            for (int k = 0; k <= header; k++) {
+                if (i >= n || x >= SSD1306_MODEL_WIDTH) {
+                    fail("literal run past the data or the page");
+                    return;
+                }
+                host_frame[page][x++] ^= data[i++];
+            }
+        } else if (header > 128) {
+            if (i >= n) {
+                fail("repeat run without its byte");
+                return;
+            }
+            uint8_t value = data[i++];
+            for (int k = 0; k < 257 - header; k++) {
+                if (x >= SSD1306_MODEL_WIDTH) {
+                    fail("repeat run past the page");
+                    return;
+                }
+                host_frame[page][x++] ^= value;
+            }
+        }
+    }
+}
+
+static void handle_sysex(const uint8_t *msg, size_t length) {
+    if (length < 5 || msg[1] != MIDI_SYSEX_MANUFACTURER_ID || msg[2] != MIDI_SYSEX_DEVICE_ID) {
+        return;
+    }
+    for (size_t i = 1; i < length - 1; i++) {
+        if (msg[i] & 0x80) {
+            fail("SysEx data byte with bit 7 set");
+            return;
+        }
+    }
+
+    if (msg[3] == 0x60 && length == 6) {
+        // Mirror on: start from a blank frame
+        host_mirror_on = msg[4] != 0;
+        memset(host_frame, 0, sizeof(host_frame));
+        host_start_line = 0;
+    } else if (msg[3] == DISPLAY_MIRROR_SYSEX_CMD) {
+        apply_frame_message(msg, length);
+    }
+}
+
+static void on_usb_tx(const uint8_t *data, uint32_t len, void *user_data) {
+    (void)user_data;
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        if (b == 0xF0) {
+            if (in_sysex) {
+                fail("SysEx cut short by the next one");
+            }
+            in_sysex = true;
+            sysex_length = 0;
+            sysex_start_us = time_us_64();
+        }
+        if (!in_sysex) {
+            continue;
+        }
+        if (sysex_length < sizeof(sysex)) {
+            sysex[sysex_length++] = b;
+        }
+        if (b == 0xF7) {
+            in_sysex = false;
+            handle_sysex(sysex, sysex_length);
+        }
+    }
+}
+
+//--------------------------------------------------------------------+
+// Steps
+//--------------------------------------------------------------------+
+
+static void push_note(uint8_t status, uint8_t note, uint8_t velocity) {
+    uint8_t packet[4] = { status >> 4, status, note, velocity };
+    firmware_harness_push_packet(packet, time_us_64());
+}
+
+static void set_mirror(bool on) {
+    uint8_t msg[] = { 0xF0, MIDI_SYSEX_MANUFACTURER_ID, MIDI_SYSEX_DEVICE_ID, 0x60, on ? 1 : 0, 0xF7 };
+    firmware_harness_push_sysex(msg, sizeof(msg), time_us_64());
+}
+
+/**
+ * Run the main loop until the panel and the mirror have caught up, then
+ * compare the decoded frame with the panel
+ */
+static void check_step(const char *name, ssd1306_model_t *oled) {
+    uint64_t start = time_us_64();
+    uint32_t start_bytes = mirror_bytes;
+    uint32_t start_messages = mirror_messages;
+
+    firmware_harness_run_until(start + MIRROR_TEST_POLL_US);
+    while (!(oled_flush_idle() && display_handler_mirror_idle())) {
+        if (time_us_64() - start > MIRROR_TEST_SETTLE_US) {
+            fail("mirror did not catch up");
+            break;
+        }
+        firmware_harness_run_until(time_us_64() + MIRROR_TEST_POLL_US);
+    }
+    uint64_t elapsed = time_us_64() - start;
+
+    int diff = 0;
+    for (int page = 0; page < SSD1306_MODEL_PAGES; page++) {
+        for (int x = 0; x < SSD1306_MODEL_WIDTH; x++) {
+            diff += host_frame[page][x] != oled->gddram[page][x];
+        }
+    }
+    if (host_start_line != oled->start_line) {
+        fail("start line differs from the panel");
+    }
+    if (diff) {
+        printf("  %s: %d bytes differ from the panel\n", name, diff);
+        errors++;
+    }
+
+    printf("%-22s %8u %7u %10.1f  %s\n", name, mirror_messages - start_messages, mirror_bytes - start_bytes,
+           elapsed / 1000.0, diff ? "MISMATCH" : "ok");
+}
+
+int main(void) {
+    if (!firmware_harness_start(NULL)) {
+        fprintf(stderr, "display_mirror_test: firmware failed to boot\n");
+        return 1;
+    }
+    ssd1306_model_t *oled = &firmware_harness_get_models()->oled;
+    hal_host_usb_set_tx_handler(on_usb_tx, NULL);
+
+    printf("%-22s %8s %7s %10s  %s\n", "step", "messages", "bytes", "ms", "result");
+
+    set_mirror(true);
+    check_step("enable", oled);
+
+    push_note(0x90, 60, 100);
+    check_step("single_note", oled);
+
+    push_note(0x80, 60, 0);
+    push_note(0x90, 64, 90);
+    check_step("next_note", oled);
+
+    menu_enter();
+    check_step("menu", oled);
+    menu_next();
+    check_step("menu_next", oled);
+    menu_exit();
+    check_step("menu_exit", oled);
+
+    display_handler_set_note_view(DISPLAY_NOTE_VIEW_PIANO_ROLL);
+    uint8_t low = midi_handler_get_low_note();
+    for (uint8_t i = 0; i < 8; i++) {
+        push_note(0x90, low + i, 100);
+        firmware_harness_run_until(time_us_64() + 120000);
+        push_note(0x80, low + i, 0);
+    }
+    check_step("piano_roll", oled);
+    display_handler_set_note_view(DISPLAY_NOTE_VIEW_SINGLE);
+
+    display_handler_screensaver_start();
+    firmware_harness_run_until(time_us_64() + 500000);
+    display_handler_screensaver_stop();
+    check_step("after_screensaver", oled);
+
+    // The FIFO takes a few bytes at a time: every message still arrives whole
+    hal_host_usb_set_tx_limit(MIRROR_TEST_TX_LIMIT);
+    push_note(0x90, 72, 100);
+    check_step("partial_writes", oled);
+    menu_enter();
+    check_step("partial_writes_menu", oled);
+    menu_exit();
+    push_note(0x80, 72, 0);
+    firmware_harness_run_until(time_us_64() + MIRROR_TEST_POLL_US);
+    hal_host_usb_set_tx_limit(0);
+
+    // Off: nothing more is sent
+    set_mirror(false);
+    firmware_harness_run_until(time_us_64() + MIRROR_TEST_POLL_US);
+    uint32_t messages = mirror_messages;
+    push_note(0x90, 67, 100);
+    firmware_harness_run_until(time_us_64() + 100000);
+    if (mirror_messages != messages) {
+        fail("mirror messages after turning it off");
+    }
+
+    firmware_harness_stop();
+
+    if (errors) {
+        printf("FAIL: %d errors\n", errors);
+        return 1;
+    }
+    return 0;
+}
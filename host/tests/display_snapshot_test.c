@@ -0,0 +1,187 @@
+/**
+ * Display snapshot test (host build)
+ *
+ * Runs src/display_snapshot.c, the double buffers core0 publishes display
+ * snapshots and notes through for core1 (DISPLAY_CORE1). The main loop
+ * plays core1 and reads the snapshot, then the notes, back to back;
+ * core0's publishes come from a timer signal, notes n then snapshot n, two
+ * of each at a time, so they land anywhere inside a read the way core0
+ * running alongside core1 would, and the second one rewrites the slot the
+ * first one left. Every byte of a published snapshot (notes) is derived
+ * from its screen_id (roll_held), so a copy mixing two publishes shows up
+ * as bytes that disagree. Reads must also never go back to an older
+ * publish, notes read after a snapshot must be at least as new as it, and
+ * both must end with the last one published.
+ *
+ *   display_snapshot_test [PUBLISHES]
+ */
+
+#include "display_snapshot.h"
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define SNAPSHOT_TEST_PUBLISHES   40000
+#define SNAPSHOT_TEST_PERIOD_US   20      // Timer period between publish pairs
+
+//--------------------------------------------------------------------+
+// Snapshots
+//--------------------------------------------------------------------+
+
+// Snapshot n: every byte (n & 0xFF) but the screen_id, which is n
+static void make_snapshot(display_snapshot_t *snapshot, uint32_t n) {
+    memset(snapshot, (uint8_t)n, sizeof(*snapshot));
+    snapshot->screen_id = n;
+}
+
+// Notes n: every byte (n & 0xFF) but roll_held, which is n
+static void make_notes(display_notes_t *notes, uint32_t n) {
+    memset(notes, (uint8_t)n, sizeof(*notes));
+    notes->roll_held = (uint16_t)n;
+}
+
+// Offset of the first byte other than expected outside the id, -1 if none
+static long torn_offset(const void *data, size_t size, size_t id_offset, size_t id_size, uint8_t expected) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        if ((i < id_offset || i >= id_offset + id_size) && bytes[i] != expected) {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+//--------------------------------------------------------------------+
+// Core0: Publisher
+//--------------------------------------------------------------------+
+
+static uint32_t publishes = SNAPSHOT_TEST_PUBLISHES;
+static volatile uint32_t published = 0;
+
+static void publish_pair(int signal) {
+    (void)signal;
+    static display_snapshot_t snapshot;
+    static display_notes_t notes;
+
+    for (uint8_t i = 0; i < 2 && published < publishes; i++) {
+        make_notes(&notes, published + 1);
+        display_snapshot_publish_notes(&notes);
+        make_snapshot(&snapshot, published + 1);
+        display_snapshot_publish(&snapshot);
+        published++;
+    }
+}
+
+static void set_publish_timer(uint32_t period_us) {
+    struct itimerval timer = {
+        .it_interval = { .tv_sec = 0, .tv_usec = period_us },
+        .it_value = { .tv_sec = 0, .tv_usec = period_us },
+    };
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+//--------------------------------------------------------------------+
+// Core1: Reader
+//--------------------------------------------------------------------+
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        publishes = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (publishes > UINT16_MAX) {
+        publishes = UINT16_MAX;     // Notes carry their number in roll_held
+    }
+
+    static display_snapshot_t snapshot;
+    static display_notes_t notes;
+    uint32_t count = 0;
+    uint32_t notes_count = 0;
+    int errors = 0;
+
+    if (display_snapshot_read(&snapshot, &count) || display_snapshot_read_notes(&notes, &notes_count)) {
+        printf("  read a snapshot or notes before any was published\n");
+        errors++;
+    }
+
+    signal(SIGALRM, publish_pair);
+    set_publish_timer(SNAPSHOT_TEST_PERIOD_US);
+
+    uint32_t reads = 0;
+    uint32_t last_id = 0;
+    uint32_t last_notes_id = 0;
+    while (last_id != publishes && errors < 10) {
+        // Copy the latest publishes again and again, not only new ones, so
+        // the publishes keep landing inside a copy
+        uint32_t stale = 0;
+        uint32_t stale_notes = 0;
+        if (!display_snapshot_read(&snapshot, &stale) || !display_snapshot_read_notes(&notes, &stale_notes)) {
+            continue;
+        }
+        reads++;
+
+        long offset = torn_offset(&snapshot, sizeof(snapshot), offsetof(display_snapshot_t, screen_id),
+                                  sizeof(snapshot.screen_id), (uint8_t)snapshot.screen_id);
+        if (offset >= 0) {
+            printf("  torn read: snapshot %u has byte %ld from another publish\n",
+                   snapshot.screen_id, offset);
+            errors++;
+        }
+        offset = torn_offset(&notes, sizeof(notes), offsetof(display_notes_t, roll_held),
+                             sizeof(notes.roll_held), (uint8_t)notes.roll_held);
+        if (offset >= 0) {
+            printf("  torn read: notes %u have byte %ld from another publish\n", notes.roll_held, offset);
+            errors++;
+        }
+        if (snapshot.screen_id < last_id || snapshot.screen_id > publishes) {
+            printf("  read snapshot %u after %u\n", snapshot.screen_id, last_id);
+            errors++;
+        }
+        if (notes.roll_held < last_notes_id || notes.roll_held < snapshot.screen_id) {
+            printf("  read notes %u after notes %u and snapshot %u\n", notes.roll_held, last_notes_id,
+                   snapshot.screen_id);
+            errors++;
+        }
+        last_id = snapshot.screen_id;
+        last_notes_id = notes.roll_held;
+    }
+    set_publish_timer(0);
+
+    // A reader keeping count catches up with the last snapshot and stops there
+    if (errors == 0) {
+        while (display_snapshot_read(&snapshot, &count)) {
+        }
+        while (display_snapshot_read_notes(&notes, &notes_count)) {
+        }
+        if (count != publishes || snapshot.screen_id != publishes) {
+            printf("  read snapshot %u at publish count %u, after %u publishes\n", snapshot.screen_id,
+                   count, publishes);
+            errors++;
+        }
+        if (notes_count != publishes || notes.roll_held != (uint16_t)publishes) {
+            printf("  read notes %u at publish count %u, after %u publishes\n", notes.roll_held,
+                   notes_count, publishes);
+            errors++;
+        }
+        if (display_snapshot_count() != 2 * publishes) {
+            printf("  display_snapshot_count() is %u, expected %u\n", display_snapshot_count(),
+                   2 * publishes);
+            errors++;
+        }
+    }
+
+    printf("%u publishes, %u reads\n", publishes, reads);
+    if (errors) {
+        printf("FAIL: %d errors\n", errors);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
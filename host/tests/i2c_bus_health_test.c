@@ -0,0 +1,250 @@
+/**
+ * I2C device health test (host build)
+ *
+ * Runs lib/i2c_bus on the simulated bus with two PCF8574s on i2c1 and
+ * injects faults into one of them (see i2c_sim_set_fault()):
+ *
+ * - NAKs: the device is isolated after I2C_BUS_ISOLATE_THRESHOLD failures,
+ *   refused without touching the bus until I2C_BUS_ISOLATE_RETRY_MS have
+ *   passed on the virtual clock, then given a single try, and taken back
+ *   once it answers again.
+ * - A timeout: the transfer holds the bus for the timeout i2c_bus gave it
+ *   and the bus is recovered (controller reprogrammed at its speed).
+ * - SDA stuck low: recovery clocks SCL until the device lets go; one
+ *   holding on past nine clocks fails recovery.
+ *
+ * The other device is written throughout and must always be served.
+ *
+ *   i2c_bus_health_test
+ */
+
+#include "i2c_bus.h"
+#include "i2c_sim.h"
+#include "hal_host.h"
+#include "pcf857x_model.h"
+#include "pico/error.h"
+#include <stdio.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define HEALTH_TEST_BUS         1
+#define HEALTH_TEST_SDA_PIN     2
+#define HEALTH_TEST_SCL_PIN     3
+
+#define HEALTH_TEST_FAULTY_ADDR 0x20
+#define HEALTH_TEST_GOOD_ADDR   0x21
+
+#define HEALTH_TEST_STEP_MS     100     // Clock step while the faulty device is isolated
+#define HEALTH_TEST_STUCK_CLOCKS 3      // SCL clocks a stuck device needs to let go
+
+//--------------------------------------------------------------------+
+// Checks
+//--------------------------------------------------------------------+
+
+static int errors;
+static pcf857x_model_t faulty;
+static pcf857x_model_t good;
+
+static void fail(const char *scenario, const char *what) {
+    printf("  %s: %s\n", scenario, what);
+    errors++;
+}
+
+static void check_count(const char *scenario, const char *what, uint32_t actual, uint32_t expected) {
+    if (actual != expected) {
+        printf("  %s: %s %u, expected %u\n", scenario, what, actual, expected);
+        errors++;
+    }
+}
+
+static int write_device(uint8_t address, uint8_t value) {
+    return i2c_bus_write_blocking(i2c1, address, &value, 1, false);
+}
+
+static i2c_bus_device_health_t get_health(uint8_t address) {
+    i2c_bus_device_health_t health = { 0 };
+    i2c_bus_get_device_health(i2c1, address, &health);
+    return health;
+}
+
+static size_t timeline_count(void) {
+    size_t count;
+    i2c_sim_get_timeline(&count);
+    return count;
+}
+
+static const i2c_sim_event_t* last_event(void) {
+    size_t count;
+    const i2c_sim_event_t *timeline = i2c_sim_get_timeline(&count);
+    return count ? &timeline[count - 1] : NULL;
+}
+
+// The good device must take a write and latch it, whatever the other one does
+static void check_good_served(const char *scenario) {
+    uint8_t value = (uint8_t)(good.latch_updates + 1);
+    if (write_device(HEALTH_TEST_GOOD_ADDR, value) != 1 || good.latch != value) {
+        fail(scenario, "other device not served");
+    }
+}
+
+//--------------------------------------------------------------------+
+// Scenarios
+//--------------------------------------------------------------------+
+
+static void test_isolation(void) {
+    const char *scenario = "isolation";
+    i2c_sim_set_fault(&faulty.base, I2C_SIM_FAULT_NAK, 0);
+
+    for (uint8_t i = 1; i <= I2C_BUS_ISOLATE_THRESHOLD; i++) {
+        if (write_device(HEALTH_TEST_FAULTY_ADDR, i) != PICO_ERROR_GENERIC) {
+            fail(scenario, "NAKed write did not fail");
+        }
+        i2c_bus_device_health_t health = get_health(HEALTH_TEST_FAULTY_ADDR);
+        check_count(scenario, "consecutive_failures", health.consecutive_failures, i);
+        if (health.isolated != (i == I2C_BUS_ISOLATE_THRESHOLD)) {
+            printf("  %s: isolated %d after %u failures\n", scenario, health.isolated, i);
+            errors++;
+        }
+        check_good_served(scenario);
+    }
+    uint64_t isolated_ms = hal_host_time_us() / 1000;
+
+    // Refused without a transfer until the retry time; the other device carries on
+    size_t sent = timeline_count();
+    while (hal_host_time_us() / 1000 + HEALTH_TEST_STEP_MS < isolated_ms + I2C_BUS_ISOLATE_RETRY_MS) {
+        hal_host_time_advance_us(HEALTH_TEST_STEP_MS * 1000);
+        if (write_device(HEALTH_TEST_FAULTY_ADDR, 0) != PICO_ERROR_GENERIC) {
+            fail(scenario, "isolated device not refused");
+        }
+        check_count(scenario, "transfers while isolated", (uint32_t)(timeline_count() - sent), 0);
+        check_good_served(scenario);
+        sent = timeline_count();
+    }
+    hal_host_time_set_us((isolated_ms + I2C_BUS_ISOLATE_RETRY_MS) * 1000 - 1);
+    write_device(HEALTH_TEST_FAULTY_ADDR, 0);
+    check_count(scenario, "transfers 1 us before the retry time", (uint32_t)(timeline_count() - sent), 0);
+    check_count(scenario, "nak_count while isolated", get_health(HEALTH_TEST_FAULTY_ADDR).nak_count,
+                I2C_BUS_ISOLATE_THRESHOLD);
+
+    // One try at the retry time; still NAKing, so isolated again right away
+    hal_host_time_advance_us(1);
+    if (write_device(HEALTH_TEST_FAULTY_ADDR, 0) != PICO_ERROR_GENERIC) {
+        fail(scenario, "retry of a NAKing device did not fail");
+    }
+    check_count(scenario, "transfers at the retry time", (uint32_t)(timeline_count() - sent), 1);
+    write_device(HEALTH_TEST_FAULTY_ADDR, 0);
+    check_count(scenario, "transfers after a failed retry", (uint32_t)(timeline_count() - sent), 1);
+    i2c_bus_device_health_t health = get_health(HEALTH_TEST_FAULTY_ADDR);
+    check_count(scenario, "nak_count after the retry", health.nak_count, I2C_BUS_ISOLATE_THRESHOLD + 1);
+    if (!health.isolated) {
+        fail(scenario, "not isolated after a failed retry");
+    }
+
+    // Answering again at the next retry: back in service
+    i2c_sim_set_fault(&faulty.base, I2C_SIM_FAULT_NONE, 0);
+    hal_host_time_advance_us(I2C_BUS_ISOLATE_RETRY_MS * 1000);
+    if (write_device(HEALTH_TEST_FAULTY_ADDR, 0x5A) != 1 || faulty.latch != 0x5A) {
+        fail(scenario, "recovered device not written");
+    }
+    health = get_health(HEALTH_TEST_FAULTY_ADDR);
+    if (health.isolated || health.consecutive_failures) {
+        fail(scenario, "still isolated after answering");
+    }
+    if (write_device(HEALTH_TEST_FAULTY_ADDR, 0xA5) != 1) {
+        fail(scenario, "recovered device refused");
+    }
+}
+
+static void test_timeout(void) {
+    const char *scenario = "timeout";
+    i2c_sim_set_fault(&faulty.base, I2C_SIM_FAULT_TIMEOUT, 1);
+    uint32_t programmed = hal_host_i2c_get_program_count(HEALTH_TEST_BUS);
+    uint64_t start_us = hal_host_time_us();
+
+    if (write_device(HEALTH_TEST_FAULTY_ADDR, 0x11) != PICO_ERROR_TIMEOUT) {
+        fail(scenario, "stretched write did not time out");
+    }
+
+    // The transfer held the bus for the timeout it was given
+    const i2c_sim_event_t *event = last_event();
+    if (!event || !(event->flags & I2C_SIM_FLAG_TIMEOUT) || event->address != HEALTH_TEST_FAULTY_ADDR) {
+        fail(scenario, "no timed out transfer on the timeline");
+    } else if (event->wire_time_ns < I2C_BUS_TIMEOUT_MARGIN_US * 1000u ||
+               hal_host_time_us() - start_us < event->wire_time_ns / 1000) {
+        printf("  %s: bus held %u ns, clock moved %llu us\n", scenario, event->wire_time_ns,
+               (unsigned long long)(hal_host_time_us() - start_us));
+        errors++;
+    }
+
+    i2c_bus_device_health_t health = get_health(HEALTH_TEST_FAULTY_ADDR);
+    check_count(scenario, "timeout_count", health.timeout_count, 1);
+    check_count(scenario, "recovery_count", health.recovery_count, 1);
+    check_count(scenario, "controller reprogrammed", hal_host_i2c_get_program_count(HEALTH_TEST_BUS) - programmed, 1);
+    check_count(scenario, "recovered at", hal_host_i2c_get_baudrate(HEALTH_TEST_BUS), I2C_BUS_SPEED_FAST);
+
+    check_good_served(scenario);
+    if (write_device(HEALTH_TEST_FAULTY_ADDR, 0x22) != 1 || faulty.latch != 0x22) {
+        fail(scenario, "device not written after the timeout");
+    }
+}
+
+static void test_stuck_sda(void) {
+    const char *scenario = "stuck_sda";
+    uint32_t recoveries = get_health(HEALTH_TEST_FAULTY_ADDR).recovery_count;
+
+    // Let go after a few clocks: recovered, and every device served after it
+    i2c_sim_stick_sda(HEALTH_TEST_BUS, HEALTH_TEST_SDA_PIN, HEALTH_TEST_SCL_PIN, HEALTH_TEST_STUCK_CLOCKS);
+    if (write_device(HEALTH_TEST_FAULTY_ADDR, 0x33) != PICO_ERROR_TIMEOUT) {
+        fail(scenario, "write with SDA held low did not time out");
+    }
+    if (i2c_sim_is_sda_stuck(HEALTH_TEST_BUS)) {
+        fail(scenario, "recovery did not clock SDA free");
+    }
+    check_count(scenario, "recovery_count", get_health(HEALTH_TEST_FAULTY_ADDR).recovery_count, recoveries + 1);
+    check_good_served(scenario);
+    if (write_device(HEALTH_TEST_FAULTY_ADDR, 0x44) != 1 || faulty.latch != 0x44) {
+        fail(scenario, "device not written after recovery");
+    }
+
+    // Never letting go: recovery reports failure until the line is free
+    i2c_sim_stick_sda(HEALTH_TEST_BUS, HEALTH_TEST_SDA_PIN, HEALTH_TEST_SCL_PIN, 10);
+    if (write_device(HEALTH_TEST_GOOD_ADDR, 0x55) != PICO_ERROR_TIMEOUT) {
+        fail(scenario, "write with SDA held for good did not time out");
+    }
+    if (i2c_bus_recover(i2c1)) {
+        fail(scenario, "recovery succeeded with SDA still held");
+    }
+    i2c_sim_stick_sda(HEALTH_TEST_BUS, HEALTH_TEST_SDA_PIN, HEALTH_TEST_SCL_PIN, 0);
+    if (!i2c_bus_recover(i2c1)) {
+        fail(scenario, "recovery failed on a free bus");
+    }
+    check_good_served(scenario);
+}
+
+int main(void) {
+    hal_host_reset();
+    if (!i2c_sim_init(0)) {
+        printf("FAIL: no timeline\n");
+        return 1;
+    }
+    pcf857x_model_init(&faulty, HEALTH_TEST_BUS, HEALTH_TEST_FAULTY_ADDR, false);
+    pcf857x_model_init(&good, HEALTH_TEST_BUS, HEALTH_TEST_GOOD_ADDR, false);
+    i2c_sim_attach(&faulty.base);
+    i2c_sim_attach(&good.base);
+    i2c_bus_init(i2c1, HEALTH_TEST_SDA_PIN, HEALTH_TEST_SCL_PIN, I2C_BUS_SPEED_FAST);
+
+    test_isolation();
+    test_timeout();
+    test_stuck_sda();
+
+    i2c_sim_print_summary(stdout);
+    i2c_sim_deinit();
+    if (errors) {
+        printf("FAIL: %d errors\n", errors);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
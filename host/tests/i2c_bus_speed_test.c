@@ -0,0 +1,152 @@
+/**
+ * I2C per-device speed test (host build)
+ *
+ * Runs lib/i2c_bus on the simulated bus with a PCF8574 set to 100 kHz, a
+ * PCA9685 set to 1 MHz and a second PCF8574 left on the 400 kHz bus
+ * default, all on i2c1. Transfers alternate between them in runs and
+ * single hops; every transfer must go out at its device's speed, and the
+ * controller may only be reprogrammed when that speed differs from the
+ * one before, each time counted in i2c_bus_get_switch_stats().
+ *
+ *   i2c_bus_speed_test
+ */
+
+#include "i2c_bus.h"
+#include "i2c_sim.h"
+#include "hal_host.h"
+#include "pcf857x_model.h"
+#include "pca9685_model.h"
+#include <stdio.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define SPEED_TEST_BUS        1
+#define SPEED_TEST_SDA_PIN    2
+#define SPEED_TEST_SCL_PIN    3
+
+#define SPEED_TEST_SLOW_ADDR  0x20    // PCF8574, 100 kHz
+#define SPEED_TEST_FAST_ADDR  0x40    // PCA9685, 1 MHz
+#define SPEED_TEST_PLAIN_ADDR 0x21    // PCF8574, bus default
+
+// Transfers in order; reads are marked by a negative address
+static const int speed_test_sequence[] = {
+    SPEED_TEST_SLOW_ADDR, SPEED_TEST_SLOW_ADDR, SPEED_TEST_FAST_ADDR, SPEED_TEST_FAST_ADDR,
+    SPEED_TEST_SLOW_ADDR, SPEED_TEST_FAST_ADDR, SPEED_TEST_SLOW_ADDR, -SPEED_TEST_SLOW_ADDR,
+    SPEED_TEST_PLAIN_ADDR, SPEED_TEST_PLAIN_ADDR, SPEED_TEST_FAST_ADDR, SPEED_TEST_PLAIN_ADDR,
+    SPEED_TEST_SLOW_ADDR, SPEED_TEST_FAST_ADDR, SPEED_TEST_FAST_ADDR, SPEED_TEST_FAST_ADDR,
+};
+
+#define SPEED_TEST_TRANSFERS (sizeof(speed_test_sequence) / sizeof(speed_test_sequence[0]))
+
+//--------------------------------------------------------------------+
+// Checks
+//--------------------------------------------------------------------+
+
+static int errors;
+
+static void fail(size_t step, const char *what, uint32_t actual, uint32_t expected) {
+    printf("  transfer %zu: %s %u, expected %u\n", step, what, actual, expected);
+    errors++;
+}
+
+static uint32_t device_speed(uint8_t address) {
+    switch (address) {
+    case SPEED_TEST_SLOW_ADDR:
+        return I2C_BUS_SPEED_STANDARD;
+    case SPEED_TEST_FAST_ADDR:
+        return I2C_BUS_SPEED_FAST_PLUS;
+    default:
+        return I2C_BUS_SPEED_FAST;
+    }
+}
+
+int main(void) {
+    static pcf857x_model_t slow;
+    static pcf857x_model_t plain;
+    static pca9685_model_t fast;
+
+    hal_host_reset();
+    if (!i2c_sim_init(0)) {
+        printf("FAIL: no timeline\n");
+        return 1;
+    }
+    pcf857x_model_init(&slow, SPEED_TEST_BUS, SPEED_TEST_SLOW_ADDR, false);
+    pcf857x_model_init(&plain, SPEED_TEST_BUS, SPEED_TEST_PLAIN_ADDR, false);
+    pca9685_model_init(&fast, SPEED_TEST_BUS, SPEED_TEST_FAST_ADDR);
+    i2c_sim_attach(&slow.base);
+    i2c_sim_attach(&plain.base);
+    i2c_sim_attach(&fast.base);
+
+    i2c_bus_init(i2c1, SPEED_TEST_SDA_PIN, SPEED_TEST_SCL_PIN, I2C_BUS_SPEED_FAST);
+    i2c_bus_set_device_speed(i2c1, SPEED_TEST_SLOW_ADDR, I2C_BUS_SPEED_STANDARD);
+    i2c_bus_set_device_speed(i2c1, SPEED_TEST_FAST_ADDR, I2C_BUS_SPEED_FAST_PLUS);
+
+    static const uint8_t addresses[] = { SPEED_TEST_SLOW_ADDR, SPEED_TEST_FAST_ADDR, SPEED_TEST_PLAIN_ADDR };
+    for (size_t i = 0; i < sizeof(addresses); i++) {
+        uint32_t speed = i2c_bus_get_device_speed(i2c1, addresses[i]);
+        if (speed != device_speed(addresses[i])) {
+            printf("  0x%02X: i2c_bus_get_device_speed() is %u, expected %u\n", addresses[i], speed,
+                   device_speed(addresses[i]));
+            errors++;
+        }
+    }
+
+    // Only the transfers below reprogram the controller from here on
+    uint32_t programmed = hal_host_i2c_get_program_count(SPEED_TEST_BUS);
+    uint32_t current = I2C_BUS_SPEED_FAST;
+    uint32_t switches = 0;
+
+    for (size_t i = 0; i < SPEED_TEST_TRANSFERS; i++) {
+        bool read = speed_test_sequence[i] < 0;
+        uint8_t address = (uint8_t)(read ? -speed_test_sequence[i] : speed_test_sequence[i]);
+        uint8_t data[2] = { 0xFF, (uint8_t)i };
+
+        int result = read ? i2c_bus_read_blocking(i2c1, address, data, 1, false)
+                          : i2c_bus_write_blocking(i2c1, address, data, 2, false);
+        if (result < 0) {
+            fail(i, "result", (uint32_t)result, read ? 1 : 2);
+        }
+
+        uint32_t wanted = device_speed(address);
+        if (wanted != current) {
+            current = wanted;
+            switches++;
+        }
+
+        size_t count;
+        const i2c_sim_event_t *timeline = i2c_sim_get_timeline(&count);
+        if (count != i + 1) {
+            fail(i, "timeline entries", (uint32_t)count, (uint32_t)(i + 1));
+        } else if (timeline[i].baudrate != wanted) {
+            fail(i, "ran at", timeline[i].baudrate, wanted);
+        }
+        if (hal_host_i2c_get_baudrate(SPEED_TEST_BUS) != wanted) {
+            fail(i, "controller left at", hal_host_i2c_get_baudrate(SPEED_TEST_BUS), wanted);
+        }
+        if (hal_host_i2c_get_program_count(SPEED_TEST_BUS) - programmed != switches) {
+            fail(i, "baud rate programmed", hal_host_i2c_get_program_count(SPEED_TEST_BUS) - programmed,
+                 switches);
+        }
+
+        i2c_bus_switch_stats_t stats;
+        i2c_bus_get_switch_stats(i2c1, &stats);
+        if (stats.switch_count != switches) {
+            fail(i, "switch_count", stats.switch_count, switches);
+        }
+    }
+
+    i2c_bus_switch_stats_t stats;
+    i2c_bus_get_switch_stats(i2c1, &stats);
+    printf("%zu transfers, %u switches (%u us total, %u us max)\n", SPEED_TEST_TRANSFERS,
+           stats.switch_count, stats.switch_time_total_us, stats.switch_time_max_us);
+
+    i2c_sim_deinit();
+    if (errors) {
+        printf("FAIL: %d errors\n", errors);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,306 @@
+/**
+ * I2C trace reply test (host build)
+ *
+ * Boots the firmware (see sim/firmware_harness.h), clears the I2C trace
+ * with its SysEx command (0x52) and runs known traffic over the simulated
+ * bus: notes to the PCF8575 and the display, reads from the expander and
+ * writes to an address nobody answers. The simulated bus timeline is the
+ * reference. The trace ring must hold the timeline's last transfers, and
+ * every 0x51 reply, decoded the way a host tool would (five 7-bit bytes
+ * per counter, least significant first), must match the timeline up to
+ * the moment the query was picked up: the address list, and per address
+ * the transactions, bytes, errors and times.
+ *
+ *   i2c_trace_test
+ */
+
+#include "firmware_harness.h"
+#include "hal_host.h"
+#include "i2c_trace.h"
+#include "i2c_bus.h"
+#include "midi_handler.h"
+#include "pico/time.h"
+#include <stdio.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define TRACE_TEST_SETTLE_US    300000  // Main loop time for the display to catch up
+#define TRACE_TEST_MISSING_ADDR 0x27    // Nothing attached: every transfer NAKs
+#define TRACE_TEST_SYSEX_MAX    128
+
+#define TRACE_CMD_QUERY         0x51
+#define TRACE_CMD_RESET         0x52
+#define TRACE_ADDRESS_LIST      0x7F
+
+//--------------------------------------------------------------------+
+// Reference: the simulated bus timeline
+//--------------------------------------------------------------------+
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t errors;
+    uint64_t wire_time_ns;
+    uint32_t max_wire_time_ns;
+} expected_stats_t;
+
+static int errors;
+static size_t queried_events;       // Timeline entries when the last query was picked up
+static bool resetting;              // The next SysEx picked up is the reset
+
+static void fail(const char *what) {
+    printf("  error: %s\n", what);
+    errors++;
+}
+
+static expected_stats_t expected_stats(uint8_t address, size_t events) {
+    expected_stats_t stats = { 0 };
+    const i2c_sim_event_t *timeline = i2c_sim_get_timeline(NULL);
+    for (size_t i = 0; i < events; i++) {
+        if (timeline[i].address != address) {
+            continue;
+        }
+        stats.transactions++;
+        if (timeline[i].flags & (I2C_SIM_FLAG_NAK | I2C_SIM_FLAG_TIMEOUT)) {
+            stats.errors++;
+        } else {
+            stats.bytes += timeline[i].length;      // Only bytes that got through
+        }
+        stats.wire_time_ns += timeline[i].wire_time_ns;
+        if (timeline[i].wire_time_ns > stats.max_wire_time_ns) {
+            stats.max_wire_time_ns = timeline[i].wire_time_ns;
+        }
+    }
+    return stats;
+}
+
+// The firmware picks a SysEx up: the reset starts the reference over, and
+// a query answers for the traffic so far
+static void on_dispatch(const firmware_harness_event_t *event, uint64_t now_us, void *user_data) {
+    (void)now_us;
+    (void)user_data;
+    if (event->status != 0xF0) {
+        return;
+    }
+    if (resetting) {
+        i2c_sim_clear();
+        resetting = false;
+    }
+    i2c_sim_get_timeline(&queried_events);
+}
+
+//--------------------------------------------------------------------+
+// Host Side Decoder
+//--------------------------------------------------------------------+
+
+static uint8_t sysex[TRACE_TEST_SYSEX_MAX];
+static size_t sysex_length;
+static bool in_sysex;
+static uint32_t replies;
+static uint32_t counter_replies;
+
+static uint64_t get_u35(const uint8_t *in) {
+    uint64_t value = 0;
+    for (int i = 4; i >= 0; i--) {
+        value = (value << 7) | in[i];
+    }
+    return value;
+}
+
+static void check_counter(uint8_t address, const char *name, uint64_t actual, uint64_t low, uint64_t high) {
+    if (actual < low || actual > high) {
+        printf("  0x%02X %s: reply %llu, expected %llu..%llu\n", address, name, (unsigned long long)actual,
+               (unsigned long long)low, (unsigned long long)high);
+        errors++;
+    }
+}
+
+static void check_address_list(const uint8_t *list, size_t count) {
+    bool listed[I2C_TRACE_NUM_ADDRESSES] = { false };
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && list[i] <= list[i - 1]) {
+            fail("address list out of order");
+        }
+        listed[list[i] & 0x7F] = true;
+    }
+    for (uint8_t address = 0; address < I2C_TRACE_NUM_ADDRESSES; address++) {
+        bool active = expected_stats(address, queried_events).transactions > 0;
+        if (listed[address] != active) {
+            printf("  0x%02X: %s the address list\n", address, active ? "missing from" : "wrongly in");
+            errors++;
+        }
+    }
+}
+
+static void check_counters(uint8_t address, const uint8_t *data, size_t length) {
+    if (length != 25) {
+        fail("counter reply is not five 5-byte counters");
+        return;
+    }
+    counter_replies++;
+
+    // Each transfer's time is its wire time, to the microsecond below or above
+    expected_stats_t expected = expected_stats(address, queried_events);
+    uint64_t total_us = expected.wire_time_ns / 1000;
+    uint32_t max_us = expected.max_wire_time_ns / 1000;
+    check_counter(address, "transactions", get_u35(&data[0]), expected.transactions, expected.transactions);
+    check_counter(address, "bytes", get_u35(&data[5]), expected.bytes, expected.bytes);
+    check_counter(address, "errors", get_u35(&data[10]), expected.errors, expected.errors);
+    check_counter(address, "total_us", get_u35(&data[15]),
+                  total_us > expected.transactions ? total_us - expected.transactions : 0,
+                  total_us + expected.transactions);
+    check_counter(address, "max_us", get_u35(&data[20]), max_us ? max_us - 1 : 0, max_us + 1);
+}
+
+static void handle_sysex(const uint8_t *msg, size_t length) {
+    if (length < 6 || msg[1] != MIDI_SYSEX_MANUFACTURER_ID || msg[2] != MIDI_SYSEX_DEVICE_ID ||
+        msg[3] != TRACE_CMD_QUERY) {
+        return;
+    }
+    replies++;
+    for (size_t i = 1; i < length - 1; i++) {
+        if (msg[i] & 0x80) {
+            fail("SysEx data byte with bit 7 set");
+            return;
+        }
+    }
+
+    if (msg[4] == TRACE_ADDRESS_LIST) {
+        check_address_list(&msg[5], length - 6);
+    } else {
+        check_counters(msg[4], &msg[5], length - 6);
+    }
+}
+
+static void on_usb_tx(const uint8_t *data, uint32_t len, void *user_data) {
+    (void)user_data;
+    for (uint32_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        if (b == 0xF0) {
+            in_sysex = true;
+            sysex_length = 0;
+        }
+        if (!in_sysex) {
+            continue;
+        }
+        if (sysex_length < sizeof(sysex)) {
+            sysex[sysex_length++] = b;
+        }
+        if (b == 0xF7) {
+            in_sysex = false;
+            handle_sysex(sysex, sysex_length);
+        }
+    }
+}
+
+//--------------------------------------------------------------------+
+// Steps
+//--------------------------------------------------------------------+
+
+static void send_trace_command(uint8_t command, int address) {
+    uint8_t msg[6] = { 0xF0, MIDI_SYSEX_MANUFACTURER_ID, MIDI_SYSEX_DEVICE_ID, command };
+    size_t length = 4;
+    if (address >= 0) {
+        msg[length++] = (uint8_t)address;
+    }
+    msg[length++] = 0xF7;
+
+    uint32_t before = replies;
+    resetting = command == TRACE_CMD_RESET;
+    firmware_harness_push_sysex(msg, length, time_us_64());
+    firmware_harness_poll();
+    if (command == TRACE_CMD_QUERY && replies != before + 1) {
+        fail("query not answered");
+    }
+}
+
+static void push_note(uint8_t status, uint8_t note, uint8_t velocity) {
+    uint8_t packet[4] = { status >> 4, status, note, velocity };
+    firmware_harness_push_packet(packet, time_us_64());
+}
+
+// The trace ring against the tail of the timeline
+static void check_ring(void) {
+    size_t count;
+    const i2c_sim_event_t *timeline = i2c_sim_get_timeline(&count);
+    size_t held = count < I2C_TRACE_RING_SIZE ? count : I2C_TRACE_RING_SIZE;
+    if (i2c_trace_get_entry_count() != held) {
+        printf("  ring holds %u entries, expected %zu\n", i2c_trace_get_entry_count(), held);
+        errors++;
+    }
+
+    for (uint8_t i = 0; i < held; i++) {
+        const i2c_sim_event_t *event = &timeline[count - 1 - i];
+        i2c_trace_entry_t entry;
+        if (!i2c_trace_get_entry(i, &entry)) {
+            fail("ring entry missing");
+            return;
+        }
+
+        uint8_t flags = ((event->flags & I2C_SIM_FLAG_READ) ? I2C_TRACE_FLAG_READ : 0) |
+                        ((event->flags & I2C_SIM_FLAG_NOSTOP) ? I2C_TRACE_FLAG_NOSTOP : 0) |
+                        ((event->flags & (I2C_SIM_FLAG_NAK | I2C_SIM_FLAG_TIMEOUT)) ? I2C_TRACE_FLAG_ERROR : 0);
+        uint32_t wire_us = event->wire_time_ns / 1000;
+        if (entry.address != event->address || entry.bus != event->bus || entry.length != event->length ||
+            entry.flags != flags || entry.timestamp_us != (uint32_t)event->timestamp_us ||
+            entry.duration_us + 1 < wire_us || entry.duration_us > wire_us + 1) {
+            printf("  ring entry %u: 0x%02X i2c%u len %u flags %u at %u for %u us, timeline 0x%02X i2c%u "
+                   "len %u flags %u at %llu for %u ns\n", i, entry.address, entry.bus, entry.length,
+                   entry.flags, entry.timestamp_us, entry.duration_us, event->address, event->bus,
+                   event->length, flags, (unsigned long long)event->timestamp_us, event->wire_time_ns);
+            errors++;
+        }
+    }
+}
+
+int main(void) {
+    if (!firmware_harness_start(NULL)) {
+        fprintf(stderr, "i2c_trace_test: firmware failed to boot\n");
+        return 1;
+    }
+    hal_host_usb_set_tx_handler(on_usb_tx, NULL);
+    firmware_harness_set_dispatch_callback(on_dispatch, NULL);
+    firmware_harness_run_until(time_us_64() + TRACE_TEST_SETTLE_US);
+
+    // From a clean trace: nothing listed
+    send_trace_command(TRACE_CMD_RESET, -1);
+    send_trace_command(TRACE_CMD_QUERY, -1);
+
+    // Known traffic: notes (expander and display), expander reads, NAKs
+    push_note(0x90, midi_handler_get_low_note(), 100);
+    firmware_harness_run_until(time_us_64() + TRACE_TEST_SETTLE_US);
+    push_note(0x80, midi_handler_get_low_note(), 0);
+    firmware_harness_run_until(time_us_64() + TRACE_TEST_SETTLE_US);
+
+    i2c_inst_t *i2c = i2c_bus_get_role(I2C_BUS_ROLE_ACTUATORS);
+    uint8_t data[2] = { 0xFF, 0xFF };
+    for (int i = 0; i < 3; i++) {
+        i2c_bus_read_blocking(i2c, FIRMWARE_HARNESS_PCF8575_ADDRESS, data, 2, false);
+        i2c_bus_write_blocking(i2c, TRACE_TEST_MISSING_ADDR, data, 2, false);
+    }
+    check_ring();
+
+    send_trace_command(TRACE_CMD_QUERY, -1);
+    send_trace_command(TRACE_CMD_QUERY, FIRMWARE_HARNESS_PCF8575_ADDRESS);
+    send_trace_command(TRACE_CMD_QUERY, FIRMWARE_HARNESS_OLED_ADDRESS);
+    send_trace_command(TRACE_CMD_QUERY, TRACE_TEST_MISSING_ADDR);
+    send_trace_command(TRACE_CMD_QUERY, 0x11);     // Never addressed: all zero
+
+    // The reset clears the counters the replies come from
+    send_trace_command(TRACE_CMD_RESET, -1);
+    send_trace_command(TRACE_CMD_QUERY, FIRMWARE_HARNESS_PCF8575_ADDRESS);
+    send_trace_command(TRACE_CMD_QUERY, -1);
+
+    firmware_harness_stop();
+
+    printf("%u replies, %u with counters\n", replies, counter_replies);
+    if (errors) {
+        printf("FAIL: %d errors\n", errors);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,391 @@
+/**
+ * Recorded-stream latency test (host build)
+ *
+ * Replays a USB-MIDI packet stream through usb_midi_task() on the whole
+ * firmware (see sim/firmware_harness.h) and checks the scenario budgets
+ * given in the stream file:
+ *
+ *   @budget dispatch_us N          every message is picked up within N us
+ *   @budget actuation_us N         every actuator change follows its message within N us
+ *   @budget bus_window_percent N   no 10 ms window has the bus busy more than N%
+ *   @budget bus_percent N          bus busy at most N% over the whole stream
+ *   @budget_tile NAME N            replaces the budget above in a tile mode
+ *                                  build (OLED_TILE_MODE), whose flushes
+ *                                  send whole 8-column chunks
+ *
+ * Stream files hold one packet per line: time in us from the start of the
+ * stream, then the four USB-MIDI packet bytes in hex. `@config` lines set
+ * the stored configuration (player, io, channel, low_note, range, omni)
+ * and `@idle_ms N` runs the firmware without MIDI before the stream starts.
+ *
+ *   latency_test stream.txt
+ */
+
+#include "firmware_harness.h"
+#include "hal_host.h"
+#include "i2c_sim.h"
+#include "configuration_settings.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define LATENCY_MAX_PACKETS       4096
+#define LATENCY_TIMELINE_CAPACITY 262144    // Bus transfers recorded per stream
+#define LATENCY_LEAD_IN_US        1000      // Stream starts 1 ms after mount / idle
+#define LATENCY_TAIL_US           200000    // Run on after the last packet
+#define LATENCY_WINDOW_US         10000     // Bus occupancy window
+#define LATENCY_MAX_REPORTED      10        // Budget violations printed per check
+#define LATENCY_NO_BUDGET         UINT32_MAX
+
+//--------------------------------------------------------------------+
+// Scenario
+//--------------------------------------------------------------------+
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t packet[4];
+} stream_packet_t;
+
+typedef struct {
+    uint64_t intended_us;
+    uint64_t dispatch_us;       // 0 = never picked up
+    uint64_t first_change_us;   // 0 = no actuator change
+    uint8_t status, data1, data2;
+} event_record_t;
+
+static struct {
+    const char *name;
+    firmware_harness_config_t config;
+    uint32_t idle_ms;
+    uint32_t budget_dispatch_us;
+    uint32_t budget_actuation_us;
+    uint32_t budget_bus_window_percent;
+    uint32_t budget_bus_percent;
+
+    stream_packet_t packets[LATENCY_MAX_PACKETS];
+    size_t packet_count;
+
+    event_record_t events[LATENCY_MAX_PACKETS];
+    size_t event_count;         // Tracked messages pushed
+    size_t dispatched;          // Tracked messages picked up
+    uint32_t changes;
+} scenario;
+
+static bool parse_config(const char *key, const char *value) {
+    firmware_harness_config_t *c = &scenario.config;
+    if (strcmp(key, "player") == 0) {
+        c->player = strcmp(value, "mallet") == 0 ? PLAYER_TYPE_MALLET_MIDI : PLAYER_TYPE_I2C_MIDI;
+    } else if (strcmp(key, "io") == 0) {
+        c->io_type = strcmp(value, "ch423") == 0 ? 1 : 0;
+    } else if (strcmp(key, "channel") == 0) {
+        c->channel = atoi(value);
+    } else if (strcmp(key, "low_note") == 0) {
+        c->low_note = atoi(value);
+    } else if (strcmp(key, "range") == 0) {
+        c->note_range = atoi(value);
+    } else if (strcmp(key, "omni") == 0) {
+        c->omni = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Set a budget, or with apply false only check its name
+static bool parse_budget(const char *key, uint32_t value, bool apply) {
+    uint32_t *budget;
+    if (strcmp(key, "dispatch_us") == 0) {
+        budget = &scenario.budget_dispatch_us;
+    } else if (strcmp(key, "actuation_us") == 0) {
+        budget = &scenario.budget_actuation_us;
+    } else if (strcmp(key, "bus_window_percent") == 0) {
+        budget = &scenario.budget_bus_window_percent;
+    } else if (strcmp(key, "bus_percent") == 0) {
+        budget = &scenario.budget_bus_percent;
+    } else {
+        return false;
+    }
+    if (apply) {
+        *budget = value;
+    }
+    return true;
+}
+
+static bool load_stream(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "latency_test: can't open %s\n", path);
+        return false;
+    }
+
+    scenario.config.player = -1;
+    scenario.config.io_type = -1;
+    scenario.config.low_note = -1;
+    scenario.config.timeline_capacity = LATENCY_TIMELINE_CAPACITY;
+    scenario.budget_dispatch_us = LATENCY_NO_BUDGET;
+    scenario.budget_actuation_us = LATENCY_NO_BUDGET;
+    scenario.budget_bus_window_percent = LATENCY_NO_BUDGET;
+    scenario.budget_bus_percent = LATENCY_NO_BUDGET;
+
+    char line[256];
+    unsigned line_number = 0;
+    bool ok = true;
+    uint32_t last_time = 0;
+
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_number++;
+        char key[32], value[32];
+        unsigned t, b0, b1, b2, b3;
+
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        } else if (sscanf(line, "@config %31s %31s", key, value) >= 1 && strncmp(line, "@config", 7) == 0) {
+            ok = parse_config(key, value);
+        } else if (sscanf(line, "@budget_tile %31s %31s", key, value) == 2) {
+#ifdef OLED_TILE_MODE
+            ok = parse_budget(key, (uint32_t)strtoul(value, NULL, 10), true);
+#else
+            ok = parse_budget(key, 0, false);
+#endif
+        } else if (sscanf(line, "@budget %31s %31s", key, value) == 2) {
+            ok = parse_budget(key, (uint32_t)strtoul(value, NULL, 10), true);
+        } else if (sscanf(line, "@idle_ms %u", &t) == 1) {
+            scenario.idle_ms = t;
+        } else if (sscanf(line, "%u %x %x %x %x", &t, &b0, &b1, &b2, &b3) == 5 &&
+                   scenario.packet_count < LATENCY_MAX_PACKETS && t >= last_time) {
+            stream_packet_t *p = &scenario.packets[scenario.packet_count++];
+            p->time_us = t;
+            p->packet[0] = (uint8_t)b0;
+            p->packet[1] = (uint8_t)b1;
+            p->packet[2] = (uint8_t)b2;
+            p->packet[3] = (uint8_t)b3;
+            last_time = t;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "%s:%u: can't parse: %s", path, line_number, line);
+        }
+    }
+    fclose(f);
+    return ok && scenario.packet_count > 0;
+}
+
+//--------------------------------------------------------------------+
+// Measurement
+//--------------------------------------------------------------------+
+
+static void on_dispatch(const firmware_harness_event_t *event, uint64_t now_us, void *user_data) {
+    (void)event;
+    (void)user_data;
+    if (scenario.dispatched < scenario.event_count) {
+        scenario.events[scenario.dispatched++].dispatch_us = now_us;
+    }
+}
+
+static void on_change(const firmware_harness_change_t *change, void *user_data) {
+    (void)user_data;
+    scenario.changes++;
+    if (change->event && scenario.dispatched > 0) {
+        event_record_t *e = &scenario.events[scenario.dispatched - 1];
+        if (e->first_change_us == 0) {
+            e->first_change_us = change->time_us;
+        }
+    }
+}
+
+static bool is_tracked(const uint8_t packet[4]) {
+    uint8_t cin = packet[0] & 0x0F;
+    return (cin >= 0x08 && cin <= 0x0E) || (cin >= 0x05 && cin <= 0x07);
+}
+
+/**
+ * Feed the stream as the host's USB stack would: every packet that is due
+ * is queued before the next pass of the main loop
+ */
+static bool replay(uint64_t origin_us) {
+    size_t next = 0;
+    while (next < scenario.packet_count) {
+        while (next < scenario.packet_count && origin_us + scenario.packets[next].time_us <= hal_host_time_us()) {
+            const stream_packet_t *p = &scenario.packets[next];
+            uint64_t intended_us = origin_us + p->time_us;
+            if (!firmware_harness_push_packet(p->packet, intended_us)) {
+                break;  // USB queue full - firmware has fallen behind
+            }
+            if (is_tracked(p->packet)) {
+                event_record_t *e = &scenario.events[scenario.event_count++];
+                e->intended_us = intended_us;
+                e->status = (p->packet[0] & 0x0F) >= 0x08 ? p->packet[1] : 0xF0;
+                e->data1 = p->packet[2];
+                e->data2 = p->packet[3];
+            }
+            next++;
+        }
+        firmware_harness_poll();
+    }
+
+    firmware_harness_run_until(hal_host_time_us() + LATENCY_TAIL_US);
+    return true;
+}
+
+/**
+ * Peak bus occupancy over fixed windows from the start of the stream
+ */
+static uint32_t peak_window_percent(uint64_t origin_us, uint64_t end_us, bool *complete) {
+    size_t count = 0;
+    const i2c_sim_event_t *timeline = i2c_sim_get_timeline(&count);
+    size_t windows = (size_t)((end_us - origin_us) / LATENCY_WINDOW_US) + 1;
+    uint64_t *busy_ns = calloc(windows, sizeof(uint64_t));
+    if (!busy_ns) {
+        *complete = false;
+        return 0;
+    }
+
+    uint64_t recorded_ns = 0;
+    for (size_t i = 0; i < count; i++) {
+        const i2c_sim_event_t *e = &timeline[i];
+        recorded_ns += e->wire_time_ns;
+        if (e->timestamp_us < origin_us) {
+            continue;
+        }
+        uint64_t start_ns = (e->timestamp_us - origin_us) * 1000;
+        uint64_t end_ns = start_ns + e->wire_time_ns;
+        while (start_ns < end_ns) {
+            size_t w = (size_t)(start_ns / (LATENCY_WINDOW_US * 1000ull));
+            if (w >= windows) {
+                break;
+            }
+            uint64_t window_end = (w + 1) * LATENCY_WINDOW_US * 1000ull;
+            uint64_t slice = (end_ns < window_end ? end_ns : window_end) - start_ns;
+            busy_ns[w] += slice;
+            start_ns += slice;
+        }
+    }
+
+    uint64_t peak = 0;
+    for (size_t w = 0; w < windows; w++) {
+        if (busy_ns[w] > peak) {
+            peak = busy_ns[w];
+        }
+    }
+    free(busy_ns);
+
+    // A full timeline drops transfers; the occupancy would be understated
+    *complete = recorded_ns == i2c_sim_get_bus_time_ns(FIRMWARE_HARNESS_BUS);
+    return (uint32_t)(peak * 100 / (LATENCY_WINDOW_US * 1000ull));
+}
+
+//--------------------------------------------------------------------+
+// Budget Checks
+//--------------------------------------------------------------------+
+
+static void describe(const event_record_t *e, uint64_t origin_us, char *buf, size_t size) {
+    if (e->status == 0xF0) {
+        snprintf(buf, size, "SysEx at %llu us", (unsigned long long)(e->intended_us - origin_us));
+    } else {
+        snprintf(buf, size, "%02X %02X %02X at %llu us", e->status, e->data1, e->data2,
+                 (unsigned long long)(e->intended_us - origin_us));
+    }
+}
+
+static int check_latency(const char *what, uint32_t budget_us, bool actuation, uint64_t origin_us,
+                         uint64_t *max_out) {
+    int failures = 0;
+    uint64_t max_us = 0;
+
+    for (size_t i = 0; i < scenario.event_count; i++) {
+        const event_record_t *e = &scenario.events[i];
+        char desc[64];
+        describe(e, origin_us, desc, sizeof(desc));
+
+        if (e->dispatch_us == 0) {
+            if (!actuation && failures++ < LATENCY_MAX_REPORTED) {
+                printf("FAIL %s: %s was never picked up\n", scenario.name, desc);
+            }
+            continue;
+        }
+
+        uint64_t at = actuation ? e->first_change_us : e->dispatch_us;
+        if (at == 0) {
+            continue;  // Nothing to actuate (note off for a released pin, SysEx, out of range)
+        }
+        uint64_t latency = at > e->intended_us ? at - e->intended_us : 0;
+        if (latency > max_us) {
+            max_us = latency;
+        }
+        if (latency > budget_us) {
+            if (failures < LATENCY_MAX_REPORTED) {
+                printf("FAIL %s: %s %s %llu us > budget %u us\n", scenario.name, desc, what,
+                       (unsigned long long)latency, budget_us);
+            }
+            failures++;
+        }
+    }
+    *max_out = max_us;
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s stream.txt\n", argv[0]);
+        return 2;
+    }
+
+    scenario.name = strrchr(argv[1], '/') ? strrchr(argv[1], '/') + 1 : argv[1];
+    if (!load_stream(argv[1])) {
+        return 2;
+    }
+
+    firmware_harness_set_dispatch_callback(on_dispatch, NULL);
+    firmware_harness_set_change_callback(on_change, NULL);
+    if (!firmware_harness_start(&scenario.config)) {
+        return 1;
+    }
+
+    if (scenario.idle_ms) {
+        firmware_harness_run_until(hal_host_time_us() + (uint64_t)scenario.idle_ms * 1000);
+    }
+
+    // Bus figures cover the stream only
+    i2c_sim_clear();
+    uint64_t origin_us = hal_host_time_us() + LATENCY_LEAD_IN_US;
+    replay(origin_us);
+    uint64_t end_us = hal_host_time_us();
+
+    int failures = 0;
+    uint64_t dispatch_max = 0, actuation_max = 0;
+    failures += check_latency("dispatch", scenario.budget_dispatch_us, false, origin_us, &dispatch_max);
+    failures += check_latency("actuation", scenario.budget_actuation_us, true, origin_us, &actuation_max);
+
+    bool complete = true;
+    uint32_t window_percent = peak_window_percent(origin_us, end_us, &complete);
+    uint32_t bus_percent = (uint32_t)(i2c_sim_get_bus_time_ns(FIRMWARE_HARNESS_BUS) / 10 /
+                                      (end_us - origin_us + LATENCY_LEAD_IN_US));
+    if (!complete) {
+        printf("FAIL %s: bus timeline full, window occupancy not measured\n", scenario.name);
+        failures++;
+    }
+    if (window_percent > scenario.budget_bus_window_percent) {
+        printf("FAIL %s: bus busy %u%% in a %u ms window > budget %u%%\n", scenario.name,
+               window_percent, LATENCY_WINDOW_US / 1000, scenario.budget_bus_window_percent);
+        failures++;
+    }
+    if (bus_percent > scenario.budget_bus_percent) {
+        printf("FAIL %s: bus busy %u%% overall > budget %u%%\n", scenario.name,
+               bus_percent, scenario.budget_bus_percent);
+        failures++;
+    }
+
+    printf("%s: %zu messages, %u actuator changes, dispatch max %llu us, actuation max %llu us, "
+           "bus peak %u%% / %u ms, overall %u%%\n",
+           scenario.name, scenario.event_count, scenario.changes,
+           (unsigned long long)dispatch_max, (unsigned long long)actuation_max,
+           window_percent, LATENCY_WINDOW_US / 1000, bus_percent);
+
+    firmware_harness_stop();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * OLED in-flight flush test (host build)
+ *
+ * Boots the firmware (see sim/firmware_harness.h), then drives the OLED
+ * library directly with a small flush budget, so every frame goes out over
+ * several oled_flush_step() calls. While a frame is in flight the test
+ * clears the screen, draws another one or restarts the animation behind
+ * it; the panel must still end up with exactly the frame that was
+ * committed, and then with the next one. In tile mode this checks that
+ * pages rendered during the flush only use what was committed.
+ *
+ *   oled_flush_test
+ */
+
+#include "firmware_harness.h"
+#include "hal_host.h"
+#include "oled_display.h"
+#include "lissajous_screensaver.h"
+#include <stdio.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define FLUSH_TEST_STEP_BYTES   8   // Flush budget: one minimum chunk per step
+#define FLUSH_TEST_ROLL_LANES   8
+
+//--------------------------------------------------------------------+
+// Frame Checks
+//--------------------------------------------------------------------+
+
+typedef struct {
+    uint8_t pages[SSD1306_MODEL_PAGES][SSD1306_MODEL_WIDTH];
+    uint8_t start_line;
+} committed_frame_t;
+
+static int errors;
+
+static void fail(const char *scenario, const char *what) {
+    printf("  %s: %s\n", scenario, what);
+    errors++;
+}
+
+// The frame oled_display() last committed
+static void capture_committed(committed_frame_t *frame) {
+    for (uint8_t page = 0; page < SSD1306_MODEL_PAGES; page++) {
+        memcpy(frame->pages[page], oled_get_frame_page(page), SSD1306_MODEL_WIDTH);
+    }
+    frame->start_line = oled_get_frame_start_line();
+}
+
+static void check_panel(const char *scenario, const char *when, const ssd1306_model_t *oled,
+                        const committed_frame_t *frame) {
+    for (uint8_t page = 0; page < SSD1306_MODEL_PAGES; page++) {
+        for (uint8_t x = 0; x < SSD1306_MODEL_WIDTH; x++) {
+            if (oled->gddram[page][x] != frame->pages[page][x]) {
+                printf("  %s: %s: page %u column %u is 0x%02X, committed 0x%02X\n", scenario, when,
+                       page, x, oled->gddram[page][x], frame->pages[page][x]);
+                errors++;
+                return;
+            }
+        }
+    }
+    if (oled->start_line != frame->start_line) {
+        printf("  %s: %s: start line %u, committed %u\n", scenario, when, oled->start_line,
+               frame->start_line);
+        errors++;
+    }
+}
+
+/**
+ * Commit a frame with draw(), send part of it and call interrupt(). The
+ * panel must get the committed frame, or if interrupt() commits one of
+ * its own (commits), that one once both have gone out.
+ */
+static void run_scenario(const char *scenario, const ssd1306_model_t *oled, void (*draw)(void),
+                         void (*interrupt)(void), bool commits) {
+    committed_frame_t committed;
+
+    draw();
+    capture_committed(&committed);
+    oled_flush_step();
+    if (oled_flush_idle()) {
+        fail(scenario, "frame went out in one step, nothing in flight");
+        return;
+    }
+
+    interrupt();
+    while (!oled_flush_step()) {
+    }
+    if (!commits) {
+        check_panel(scenario, "frame in flight", oled, &committed);
+        return;
+    }
+    capture_committed(&committed);
+    check_panel(scenario, "next frame", oled, &committed);
+}
+
+//--------------------------------------------------------------------+
+// Scenarios
+//--------------------------------------------------------------------+
+
+// Light the whole panel, so the next frame changes every page
+static void fill_screen(void) {
+    oled_clear();
+    oled_fill_rect(0, 0, OLED_WIDTH, OLED_HEIGHT, 1);
+    oled_display();
+    oled_display_flush();
+}
+
+static void roll_start(void) {
+    fill_screen();
+    oled_piano_roll_begin(FLUSH_TEST_ROLL_LANES);
+}
+
+static void roll_tick(void) {
+    oled_piano_roll_tick(0x00FF);
+}
+
+// Another screen drawn over the roll, not committed yet
+static void draw_other_screen(void) {
+    oled_clear();
+    oled_draw_border();
+    oled_draw_string(10, 20, "INTERRUPTED");
+}
+
+static void redraw_other_screen(void) {
+    draw_other_screen();
+    oled_display();
+}
+
+static void balls_start(void) {
+    fill_screen();
+    oled_screensaver_init();
+    oled_screensaver_update();
+}
+
+static void lissajous_start(void) {
+    fill_screen();
+    lissajous_screensaver_init();
+    lissajous_screensaver_update();
+}
+
+// New curve parameters and a blank screen, not committed yet
+static void lissajous_restart(void) {
+    lissajous_screensaver_init();
+    oled_clear();
+}
+
+int main(void) {
+    if (!firmware_harness_start(NULL)) {
+        fprintf(stderr, "oled_flush_test: firmware did not start\n");
+        return 1;
+    }
+    const ssd1306_model_t *oled = &firmware_harness_get_models()->oled;
+
+    // The main loop is never polled, so nothing else touches the display
+    oled_display_flush();
+    oled_set_flush_budget(FLUSH_TEST_STEP_BYTES, 0);
+
+    run_scenario("roll_clear", oled, roll_start, oled_clear, false);
+    run_scenario("roll_other_screen", oled, roll_start, draw_other_screen, false);
+    run_scenario("roll_redraw", oled, roll_start, redraw_other_screen, true);
+    run_scenario("roll_tick", oled, roll_start, roll_tick, true);
+    run_scenario("balls_init", oled, balls_start, oled_screensaver_init, false);
+    run_scenario("balls_update", oled, balls_start, oled_screensaver_update, true);
+    run_scenario("lissajous_restart", oled, lissajous_start, lissajous_restart, false);
+    run_scenario("lissajous_update", oled, lissajous_start, lissajous_screensaver_update, true);
+
+    firmware_harness_stop();
+
+    if (errors) {
+        printf("FAIL: %d errors\n", errors);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
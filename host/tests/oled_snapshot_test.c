@@ -0,0 +1,430 @@
+/**
+ * OLED snapshot test (host build)
+ *
+ * Boots the firmware (see sim/firmware_harness.h), renders every screen
+ * through the real display code and compares what reached the SSD1306
+ * model's GDDRAM with a golden PGM image. For each screen it also reports
+ * the host render time and the bytes, transfers and bus time one frame
+ * costs on the I2C bus.
+ *
+ *   oled_snapshot_test GOLDEN_DIR              compare
+ *   oled_snapshot_test --update GOLDEN_DIR     rewrite the golden images
+ *
+ * Golden images are plain PGM (P2, maxval 1) in GDDRAM layout: row 0 is
+ * the top of page 0, before segment remap and COM scan direction.
+ */
+
+#include "firmware_harness.h"
+#include "hal_host.h"
+#include "i2c_sim.h"
+#include "oled_display.h"
+#include "lissajous_screensaver.h"
+#include "display_handler.h"
+#include "menu_handler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define SNAPSHOT_DEFAULT_RUNS      20   // Timed renders per screen
+#define SNAPSHOT_SCREENSAVER_FRAME 20   // Frame the screensavers are captured at
+#define SNAPSHOT_PIANO_ROLL_TICKS  90   // Ticks played into the piano roll (wraps the 64 rows)
+#define SNAPSHOT_MAX_REPORTED      5    // Mismatching pixels printed per screen
+#define SNAPSHOT_PATH_MAX          512
+
+//--------------------------------------------------------------------+
+// Screens
+//--------------------------------------------------------------------+
+
+/**
+ * A screen to capture
+ *
+ * prepare() runs once before the first render, setup() and teardown()
+ * around every render; only render() is timed and counted.
+ */
+typedef struct {
+    const char *name;
+    void (*prepare)(void);
+    void (*setup)(void);
+    void (*render)(void);
+    void (*teardown)(void);
+} screen_t;
+
+static void render_home(void) {
+    display_handler_show_home();
+}
+
+static void render_single_note(void) {
+    oled_display_single_note(61, 100, 9);
+}
+
+static void render_midi_notes(void) {
+    static const midi_note_info_t notes[] = {
+        { 60, 100, 0, true },
+        { 64, 90, 0, true },
+        { 67, 80, 9, false },
+        { 72, 127, 9, true },
+        { 21, 1, 15, true },
+    };
+    oled_display_midi_notes(notes, sizeof(notes) / sizeof(notes[0]));
+}
+
+static void render_midi_notes_empty(void) {
+    oled_display_midi_notes(NULL, 0);
+}
+
+static void render_channel_activity(void) {
+    static const uint8_t activity[16] = {
+        127, 0, 64, 100, 10, 0, 0, 127, 90, 20, 0, 50, 0, 0, 127, 1
+    };
+    oled_display_channel_activity(activity);
+}
+
+// Menu pages: the menu is entered once and walked to the option
+static menu_option_t menu_target;
+
+static void goto_menu_option(void) {
+    if (!menu_is_active()) {
+        menu_enter();
+    }
+    while (menu_get_current() != menu_target) {
+        menu_next();
+    }
+}
+
+// Menu pages are captured after one short press from the option before,
+// so their cost is that of a click
+static void goto_option_before(void) {
+    menu_option_t target = menu_target;
+    menu_target = (menu_option_t)((target + MENU_OPTION_COUNT - 1) % MENU_OPTION_COUNT);
+    goto_menu_option();
+    menu_target = target;
+}
+
+#define MENU_PAGE(option, label)                                    \
+    static void prepare_menu_##label(void) { menu_target = option; }
+
+MENU_PAGE(MENU_OPTION_RESET_DEFAULTS, reset)
+MENU_PAGE(MENU_OPTION_SAVE_CONFIG, save)
+MENU_PAGE(MENU_OPTION_PLAYER_TYPE, player)
+MENU_PAGE(MENU_OPTION_MIDI_CHANNEL, channel)
+MENU_PAGE(MENU_OPTION_NOTE_RANGE, range)
+MENU_PAGE(MENU_OPTION_SEMITONE_MODE, semitone)
+MENU_PAGE(MENU_OPTION_NOTE_VIEW, note_view)
+MENU_PAGE(MENU_OPTION_VIEW_SETTINGS, settings)
+MENU_PAGE(MENU_OPTION_ALL_NOTES_OFF, notes_off)
+MENU_PAGE(MENU_OPTION_EXIT, exit)
+
+// Settings view: entered with a long press on "View Settings", scrolled
+// with a short press and left with another long press
+static void enter_settings(void) {
+    menu_target = MENU_OPTION_VIEW_SETTINGS;
+    goto_menu_option();
+    menu_execute();
+}
+
+static void prepare_settings(void) {
+    menu_target = MENU_OPTION_VIEW_SETTINGS;
+}
+
+static void leave_settings(void) {
+    menu_execute();
+}
+
+// Screensavers are captured a fixed number of frames in
+static void prepare_balls(void) {
+    menu_exit();
+    oled_screensaver_init();
+    for (int i = 1; i < SNAPSHOT_SCREENSAVER_FRAME; i++) {
+        oled_screensaver_update();
+    }
+}
+
+static void prepare_lissajous(void) {
+    lissajous_screensaver_init();
+    for (int i = 1; i < SNAPSHOT_SCREENSAVER_FRAME; i++) {
+        lissajous_screensaver_update();
+    }
+}
+
+// Piano roll: a rising line of short notes over a held three-note chord
+// that changes every 16 ticks; the capture is in RAM layout, scrolled by
+// the start line on the panel
+static uint32_t piano_roll_tick_count;
+
+static uint16_t piano_roll_lanes(uint32_t tick) {
+    uint16_t lanes = (tick % 3 != 2) ? (1u << ((tick / 3) % 16)) : 0;
+    uint32_t root = (tick / 16) % 4;
+    if (tick % 16 < 12) {
+        lanes |= (1u << root) | (1u << (root + 4)) | (1u << (root + 7));
+    }
+    return lanes;
+}
+
+static void render_piano_roll_tick(void) {
+    oled_piano_roll_tick(piano_roll_lanes(piano_roll_tick_count++));
+}
+
+static void prepare_piano_roll(void) {
+    oled_piano_roll_begin(OLED_PIANO_ROLL_MAX_LANES);
+    for (piano_roll_tick_count = 0; piano_roll_tick_count < SNAPSHOT_PIANO_ROLL_TICKS; ) {
+        render_piano_roll_tick();
+    }
+}
+
+static const screen_t screens[] = {
+    { "home",               NULL,                   NULL,              render_home,             NULL },
+    { "single_note",        NULL,                   NULL,              render_single_note,      NULL },
+    { "midi_notes",         NULL,                   NULL,              render_midi_notes,       NULL },
+    { "midi_notes_empty",   NULL,                   NULL,              render_midi_notes_empty, NULL },
+    { "channel_activity",   NULL,                   NULL,              render_channel_activity, NULL },
+    { "menu_reset",         prepare_menu_reset,     goto_option_before, menu_next,              NULL },
+    { "menu_save",          prepare_menu_save,      goto_option_before, menu_next,              NULL },
+    { "menu_player",        prepare_menu_player,    goto_option_before, menu_next,              NULL },
+    { "menu_channel",       prepare_menu_channel,   goto_option_before, menu_next,              NULL },
+    { "menu_range",         prepare_menu_range,     goto_option_before, menu_next,              NULL },
+    { "menu_semitone",      prepare_menu_semitone,  goto_option_before, menu_next,              NULL },
+    { "menu_note_view",     prepare_menu_note_view, goto_option_before, menu_next,              NULL },
+    { "menu_settings",      prepare_menu_settings,  goto_option_before, menu_next,              NULL },
+    { "menu_notes_off",     prepare_menu_notes_off, goto_option_before, menu_next,              NULL },
+    { "menu_exit",          prepare_menu_exit,      goto_option_before, menu_next,              NULL },
+    { "settings",           prepare_settings,       goto_menu_option,  menu_execute,            leave_settings },
+    { "settings_scrolled",  NULL,                   enter_settings,    menu_next,               leave_settings },
+    { "screensaver_balls",  prepare_balls,          NULL,              oled_screensaver_update, NULL },
+    { "screensaver_lissajous", prepare_lissajous,   NULL,              lissajous_screensaver_update, NULL },
+    { "piano_roll",         prepare_piano_roll,     NULL,              render_piano_roll_tick,  NULL },
+};
+
+#define SCREEN_COUNT (sizeof(screens) / sizeof(screens[0]))
+
+//--------------------------------------------------------------------+
+// Golden Images
+//--------------------------------------------------------------------+
+
+typedef uint8_t frame_t[SSD1306_MODEL_HEIGHT][SSD1306_MODEL_WIDTH];
+
+static void capture(const ssd1306_model_t *oled, frame_t frame) {
+    for (uint8_t y = 0; y < SSD1306_MODEL_HEIGHT; y++) {
+        for (uint8_t x = 0; x < SSD1306_MODEL_WIDTH; x++) {
+            frame[y][x] = ssd1306_model_get_pixel(oled, x, y);
+        }
+    }
+}
+
+static bool write_pgm(const char *path, frame_t frame) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "P2\n%d %d\n1\n", SSD1306_MODEL_WIDTH, SSD1306_MODEL_HEIGHT);
+    for (int y = 0; y < SSD1306_MODEL_HEIGHT; y++) {
+        for (int x = 0; x < SSD1306_MODEL_WIDTH; x++) {
+            fputc(frame[y][x] ? '1' : '0', f);
+            fputc(x == SSD1306_MODEL_WIDTH - 1 ? '\n' : ' ', f);
+        }
+    }
+    return fclose(f) == 0;
+}
+
+static bool read_pgm(const char *path, frame_t frame) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    int width, height, maxval;
+    bool ok = fscanf(f, "P2 %d %d %d", &width, &height, &maxval) == 3 &&
+              width == SSD1306_MODEL_WIDTH && height == SSD1306_MODEL_HEIGHT && maxval > 0;
+    for (int y = 0; ok && y < height; y++) {
+        for (int x = 0; ok && x < width; x++) {
+            int value;
+            ok = fscanf(f, "%d", &value) == 1;
+            frame[y][x] = value > maxval / 2;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+//--------------------------------------------------------------------+
+// Test Runner
+//--------------------------------------------------------------------+
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;            // Address byte + payload
+    uint64_t wire_time_ns;
+    uint64_t host_ns;          // Median render time
+} frame_cost_t;
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Render a screen `runs` times, capturing the first frame and its bus cost
+ */
+static void run_screen(const screen_t *s, ssd1306_model_t *oled, int runs, frame_t frame, frame_cost_t *cost) {
+    uint64_t *times = calloc((size_t)runs, sizeof(uint64_t));
+
+    if (s->prepare) {
+        s->prepare();
+    }
+    for (int run = 0; run < runs; run++) {
+        if (s->setup) {
+            s->setup();
+        }
+        oled_display_flush();   // Whatever setup drew is not part of the frame
+        i2c_sim_clear();
+
+        // The firmware streams frames out over main loop passes; send it all
+        uint64_t start = wall_ns();
+        s->render();
+        oled_display_flush();
+        times[run] = wall_ns() - start;
+
+        if (run == 0) {
+            capture(oled, frame);
+            cost->transactions = oled->base.stats.transactions;
+            cost->bytes = oled->base.stats.bytes + oled->base.stats.transactions;
+            cost->wire_time_ns = oled->base.stats.wire_time_ns;
+        }
+        if (s->teardown) {
+            s->teardown();
+        }
+    }
+
+    qsort(times, (size_t)runs, sizeof(uint64_t), compare_u64);
+    cost->host_ns = times[runs / 2];
+    free(times);
+}
+
+/**
+ * Compare a frame against its golden image
+ *
+ * @return Number of differing pixels, -1 if the golden image can't be read
+ */
+static int compare_golden(const char *path, const char *name, frame_t frame) {
+    frame_t golden;
+    if (!read_pgm(path, golden)) {
+        return -1;
+    }
+
+    int diff = 0;
+    for (int y = 0; y < SSD1306_MODEL_HEIGHT; y++) {
+        for (int x = 0; x < SSD1306_MODEL_WIDTH; x++) {
+            if (frame[y][x] != golden[y][x]) {
+                if (diff < SNAPSHOT_MAX_REPORTED) {
+                    printf("  %s: pixel (%d,%d) is %d, golden %d\n", name, x, y, frame[y][x], golden[y][x]);
+                }
+                diff++;
+            }
+        }
+    }
+    return diff;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+        "usage: %s [options] GOLDEN_DIR\n"
+        "  --update         rewrite the golden images\n"
+        "  --actual DIR     write every rendered frame to DIR\n"
+        "  --runs N         timed renders per screen (default %d)\n"
+        "  --filter TEXT    only screens whose name contains TEXT\n",
+        argv0, SNAPSHOT_DEFAULT_RUNS);
+}
+
+int main(int argc, char **argv) {
+    const char *golden_dir = NULL;
+    const char *actual_dir = NULL;
+    const char *filter = NULL;
+    bool update = false;
+    int runs = SNAPSHOT_DEFAULT_RUNS;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(arg, "--update") == 0) {
+            update = true;
+        } else if (strcmp(arg, "--actual") == 0 && has_value) {
+            actual_dir = argv[++i];
+        } else if (strcmp(arg, "--runs") == 0 && has_value) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(arg, "--filter") == 0 && has_value) {
+            filter = argv[++i];
+        } else if (arg[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            golden_dir = arg;
+        }
+    }
+    if (!golden_dir || runs < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (!firmware_harness_start(NULL)) {
+        fprintf(stderr, "oled_snapshot_test: firmware failed to boot\n");
+        return 1;
+    }
+    ssd1306_model_t *oled = &firmware_harness_get_models()->oled;
+
+    printf("%-22s %10s %6s %7s %10s  %s\n", "screen", "host us", "xfers", "bytes", "bus us", "result");
+
+    int failures = 0;
+    for (size_t i = 0; i < SCREEN_COUNT; i++) {
+        const screen_t *s = &screens[i];
+        if (filter && !strstr(s->name, filter)) {
+            continue;
+        }
+
+        frame_t frame;
+        frame_cost_t cost;
+        run_screen(s, oled, runs, frame, &cost);
+
+        char path[SNAPSHOT_PATH_MAX];
+        if (actual_dir) {
+            snprintf(path, sizeof(path), "%s/%s.pgm", actual_dir, s->name);
+            write_pgm(path, frame);
+        }
+
+        snprintf(path, sizeof(path), "%s/%s.pgm", golden_dir, s->name);
+        const char *result;
+        if (update) {
+            result = write_pgm(path, frame) ? "updated" : "WRITE FAILED";
+        } else {
+            int diff = compare_golden(path, s->name, frame);
+            result = diff == 0 ? "ok" : diff < 0 ? "NO GOLDEN" : "MISMATCH";
+            if (diff != 0) {
+                failures++;
+            }
+            if (diff > 0) {
+                printf("  %s: %d pixels differ\n", s->name, diff);
+            }
+        }
+
+        printf("%-22s %10.1f %6u %7u %10.1f  %s\n", s->name, cost.host_ns / 1000.0,
+               cost.transactions, cost.bytes, cost.wire_time_ns / 1000.0, result);
+    }
+
+    firmware_harness_stop();
+
+    if (failures) {
+        printf("FAIL: %d screens differ from %s\n", failures, golden_dir);
+        return 1;
+    }
+    return 0;
+}
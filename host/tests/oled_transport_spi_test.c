@@ -0,0 +1,214 @@
+/**
+ * OLED SPI transport test (host build)
+ *
+ * Runs lib/oled_display/oled_transport_spi.c on the shim's SPI and DMA
+ * (see hal/include/hal_host.h) and checks what reaches the bus: the
+ * control byte becomes the D/C# level and is not sent, commands and data
+ * spans under OLED_SPI_DMA_MIN bytes are written by the CPU, longer data
+ * spans by DMA, and D/C# only changes once the transfer before it is out.
+ *
+ *   oled_transport_spi_test
+ */
+
+#include "hal_host.h"
+#include "oled_display.h"
+#include "oled_transport.h"
+#include "hardware/spi.h"
+#include <stdio.h>
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Configuration
+//--------------------------------------------------------------------+
+
+#define SPI_TEST_DMA_MIN    16      // OLED_SPI_DMA_MIN in oled_transport_spi.c
+#define SPI_TEST_MAX_EVENTS 32
+#define SPI_TEST_MAX_BYTES  (OLED_WIDTH + 1)
+
+//--------------------------------------------------------------------+
+// Bus Log
+//--------------------------------------------------------------------+
+
+// A D/C# change, or a write with the D/C# level it went out with
+typedef struct {
+    bool write;
+    bool dc;
+    bool dma;
+    uint8_t bus;
+    size_t len;
+    uint8_t data[SPI_TEST_MAX_BYTES];
+} bus_event_t;
+
+static bus_event_t events[SPI_TEST_MAX_EVENTS];
+static size_t event_count;
+static int errors;
+
+static void fail(const char *step, const char *what) {
+    printf("  %s: %s\n", step, what);
+    errors++;
+}
+
+static bus_event_t* add_event(void) {
+    if (event_count == SPI_TEST_MAX_EVENTS) {
+        return NULL;
+    }
+    bus_event_t *e = &events[event_count++];
+    memset(e, 0, sizeof(*e));
+    return e;
+}
+
+static void on_spi_write(uint8_t bus, const uint8_t *data, size_t len, bool dma, void *user_data) {
+    (void)user_data;
+    bus_event_t *e = add_event();
+    if (!e) {
+        return;
+    }
+    e->write = true;
+    e->bus = bus;
+    e->dma = dma;
+    e->dc = hal_host_gpio_get_output(OLED_SPI_DC_PIN);
+    e->len = len;
+    memcpy(e->data, data, len < sizeof(e->data) ? len : sizeof(e->data));
+}
+
+static void on_gpio(uint pin, bool level, void *user_data) {
+    (void)user_data;
+    if (pin != OLED_SPI_DC_PIN) {
+        return;
+    }
+    bus_event_t *e = add_event();
+    if (e) {
+        e->dc = level;
+    }
+}
+
+//--------------------------------------------------------------------+
+// Checks
+//--------------------------------------------------------------------+
+
+// A transfer: control byte, then len bytes counting up from first
+static size_t make_transfer(uint8_t *buf, uint8_t control, size_t len, uint8_t first) {
+    buf[0] = control;
+    for (size_t i = 0; i < len; i++) {
+        buf[1 + i] = (uint8_t)(first + i);
+    }
+    return len + 1;
+}
+
+/**
+ * Check the log against the expected events and clear it
+ */
+static void expect(const char *step, const bus_event_t *expected, size_t count) {
+    if (event_count != count) {
+        printf("  %s: %zu bus events, expected %zu\n", step, event_count, count);
+        errors++;
+    }
+    for (size_t i = 0; i < count && i < event_count; i++) {
+        const bus_event_t *e = &events[i];
+        const bus_event_t *x = &expected[i];
+        if (e->write != x->write || e->dc != x->dc) {
+            printf("  %s: event %zu is %s with D/C# %d, expected %s with D/C# %d\n", step, i,
+                   e->write ? "a write" : "a D/C# change", e->dc,
+                   x->write ? "a write" : "a D/C# change", x->dc);
+            errors++;
+        } else if (e->write && (e->bus != 1 || e->dma != x->dma || e->len != x->len ||
+                                memcmp(e->data, x->data, x->len) != 0)) {
+            printf("  %s: event %zu wrote %zu bytes (%s, first 0x%02X), expected %zu (%s, first 0x%02X)\n",
+                   step, i, e->len, e->dma ? "DMA" : "CPU", e->data[0], x->len, x->dma ? "DMA" : "CPU",
+                   x->data[0]);
+            errors++;
+        }
+    }
+    event_count = 0;
+}
+
+static bus_event_t dc_change(bool level) {
+    bus_event_t e = { .write = false, .dc = level };
+    return e;
+}
+
+static bus_event_t write_of(const uint8_t *transfer, size_t len, bool dma) {
+    bus_event_t e = { .write = true, .dc = transfer[0] == SSD1306_CONTROL_DATA, .dma = dma, .len = len - 1 };
+    memcpy(e.data, &transfer[1], len - 1);
+    return e;
+}
+
+int main(void) {
+    hal_host_reset();
+    hal_host_spi_set_handler(on_spi_write, NULL);
+
+    if (!oled_transport_init(spi1)) {
+        fail("init", "transport did not start");
+        return 1;
+    }
+    if (hal_host_spi_get_baudrate(1) != OLED_SPI_FREQ || oled_transport_get_speed_hz() != OLED_SPI_FREQ) {
+        fail("init", "SPI not at OLED_SPI_FREQ");
+    }
+    if (hal_host_gpio_get_output(OLED_SPI_CS_PIN) || !hal_host_gpio_get_output(OLED_SPI_RST_PIN) ||
+        hal_host_gpio_get_output(OLED_SPI_DC_PIN)) {
+        fail("init", "CS# not low, RES# not released or D/C# not low");
+    }
+    expect("init", NULL, 0);
+    hal_host_gpio_set_observer(on_gpio, NULL);
+
+    uint8_t command[4];
+    uint8_t short_data[SPI_TEST_DMA_MIN];
+    uint8_t long_data[SPI_TEST_DMA_MIN + 1];
+    uint8_t full_page[OLED_WIDTH + 1];
+    size_t command_len = make_transfer(command, SSD1306_CONTROL_COMMAND, 3, 0xB0);
+    size_t short_len = make_transfer(short_data, SSD1306_CONTROL_DATA, SPI_TEST_DMA_MIN - 1, 0x10);
+    size_t long_len = make_transfer(long_data, SSD1306_CONTROL_DATA, SPI_TEST_DMA_MIN, 0x40);
+    size_t page_len = make_transfer(full_page, SSD1306_CONTROL_DATA, OLED_WIDTH, 0x80);
+
+    // Commands: D/C# stays low, written by the CPU without the control byte
+    oled_transport_send(command, command_len);
+    bus_event_t commands[] = { write_of(command, command_len, false) };
+    expect("command", commands, 1);
+
+    // A span under OLED_SPI_DMA_MIN: D/C# high, then a CPU write
+    oled_transport_send(short_data, short_len);
+    bus_event_t short_span[] = { dc_change(true), write_of(short_data, short_len, false) };
+    expect("short span", short_span, 2);
+
+    // OLED_SPI_DMA_MIN bytes and more go by DMA: still in flight on return
+    oled_transport_send(long_data, long_len);
+    expect("long span started", NULL, 0);
+
+    // The next span waits for it; D/C# is already high
+    oled_transport_send(full_page, page_len);
+    bus_event_t next_span[] = { write_of(long_data, long_len, true) };
+    expect("span after a DMA span", next_span, 1);
+
+    // A command after a DMA span: the span is out before D/C# goes low
+    oled_transport_send(command, command_len);
+    bus_event_t command_after_dma[] = {
+        write_of(full_page, page_len, true), dc_change(false), write_of(command, command_len, false)
+    };
+    expect("command after a DMA span", command_after_dma, 3);
+
+    // Waiting with nothing in flight changes nothing
+    oled_transport_send(long_data, long_len);
+    oled_transport_wait();
+    oled_transport_wait();
+    bus_event_t waited[] = { dc_change(true), write_of(long_data, long_len, true) };
+    expect("wait", waited, 2);
+
+    // A control byte alone sends nothing
+    oled_transport_send(command, 1);
+    expect("empty transfer", NULL, 0);
+
+    // 8 bits per byte, control bytes not counted
+    uint64_t bytes = 2 * (command_len - 1) + (short_len - 1) + 2 * (long_len - 1) + (page_len - 1);
+    if (oled_transport_get_bits() != bytes * 8) {
+        printf("  bits: %llu, expected %llu\n", (unsigned long long)oled_transport_get_bits(),
+               (unsigned long long)(bytes * 8));
+        errors++;
+    }
+
+    if (errors) {
+        printf("FAIL: %d errors\n", errors);
+        return 1;
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,636 @@
+#include "i2c_bus.h"
+#include "i2c_trace.h"
+#include "hardware/gpio.h"
+#ifdef I2C_BUS_USE_PIO
+#include "pio_i2c.h"
+#endif
+#include "pico/time.h"
+#ifdef I2C_BUS_MULTICORE
+#include "pico/mutex.h"
+#include "hardware/sync.h"
+#endif
+#include "../../src/debug_uart.h"
+
+//--------------------------------------------------------------------+
+// Internal State
+//--------------------------------------------------------------------+
+
+/**
+ * Per-controller state
+ */
+typedef struct {
+    bool initialized;
+    uint sda_pin;
+    uint scl_pin;
+    uint32_t default_baudrate;        // Speed for devices without own setting
+    uint32_t current_baudrate;        // Speed the controller is programmed to
+    bool held;                        // Previous transfer ended without STOP
+    i2c_bus_switch_stats_t switch_stats;
+#ifdef I2C_BUS_MULTICORE
+    recursive_mutex_t lock;           // Held by one core from a transfer to its STOP
+    uint8_t lock_depth;               // Transfers the holder is in (held ones included)
+#endif
+} i2c_bus_port_t;
+
+/**
+ * Per-device speed setting and health
+ */
+typedef struct {
+    i2c_inst_t *i2c;
+    uint8_t address;
+    uint32_t baudrate;                // 0 = use the bus default
+    uint8_t pio_bus;                  // I2C_BUS_ROUTE_HW or PIO bus number
+    i2c_bus_device_health_t health;
+    uint32_t retry_at_ms;             // When an isolated device may be tried again
+    bool deferred_nak;                // A write-behind transfer was NAKed, not yet reported
+} i2c_bus_device_t;
+
+static i2c_bus_port_t bus_ports[I2C_BUS_NUM_PORTS];
+static i2c_bus_device_t bus_devices[I2C_BUS_MAX_DEVICES];
+static volatile uint8_t bus_device_count = 0;   // Entries below it are complete
+static i2c_inst_t *bus_roles[I2C_BUS_ROLE_COUNT];
+
+#ifdef I2C_BUS_MULTICORE
+// Entries are only ever added: lookups stay lock-free, adds (from either
+// core, under either controller's lock) take the table lock
+auto_init_mutex(bus_device_table_lock);
+#endif
+
+//--------------------------------------------------------------------+
+// Helpers
+//--------------------------------------------------------------------+
+
+static i2c_bus_port_t* get_port(i2c_inst_t *i2c) {
+    return &bus_ports[i2c_hw_index(i2c)];
+}
+
+static i2c_bus_device_t* find_device(i2c_inst_t *i2c, uint8_t address) {
+    uint8_t count = bus_device_count;
+    for (uint8_t i = 0; i < count; i++) {
+        if (bus_devices[i].i2c == i2c && bus_devices[i].address == address) {
+            return &bus_devices[i];
+        }
+    }
+    return NULL;
+}
+
+static i2c_bus_device_t* find_or_add_device(i2c_inst_t *i2c, uint8_t address) {
+    i2c_bus_device_t *dev = find_device(i2c, address);
+    if (dev) {
+        return dev;
+    }
+
+#ifdef I2C_BUS_MULTICORE
+    mutex_enter_blocking(&bus_device_table_lock);
+    dev = find_device(i2c, address);    // The other core may have added it meanwhile
+#endif
+    if (!dev && bus_device_count < I2C_BUS_MAX_DEVICES) {
+        dev = &bus_devices[bus_device_count];
+        dev->i2c = i2c;
+        dev->address = address;
+#ifdef I2C_BUS_MULTICORE
+        __dmb();                        // Entry complete before lookups can see it
+#endif
+        bus_device_count++;
+    }
+#ifdef I2C_BUS_MULTICORE
+    mutex_exit(&bus_device_table_lock);
+#endif
+    return dev;
+}
+
+/**
+ * Reprogram the controller if the target device needs a different speed
+ */
+static void select_device(i2c_inst_t *i2c, uint8_t address) {
+    i2c_bus_port_t *port = get_port(i2c);
+
+    // Never touch the baud rate while a repeated-start transfer is in progress
+    if (!port->initialized || port->held) {
+        return;
+    }
+
+    i2c_bus_device_t *dev = find_device(i2c, address);
+    uint32_t wanted = (dev && dev->baudrate) ? dev->baudrate : port->default_baudrate;
+    if (wanted == port->current_baudrate) {
+        return;
+    }
+
+    uint32_t start = time_us_32();
+    i2c_set_baudrate(i2c, wanted);
+    uint32_t elapsed = time_us_32() - start;
+
+    port->current_baudrate = wanted;
+    port->switch_stats.switch_count++;
+    port->switch_stats.switch_time_total_us += elapsed;
+    if (elapsed > port->switch_stats.switch_time_max_us) {
+        port->switch_stats.switch_time_max_us = elapsed;
+    }
+}
+
+/**
+ * Take the controller for a transfer (I2C_BUS_MULTICORE: both cores use it)
+ */
+static void lock_port(i2c_inst_t *i2c) {
+#ifdef I2C_BUS_MULTICORE
+    i2c_bus_port_t *port = get_port(i2c);
+    if (port->initialized) {
+        recursive_mutex_enter_blocking(&port->lock);
+        port->lock_depth++;
+    }
+#else
+    (void)i2c;
+#endif
+}
+
+/**
+ * Give the controller back, unless the transfer ended without STOP: the
+ * other core must not start one before the repeated start that follows
+ */
+static void unlock_port(i2c_inst_t *i2c) {
+#ifdef I2C_BUS_MULTICORE
+    i2c_bus_port_t *port = get_port(i2c);
+    if (port->held) {
+        return;
+    }
+    while (port->lock_depth > 0) {
+        port->lock_depth--;
+        recursive_mutex_exit(&port->lock);
+    }
+#else
+    (void)i2c;
+#endif
+}
+
+/**
+ * Timeout for a transfer of len data bytes at the current bus speed
+ */
+static uint32_t transfer_timeout_us(i2c_bus_port_t *port, size_t len) {
+    uint32_t baudrate = port->current_baudrate ? port->current_baudrate : I2C_BUS_SPEED_STANDARD;
+
+    // Address byte + data bytes at 9 clocks each, doubled to allow for clock stretching
+    uint64_t bits = (uint64_t)(len + 1) * 9;
+    return (uint32_t)((bits * 2 * 1000000u) / baudrate) + I2C_BUS_TIMEOUT_MARGIN_US;
+}
+
+/**
+ * Check whether a transfer to the device may go ahead
+ */
+static bool begin_transfer(i2c_inst_t *i2c, uint8_t address, i2c_bus_device_t *dev) {
+    if (dev && dev->health.isolated) {
+        // Isolated: refuse until the retry time, then allow a single attempt
+        int32_t remaining = (int32_t)(dev->retry_at_ms - to_ms_since_boot(get_absolute_time()));
+        if (remaining > 0) {
+            return false;
+        }
+    }
+
+    if (!dev || dev->pio_bus == I2C_BUS_ROUTE_HW) {
+        select_device(i2c, address);
+    }
+    return true;
+}
+
+/**
+ * Hand a finished transfer to the tracer
+ */
+static void trace_transfer(i2c_inst_t *i2c, uint8_t address, size_t len, uint8_t flags,
+                           bool nostop, int result, uint32_t start) {
+    if (nostop) {
+        flags |= I2C_TRACE_FLAG_NOSTOP;
+    }
+    if (result < 0) {
+        flags |= I2C_TRACE_FLAG_ERROR;
+    }
+    i2c_trace_record(i2c_hw_index(i2c), address, len, flags, start, time_us_32() - start);
+}
+
+/**
+ * Update the health counters of a device after a transfer
+ */
+static void record_health(uint8_t address, i2c_bus_device_t *dev, int result) {
+    if (result >= 0) {
+        if (dev) {
+            if (dev->health.isolated) {
+                debug_info("I2C_BUS: Device 0x%02X responding again", address);
+            }
+            dev->health.consecutive_failures = 0;
+            dev->health.isolated = false;
+        }
+        return;
+    }
+
+    if (!dev) {
+        return;
+    }
+
+    if (result == PICO_ERROR_TIMEOUT) {
+        dev->health.timeout_count++;
+        dev->health.recovery_count++;
+    } else {
+        dev->health.nak_count++;
+    }
+
+    if (dev->health.consecutive_failures < UINT8_MAX) {
+        dev->health.consecutive_failures++;
+    }
+
+    if (dev->health.consecutive_failures >= I2C_BUS_ISOLATE_THRESHOLD) {
+        if (!dev->health.isolated) {
+            debug_error("I2C_BUS: Device 0x%02X isolated after %d failures",
+                        address, dev->health.consecutive_failures);
+        }
+        dev->health.isolated = true;
+        dev->retry_at_ms = to_ms_since_boot(get_absolute_time()) + I2C_BUS_ISOLATE_RETRY_MS;
+    }
+}
+
+/**
+ * Finish a hardware transfer: recover the bus on timeout and update health
+ */
+static void end_transfer(i2c_inst_t *i2c, uint8_t address, i2c_bus_device_t *dev, int result, bool nostop) {
+    get_port(i2c)->held = nostop && result >= 0;
+
+    if (result == PICO_ERROR_TIMEOUT) {
+        debug_error("I2C_BUS: Timeout on device 0x%02X, recovering bus", address);
+        i2c_bus_recover(i2c);
+    }
+
+    record_health(address, dev, result);
+}
+
+#ifdef I2C_BUS_USE_PIO
+/**
+ * Wait for the write-behind transfer in flight on a PIO bus and credit its
+ * outcome to the device it belonged to. A NAK is kept for that device's
+ * next transfer or i2c_bus_flush().
+ *
+ * @return 0, or PICO_ERROR_TIMEOUT if the transfer never finished
+ */
+static int settle_pio_bus(i2c_inst_t *i2c, uint8_t bus) {
+    int result = pio_i2c_flush(bus);
+
+    uint8_t done_address;
+    bool acked;
+    if (pio_i2c_take_completed(bus, &done_address, &acked)) {
+        i2c_bus_device_t *done = find_device(i2c, done_address);
+        record_health(done_address, done, acked ? 0 : PICO_ERROR_GENERIC);
+        if (done && !acked) {
+            done->deferred_nak = true;
+        }
+    }
+    return result == PICO_ERROR_TIMEOUT ? result : 0;
+}
+
+/**
+ * Transfer on a PIO bus (a read if dst is given, else a write). Writes are
+ * write-behind: the call returns once the write is queued. The previous
+ * write on the bus is settled first - the bus would wait for it anyway -
+ * so a NAK on the last write to this device fails this transfer instead,
+ * before anything is sent.
+ */
+static int pio_transfer(i2c_inst_t *i2c, uint8_t address, i2c_bus_device_t *dev,
+                        const uint8_t *src, uint8_t *dst, size_t len, bool nostop) {
+    uint8_t bus = dev->pio_bus - 1;
+    bool read = (dst != NULL);
+    uint32_t start = time_us_32();
+
+    int result = settle_pio_bus(i2c, bus);
+    if (result == 0 && dev->deferred_nak) {
+        dev->deferred_nak = false;
+        return PICO_ERROR_GENERIC;      // Already counted in the device health
+    }
+    if (result == 0) {
+        result = read ? pio_i2c_read(bus, address, dst, len, nostop)
+                      : pio_i2c_write(bus, address, src, len, nostop);
+    }
+
+    uint8_t flags = (read ? I2C_TRACE_FLAG_READ : 0) | (nostop ? I2C_TRACE_FLAG_NOSTOP : 0) |
+                    (result < 0 ? I2C_TRACE_FLAG_ERROR : 0);
+    i2c_trace_record(I2C_TRACE_BUS_PIO_BASE + bus, address, len, flags, start, time_us_32() - start);
+
+    if (read || result < 0) {
+        record_health(address, dev, result);
+    }
+    return result;
+}
+#endif
+
+/**
+ * Write on a controller the caller holds
+ */
+static int write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    i2c_bus_device_t *dev = find_or_add_device(i2c, addr);
+    uint32_t start = time_us_32();
+    if (!begin_transfer(i2c, addr, dev)) {
+        return PICO_ERROR_GENERIC;
+    }
+
+#ifdef I2C_BUS_USE_PIO
+    if (dev && dev->pio_bus != I2C_BUS_ROUTE_HW) {
+        return pio_transfer(i2c, addr, dev, src, NULL, len, nostop);
+    }
+#endif
+
+    uint32_t timeout = transfer_timeout_us(get_port(i2c), len);
+    int result = i2c_write_timeout_us(i2c, addr, src, len, nostop, timeout);
+    trace_transfer(i2c, addr, len, 0, nostop, result, start);
+    end_transfer(i2c, addr, dev, result, nostop);
+    return result;
+}
+
+/**
+ * Read on a controller the caller holds
+ */
+static int read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    i2c_bus_device_t *dev = find_or_add_device(i2c, addr);
+    uint32_t start = time_us_32();
+    if (!begin_transfer(i2c, addr, dev)) {
+        return PICO_ERROR_GENERIC;
+    }
+
+#ifdef I2C_BUS_USE_PIO
+    if (dev && dev->pio_bus != I2C_BUS_ROUTE_HW) {
+        return pio_transfer(i2c, addr, dev, NULL, dst, len, nostop);
+    }
+#endif
+
+    uint32_t timeout = transfer_timeout_us(get_port(i2c), len);
+    int result = i2c_read_timeout_us(i2c, addr, dst, len, nostop, timeout);
+    trace_transfer(i2c, addr, len, I2C_TRACE_FLAG_READ, nostop, result, start);
+    end_transfer(i2c, addr, dev, result, nostop);
+    return result;
+}
+
+//--------------------------------------------------------------------+
+// Public API Implementation
+//--------------------------------------------------------------------+
+
+bool i2c_bus_init(i2c_inst_t *i2c, uint sda_pin, uint scl_pin, uint32_t baudrate) {
+    if (!i2c || baudrate == 0) {
+        debug_error("I2C_BUS: Init failed - invalid parameters");
+        return false;
+    }
+
+    i2c_bus_port_t *port = get_port(i2c);
+    if (port->initialized) {
+        return true;  // Already running (shared bus)
+    }
+
+    i2c_trace_init();
+    i2c_init(i2c, baudrate);
+    gpio_set_function(sda_pin, GPIO_FUNC_I2C);
+    gpio_set_function(scl_pin, GPIO_FUNC_I2C);
+    gpio_pull_up(sda_pin);
+    gpio_pull_up(scl_pin);
+
+    port->initialized = true;
+    port->sda_pin = sda_pin;
+    port->scl_pin = scl_pin;
+    port->default_baudrate = baudrate;
+    port->current_baudrate = baudrate;
+    port->held = false;
+#ifdef I2C_BUS_MULTICORE
+    recursive_mutex_init(&port->lock);
+    port->lock_depth = 0;
+#endif
+
+    debug_info("I2C_BUS: i2c%d initialized at %d Hz (SDA=GP%d, SCL=GP%d)",
+               i2c_hw_index(i2c), baudrate, sda_pin, scl_pin);
+    return true;
+}
+
+void i2c_bus_set_role(i2c_bus_role_t role, i2c_inst_t *i2c) {
+    if (role >= I2C_BUS_ROLE_COUNT) {
+        return;
+    }
+    bus_roles[role] = i2c;
+}
+
+i2c_inst_t* i2c_bus_get_role(i2c_bus_role_t role) {
+    if (role >= I2C_BUS_ROLE_COUNT) {
+        return NULL;
+    }
+    return bus_roles[role] ? bus_roles[role] : bus_roles[I2C_BUS_ROLE_ACTUATORS];
+}
+
+bool i2c_bus_init_pio(uint8_t pio_bus, uint sda_pin, uint32_t baudrate) {
+#ifdef I2C_BUS_USE_PIO
+    if (pio_bus == I2C_BUS_ROUTE_HW || pio_bus > PIO_I2C_MAX_BUSES) {
+        debug_error("I2C_BUS: Invalid PIO bus %d", pio_bus);
+        return false;
+    }
+    return pio_i2c_init(pio_bus - 1, sda_pin, baudrate);
+#else
+    (void)sda_pin;
+    (void)baudrate;
+    debug_error("I2C_BUS: PIO bus %d requested but PIO I2C is not enabled", pio_bus);
+    return false;
+#endif
+}
+
+bool i2c_bus_route_device(i2c_inst_t *i2c, uint8_t address, uint8_t pio_bus) {
+    if (!i2c) {
+        return false;
+    }
+
+#ifdef I2C_BUS_USE_PIO
+    if (pio_bus != I2C_BUS_ROUTE_HW && (pio_bus > PIO_I2C_MAX_BUSES || !pio_i2c_is_initialized(pio_bus - 1))) {
+        debug_error("I2C_BUS: PIO bus %d not initialized, 0x%02X stays on i2c%d",
+                    pio_bus, address, i2c_hw_index(i2c));
+        return false;
+    }
+
+    // A PIO bus runs all its devices at one speed: never above a device's own
+    i2c_bus_device_t *known = find_device(i2c, address);
+    if (pio_bus != I2C_BUS_ROUTE_HW && known && known->baudrate &&
+        known->baudrate < pio_i2c_get_baudrate(pio_bus - 1)) {
+        debug_error("I2C_BUS: PIO bus %d runs at %d Hz, above the %d Hz of 0x%02X; it stays on i2c%d",
+                    pio_bus, pio_i2c_get_baudrate(pio_bus - 1), known->baudrate, address, i2c_hw_index(i2c));
+        return false;
+    }
+#else
+    if (pio_bus != I2C_BUS_ROUTE_HW) {
+        debug_error("I2C_BUS: PIO I2C not enabled, 0x%02X stays on i2c%d", address, i2c_hw_index(i2c));
+        return false;
+    }
+#endif
+
+    i2c_bus_device_t *dev = find_or_add_device(i2c, address);
+    if (!dev) {
+        debug_error("I2C_BUS: Device table full, cannot add 0x%02X", address);
+        return false;
+    }
+
+    dev->pio_bus = pio_bus;
+    if (pio_bus != I2C_BUS_ROUTE_HW) {
+        debug_info("I2C_BUS: Device 0x%02X routed to PIO bus %d", address, pio_bus);
+    }
+    return true;
+}
+
+bool i2c_bus_set_device_speed(i2c_inst_t *i2c, uint8_t address, uint32_t baudrate) {
+    if (!i2c || baudrate == 0) {
+        return false;
+    }
+
+    i2c_bus_device_t *dev = find_or_add_device(i2c, address);
+    if (!dev) {
+        debug_error("I2C_BUS: Device table full, cannot add 0x%02X", address);
+        return false;
+    }
+
+    dev->baudrate = baudrate;
+    debug_info("I2C_BUS: Device 0x%02X on i2c%d set to %d Hz", address, i2c_hw_index(i2c), baudrate);
+    return true;
+}
+
+uint32_t i2c_bus_get_device_speed(i2c_inst_t *i2c, uint8_t address) {
+    if (!i2c) {
+        return 0;
+    }
+
+    i2c_bus_device_t *dev = find_device(i2c, address);
+    return (dev && dev->baudrate) ? dev->baudrate : get_port(i2c)->default_baudrate;
+}
+
+int i2c_bus_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    lock_port(i2c);
+    int result = write_blocking(i2c, addr, src, len, nostop);
+    unlock_port(i2c);
+    return result;
+}
+
+int i2c_bus_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    lock_port(i2c);
+    int result = read_blocking(i2c, addr, dst, len, nostop);
+    unlock_port(i2c);
+    return result;
+}
+
+int i2c_bus_flush(i2c_inst_t *i2c, uint8_t addr) {
+#ifdef I2C_BUS_USE_PIO
+    i2c_bus_device_t *dev = find_device(i2c, addr);
+    if (dev && dev->pio_bus != I2C_BUS_ROUTE_HW) {
+        int result = settle_pio_bus(i2c, dev->pio_bus - 1);
+        if (result == 0 && dev->deferred_nak) {
+            dev->deferred_nak = false;
+            result = PICO_ERROR_GENERIC;
+        }
+        return result;
+    }
+#else
+    (void)i2c;
+    (void)addr;
+#endif
+    return 0;   // Hardware controller transfers are blocking
+}
+
+bool i2c_bus_recover(i2c_inst_t *i2c) {
+    if (!i2c) {
+        return false;
+    }
+
+    i2c_bus_port_t *port = get_port(i2c);
+    if (!port->initialized) {
+        return false;
+    }
+
+    uint sda = port->sda_pin;
+    uint scl = port->scl_pin;
+
+    // Take the pins away from the controller. Lines are driven open-drain
+    // style: output low to pull down, input to let the pull-up release.
+    i2c_deinit(i2c);
+    gpio_init(sda);
+    gpio_init(scl);
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+    gpio_put(sda, 0);
+    gpio_put(scl, 0);
+
+    // Clock out whatever byte the slave is stuck in (at most 9 clocks)
+    for (uint8_t i = 0; i < 9 && !gpio_get(sda); i++) {
+        gpio_set_dir(scl, GPIO_OUT);
+        sleep_us(5);
+        gpio_set_dir(scl, GPIO_IN);
+        sleep_us(5);
+    }
+
+    // STOP condition: SDA rises while SCL is high
+    gpio_set_dir(scl, GPIO_OUT);
+    sleep_us(5);
+    gpio_set_dir(sda, GPIO_OUT);
+    sleep_us(5);
+    gpio_set_dir(scl, GPIO_IN);
+    sleep_us(5);
+    gpio_set_dir(sda, GPIO_IN);
+    sleep_us(5);
+
+    bool released = gpio_get(sda);
+
+    // Hand the pins back to the controller at the speed it was running at
+    i2c_init(i2c, port->current_baudrate);
+    gpio_set_function(sda, GPIO_FUNC_I2C);
+    gpio_set_function(scl, GPIO_FUNC_I2C);
+    port->held = false;
+
+    if (released) {
+        debug_info("I2C_BUS: i2c%d recovered", i2c_hw_index(i2c));
+    } else {
+        debug_error("I2C_BUS: i2c%d recovery failed - SDA still held low", i2c_hw_index(i2c));
+    }
+    return released;
+}
+
+bool i2c_bus_get_device_health(i2c_inst_t *i2c, uint8_t address, i2c_bus_device_health_t *health) {
+    if (!i2c || !health) {
+        return false;
+    }
+
+    i2c_bus_device_t *dev = find_device(i2c, address);
+    if (!dev) {
+        return false;
+    }
+
+    *health = dev->health;
+    return true;
+}
+
+void i2c_bus_get_switch_stats(i2c_inst_t *i2c, i2c_bus_switch_stats_t *stats) {
+    if (!i2c || !stats) {
+        return;
+    }
+    *stats = get_port(i2c)->switch_stats;
+}
+
+void i2c_bus_print_stats(void) {
+    for (uint8_t p = 0; p < I2C_BUS_NUM_PORTS; p++) {
+        i2c_bus_port_t *port = &bus_ports[p];
+        if (!port->initialized) {
+            continue;
+        }
+
+        const i2c_bus_switch_stats_t *s = &port->switch_stats;
+        uint32_t avg = s->switch_count ? (s->switch_time_total_us / s->switch_count) : 0;
+        debug_info("I2C_BUS: i2c%d default %d Hz, now %d Hz, %d switches (avg %d us, max %d us)",
+                   p, port->default_baudrate, port->current_baudrate,
+                   s->switch_count, avg, s->switch_time_max_us);
+    }
+
+    for (uint8_t i = 0; i < bus_device_count; i++) {
+        const i2c_bus_device_t *dev = &bus_devices[i];
+        if (dev->pio_bus != I2C_BUS_ROUTE_HW) {
+            debug_info("I2C_BUS:   0x%02X on PIO bus %d - NAK %d, timeout %d, recovery %d%s",
+                       dev->address, dev->pio_bus,
+                       dev->health.nak_count, dev->health.timeout_count, dev->health.recovery_count,
+                       dev->health.isolated ? " (isolated)" : "");
+            continue;
+        }
+        debug_info("I2C_BUS:   0x%02X on i2c%d @ %d Hz - NAK %d, timeout %d, recovery %d%s",
+                   dev->address, i2c_hw_index(dev->i2c),
+                   i2c_bus_get_device_speed(dev->i2c, dev->address),
+                   dev->health.nak_count, dev->health.timeout_count, dev->health.recovery_count,
+                   dev->health.isolated ? " (isolated)" : "");
+    }
+}
@@ -0,0 +1,227 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "hardware/i2c.h"
+
+// Standard I2C bus speeds
+#define I2C_BUS_SPEED_STANDARD   100000   // Standard-mode (100 kHz)
+#define I2C_BUS_SPEED_FAST       400000   // Fast-mode (400 kHz)
+#define I2C_BUS_SPEED_FAST_PLUS  1000000  // Fast-mode Plus (1 MHz)
+
+// Number of hardware I2C controllers (i2c0, i2c1)
+#define I2C_BUS_NUM_PORTS 2
+
+// Maximum number of devices tracked (speed setting and health counters)
+#define I2C_BUS_MAX_DEVICES 16
+
+// Device routing: 0 = hardware controller, 1..N = PIO bus N (USE_PIO_I2C builds)
+#define I2C_BUS_ROUTE_HW 0
+
+// Transfer timeout = wire time for the transfer x2 plus this margin
+#define I2C_BUS_TIMEOUT_MARGIN_US 1000
+
+// Consecutive failures before a device is isolated
+#define I2C_BUS_ISOLATE_THRESHOLD 5
+
+// Time an isolated device is left alone before it gets another try
+#define I2C_BUS_ISOLATE_RETRY_MS 2000
+
+/**
+ * Bus roles - which controller each group of devices lives on
+ *
+ * In a single-bus build both roles map to the same controller. In a
+ * dual-bus build the OLED and EEPROM get their own controller so display
+ * flushes never compete with actuator writes.
+ */
+typedef enum {
+    I2C_BUS_ROLE_ACTUATORS = 0,    // IO expanders, PCA9685
+    I2C_BUS_ROLE_PERIPHERALS = 1,  // OLED display, EEPROM
+    I2C_BUS_ROLE_COUNT             // Must be last
+} i2c_bus_role_t;
+
+/**
+ * Baud rate switch statistics for one I2C controller
+ */
+typedef struct {
+    uint32_t switch_count;          // Number of baud rate reprogrammings
+    uint32_t switch_time_total_us;  // Cumulative time spent reprogramming
+    uint32_t switch_time_max_us;    // Longest single reprogramming
+} i2c_bus_switch_stats_t;
+
+/**
+ * Health counters for one device
+ */
+typedef struct {
+    uint32_t nak_count;             // Transfers not acknowledged
+    uint32_t timeout_count;         // Transfers that hit the timeout
+    uint32_t recovery_count;        // Bus recoveries triggered by this device
+    uint8_t consecutive_failures;   // Failures since the last successful transfer
+    bool isolated;                  // Transfers are refused until the retry time
+} i2c_bus_device_health_t;
+
+/**
+ * Initialize an I2C controller and its pins
+ *
+ * Does nothing if the controller has already been initialized, so several
+ * libraries sharing one bus can all call it safely.
+ *
+ * @param i2c I2C port (i2c0 or i2c1)
+ * @param sda_pin GPIO pin for SDA
+ * @param scl_pin GPIO pin for SCL
+ * @param baudrate Default bus speed in Hz for devices without their own setting
+ * @return true if the bus is ready, false otherwise
+ */
+bool i2c_bus_init(i2c_inst_t *i2c, uint sda_pin, uint scl_pin, uint32_t baudrate);
+
+/**
+ * Assign a controller to a bus role
+ *
+ * @param role Bus role
+ * @param i2c I2C port serving that role
+ */
+void i2c_bus_set_role(i2c_bus_role_t role, i2c_inst_t *i2c);
+
+/**
+ * Get the controller assigned to a bus role
+ *
+ * Roles that were never assigned fall back to the actuator bus, so a
+ * single-bus build only needs to assign I2C_BUS_ROLE_ACTUATORS.
+ *
+ * @param role Bus role
+ * @return I2C port for the role, or NULL if no bus has been assigned
+ */
+i2c_inst_t* i2c_bus_get_role(i2c_bus_role_t role);
+
+/**
+ * Set the bus speed used when talking to a specific device
+ *
+ * The controller is reprogrammed only when a transfer targets a device
+ * whose speed differs from the speed the bus is currently running at.
+ *
+ * @param i2c I2C port the device is attached to
+ * @param address 7-bit I2C address of the device
+ * @param baudrate Bus speed in Hz (e.g. I2C_BUS_SPEED_FAST_PLUS)
+ * @return true if successful, false if the device table is full
+ */
+bool i2c_bus_set_device_speed(i2c_inst_t *i2c, uint8_t address, uint32_t baudrate);
+
+/**
+ * Initialize a PIO I2C bus for actuators
+ *
+ * Only available when the firmware is built with USE_PIO_I2C (which defines
+ * I2C_BUS_USE_PIO); otherwise this logs an error and returns false.
+ *
+ * @param pio_bus PIO bus number (1 to PIO_I2C_MAX_BUSES)
+ * @param sda_pin GPIO pin for SDA; SCL must be on sda_pin + 1
+ * @param baudrate Bus speed in Hz
+ * @return true if the bus is ready, false otherwise
+ */
+bool i2c_bus_init_pio(uint8_t pio_bus, uint sda_pin, uint32_t baudrate);
+
+/**
+ * Route a device to a PIO I2C bus
+ *
+ * Drivers keep passing their hardware port; transfers for the device go to
+ * the PIO bus instead. Writes to PIO buses are write-behind, so writes to
+ * devices on different buses run at the same time. A device with its own
+ * speed below the PIO bus speed is not routed.
+ *
+ * @param i2c I2C port the driver was configured with
+ * @param address 7-bit I2C address of the device
+ * @param pio_bus PIO bus number, or I2C_BUS_ROUTE_HW for the hardware controller
+ * @return true if successful, false if the PIO bus is not available or too fast
+ */
+bool i2c_bus_route_device(i2c_inst_t *i2c, uint8_t address, uint8_t pio_bus);
+
+/**
+ * Get the bus speed used for a specific device
+ *
+ * @param i2c I2C port the device is attached to
+ * @param address 7-bit I2C address of the device
+ * @return Bus speed in Hz (the bus default if the device has no own setting)
+ */
+uint32_t i2c_bus_get_device_speed(i2c_inst_t *i2c, uint8_t address);
+
+/**
+ * Write to a device, switching the bus speed first if needed
+ *
+ * Drop-in replacement for i2c_write_blocking(). The transfer is bounded by
+ * a timeout derived from its length and the bus speed; a timeout triggers
+ * a bus recovery. Transfers to an isolated device fail immediately.
+ *
+ * For a device routed to a PIO bus the write is write-behind: len comes
+ * back once it is queued, before the device has acknowledged it. A NAK is
+ * reported by the next transfer to the device, which fails with
+ * PICO_ERROR_GENERIC without being sent, or by i2c_bus_flush(). Drivers
+ * that cache the device state should write their whole state again after
+ * a failure.
+ *
+ * @return Number of bytes written (queued on a PIO bus), PICO_ERROR_GENERIC
+ *         on NAK (of this write, or of the last queued one to the device)
+ *         or isolation, PICO_ERROR_TIMEOUT on timeout
+ */
+int i2c_bus_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+/**
+ * Wait until every write to a device has been acknowledged
+ *
+ * Only PIO buses have writes in flight; for devices on a hardware
+ * controller this returns 0 at once.
+ *
+ * @param i2c I2C port the device is attached to
+ * @param addr 7-bit I2C address of the device
+ * @return 0 if the writes were acknowledged, PICO_ERROR_GENERIC if the last
+ *         queued one was NAKed (reported once), PICO_ERROR_TIMEOUT on timeout
+ */
+int i2c_bus_flush(i2c_inst_t *i2c, uint8_t addr);
+
+/**
+ * Read from a device, switching the bus speed first if needed
+ *
+ * Drop-in replacement for i2c_read_blocking(). Same timeout, recovery and
+ * isolation behaviour as i2c_bus_write_blocking().
+ *
+ * @return Number of bytes read, PICO_ERROR_GENERIC on NAK or isolation,
+ *         PICO_ERROR_TIMEOUT on timeout
+ */
+int i2c_bus_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+/**
+ * Recover a stuck bus
+ *
+ * Clocks SCL up to 9 times until the slave holding SDA low releases it,
+ * generates a STOP condition and re-initializes the controller at its
+ * current speed.
+ *
+ * @param i2c I2C port
+ * @return true if SDA is released, false if it is still held low
+ */
+bool i2c_bus_recover(i2c_inst_t *i2c);
+
+/**
+ * Get the health counters for a device
+ *
+ * @param i2c I2C port the device is attached to
+ * @param address 7-bit I2C address of the device
+ * @param health Pointer to store the counters
+ * @return true if the device has been seen, false otherwise
+ */
+bool i2c_bus_get_device_health(i2c_inst_t *i2c, uint8_t address, i2c_bus_device_health_t *health);
+
+/**
+ * Get baud rate switch statistics for a controller
+ *
+ * @param i2c I2C port
+ * @param stats Pointer to store the statistics
+ */
+void i2c_bus_get_switch_stats(i2c_inst_t *i2c, i2c_bus_switch_stats_t *stats);
+
+/**
+ * Print bus speeds, switch statistics and device health to the debug UART
+ */
+void i2c_bus_print_stats(void);
+
+#endif // I2C_BUS_H
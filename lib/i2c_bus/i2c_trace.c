@@ -0,0 +1,134 @@
+#include "i2c_trace.h"
+#include <string.h>
+#ifdef I2C_BUS_MULTICORE
+#include "hardware/sync.h"
+#endif
+#include "../../src/debug_uart.h"
+
+//--------------------------------------------------------------------+
+// Internal State
+//--------------------------------------------------------------------+
+
+static i2c_trace_device_stats_t trace_stats[I2C_TRACE_NUM_ADDRESSES];
+static i2c_trace_entry_t trace_ring[I2C_TRACE_RING_SIZE];
+static uint8_t trace_head = 0;      // Next slot to write
+static uint8_t trace_count = 0;     // Valid entries in the ring
+
+#ifdef I2C_BUS_MULTICORE
+// Both cores record transfers: the counters and the ring are updated under
+// a hardware spin lock of their own, held for a few dozen cycles
+static spin_lock_t *trace_lock = NULL;
+#endif
+
+//--------------------------------------------------------------------+
+// Public API Implementation
+//--------------------------------------------------------------------+
+
+void i2c_trace_init(void) {
+#ifdef I2C_BUS_MULTICORE
+    if (!trace_lock) {
+        trace_lock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+#endif
+}
+
+void i2c_trace_record(uint8_t bus, uint8_t address, size_t length, uint8_t flags,
+                      uint32_t start_us, uint32_t duration_us) {
+    address &= 0x7F;
+
+#ifdef I2C_BUS_MULTICORE
+    uint32_t irq_state = spin_lock_blocking(trace_lock);
+#endif
+    i2c_trace_device_stats_t *s = &trace_stats[address];
+    s->transactions++;
+    if (flags & I2C_TRACE_FLAG_ERROR) {
+        s->errors++;
+    } else {
+        s->bytes += length;
+    }
+    s->total_time_us += duration_us;
+    if (duration_us > s->max_time_us) {
+        s->max_time_us = duration_us;
+    }
+
+    i2c_trace_entry_t *e = &trace_ring[trace_head];
+    e->timestamp_us = start_us;
+    e->duration_us = duration_us;
+    e->length = length > UINT16_MAX ? UINT16_MAX : (uint16_t)length;
+    e->address = address;
+    e->bus = bus;
+    e->flags = flags;
+
+    trace_head = (trace_head + 1) % I2C_TRACE_RING_SIZE;
+    if (trace_count < I2C_TRACE_RING_SIZE) {
+        trace_count++;
+    }
+#ifdef I2C_BUS_MULTICORE
+    spin_unlock(trace_lock, irq_state);
+#endif
+}
+
+bool i2c_trace_get_device_stats(uint8_t address, i2c_trace_device_stats_t *stats) {
+    if (!stats || address >= I2C_TRACE_NUM_ADDRESSES) {
+        return false;
+    }
+
+    *stats = trace_stats[address];
+    return stats->transactions > 0;
+}
+
+bool i2c_trace_get_entry(uint8_t index, i2c_trace_entry_t *entry) {
+    if (!entry || index >= trace_count) {
+        return false;
+    }
+
+    uint8_t slot = (trace_head + I2C_TRACE_RING_SIZE - 1 - index) % I2C_TRACE_RING_SIZE;
+    *entry = trace_ring[slot];
+    return true;
+}
+
+uint8_t i2c_trace_get_entry_count(void) {
+    return trace_count;
+}
+
+void i2c_trace_reset(void) {
+#ifdef I2C_BUS_MULTICORE
+    uint32_t irq_state = trace_lock ? spin_lock_blocking(trace_lock) : 0;
+#endif
+    memset(trace_stats, 0, sizeof(trace_stats));
+    memset(trace_ring, 0, sizeof(trace_ring));
+    trace_head = 0;
+    trace_count = 0;
+#ifdef I2C_BUS_MULTICORE
+    if (trace_lock) {
+        spin_unlock(trace_lock, irq_state);
+    }
+#endif
+}
+
+void i2c_trace_print(void) {
+    debug_info("I2C_TRACE: Per-device traffic");
+    for (uint8_t addr = 0; addr < I2C_TRACE_NUM_ADDRESSES; addr++) {
+        const i2c_trace_device_stats_t *s = &trace_stats[addr];
+        if (s->transactions == 0) {
+            continue;
+        }
+        uint32_t avg = (uint32_t)(s->total_time_us / s->transactions);
+        debug_info("I2C_TRACE:   0x%02X: %d txn, %d bytes, %d err, total %d us, avg %d us, max %d us",
+                   addr, s->transactions, s->bytes, s->errors,
+                   (uint32_t)s->total_time_us, avg, s->max_time_us);
+    }
+
+    debug_info("I2C_TRACE: Last %d transactions (newest first)", trace_count);
+    for (uint8_t i = 0; i < trace_count; i++) {
+        i2c_trace_entry_t e;
+        i2c_trace_get_entry(i, &e);
+        bool pio = e.bus >= I2C_TRACE_BUS_PIO_BASE;
+        debug_info("I2C_TRACE:   %10u us %s%d 0x%02X %s %3d bytes %5d us%s",
+                   e.timestamp_us, pio ? "pio" : "i2c",
+                   pio ? e.bus - I2C_TRACE_BUS_PIO_BASE + 1 : e.bus, e.address,
+                   (e.flags & I2C_TRACE_FLAG_READ) ? "R" : "W",
+                   e.length, e.duration_us,
+                   (e.flags & I2C_TRACE_FLAG_ERROR) ? " ERR" : "");
+    }
+}
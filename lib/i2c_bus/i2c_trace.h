@@ -0,0 +1,105 @@
+#ifndef I2C_TRACE_H
+#define I2C_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Number of most recent transactions kept in the trace ring
+#ifndef I2C_TRACE_RING_SIZE
+#define I2C_TRACE_RING_SIZE 32
+#endif
+
+// Number of 7-bit addresses tracked
+#define I2C_TRACE_NUM_ADDRESSES 128
+
+// Bus numbers in trace entries: 0/1 = i2c0/i2c1, PIO bus N = base + N - 1
+#define I2C_TRACE_BUS_PIO_BASE 2
+
+// Trace entry flags
+#define I2C_TRACE_FLAG_READ   0x01  // Read transfer (write otherwise)
+#define I2C_TRACE_FLAG_ERROR  0x02  // Transfer failed (NAK or timeout)
+#define I2C_TRACE_FLAG_NOSTOP 0x04  // Transfer ended without STOP
+
+/**
+ * Accumulated traffic for one 7-bit address
+ */
+typedef struct {
+    uint32_t transactions;      // Number of transfers
+    uint32_t bytes;             // Payload bytes transferred
+    uint32_t errors;            // Failed transfers
+    uint64_t total_time_us;     // Cumulative transfer time
+    uint32_t max_time_us;       // Longest single transfer
+} i2c_trace_device_stats_t;
+
+/**
+ * One recorded transaction
+ */
+typedef struct {
+    uint32_t timestamp_us;      // Start of the transfer (time_us_32)
+    uint32_t duration_us;       // Transfer time including any speed switch
+    uint16_t length;            // Payload bytes requested
+    uint8_t address;            // 7-bit device address
+    uint8_t bus;                // Controller index (see I2C_TRACE_BUS_PIO_BASE)
+    uint8_t flags;              // I2C_TRACE_FLAG_*
+} i2c_trace_entry_t;
+
+/**
+ * Set up the tracer
+ *
+ * Called by i2c_bus_init(). With I2C_BUS_MULTICORE, claims the hardware
+ * spin lock transfers are recorded under.
+ */
+void i2c_trace_init(void);
+
+/**
+ * Record a transaction
+ *
+ * Called by the i2c_bus layer after every transfer.
+ *
+ * @param bus Controller index (see I2C_TRACE_BUS_PIO_BASE)
+ * @param address 7-bit device address
+ * @param length Payload bytes requested
+ * @param flags I2C_TRACE_FLAG_* bits
+ * @param start_us Transfer start time (time_us_32)
+ * @param duration_us Transfer time in microseconds
+ */
+void i2c_trace_record(uint8_t bus, uint8_t address, size_t length, uint8_t flags,
+                      uint32_t start_us, uint32_t duration_us);
+
+/**
+ * Get accumulated traffic for an address
+ *
+ * @param address 7-bit device address
+ * @param stats Pointer to store the statistics
+ * @return true if the address has seen traffic, false otherwise
+ */
+bool i2c_trace_get_device_stats(uint8_t address, i2c_trace_device_stats_t *stats);
+
+/**
+ * Get a transaction from the trace ring
+ *
+ * @param index 0 for the most recent transaction, 1 for the one before, ...
+ * @param entry Pointer to store the entry
+ * @return true if the entry exists, false otherwise
+ */
+bool i2c_trace_get_entry(uint8_t index, i2c_trace_entry_t *entry);
+
+/**
+ * Get the number of transactions currently held in the trace ring
+ *
+ * @return Number of entries (at most I2C_TRACE_RING_SIZE)
+ */
+uint8_t i2c_trace_get_entry_count(void);
+
+/**
+ * Clear all statistics and the trace ring
+ */
+void i2c_trace_reset(void);
+
+/**
+ * Print per-address statistics and the trace ring to the debug UART
+ */
+void i2c_trace_print(void);
+
+#endif // I2C_TRACE_H
@@ -1,4 +1,5 @@
 #include "at24cxx_driver.h"
+#include "i2c_bus.h"
 #include "../../../src/debug_uart.h"
 #include "pico/stdlib.h"
 #include <string.h>
@@ -89,7 +90,7 @@ bool at24cxx_write_byte(at24cxx_t *ctx, uint32_t mem_address, uint8_t data) {
         buffer_len = 2;
     }
     
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, buffer_len, false);
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, buffer_len, false);
     
     if (result != buffer_len) {
         debug_error("AT24CXX: Write failed at address 0x%04X (result=%d)", mem_address, result);
@@ -127,14 +128,14 @@ bool at24cxx_read_byte(at24cxx_t *ctx, uint32_t mem_address, uint8_t *data) {
     }
     
     // Write address
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, addr_buffer, addr_len, true);
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, addr_buffer, addr_len, true);
     if (result != addr_len) {
         debug_error("AT24CXX: Failed to set read address 0x%04X", mem_address);
         return false;
     }
     
     // Read data
-    result = i2c_read_blocking(ctx->i2c_port, ctx->address, data, 1, false);
+    result = i2c_bus_read_blocking(ctx->i2c_port, ctx->address, data, 1, false);
     if (result != 1) {
         debug_error("AT24CXX: Read failed at address 0x%04X", mem_address);
         return false;
@@ -179,7 +180,7 @@ bool at24cxx_write(at24cxx_t *ctx, uint32_t mem_address, const uint8_t *data, ui
         buffer_idx += chunk_size;
         
         // Write page
-        int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, buffer_idx, false);
+        int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, buffer_idx, false);
         
         if (result != buffer_idx) {
             debug_error("AT24CXX: Page write failed at address 0x%04X", current_address);
@@ -219,14 +220,14 @@ bool at24cxx_read(at24cxx_t *ctx, uint32_t mem_address, uint8_t *data, uint32_t
     }
     
     // Write starting address
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, addr_buffer, addr_len, true);
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, addr_buffer, addr_len, true);
     if (result != addr_len) {
         debug_error("AT24CXX: Failed to set read address 0x%04X", mem_address);
         return false;
     }
     
     // Sequential read
-    result = i2c_read_blocking(ctx->i2c_port, ctx->address, data, length, false);
+    result = i2c_bus_read_blocking(ctx->i2c_port, ctx->address, data, length, false);
     if (result != (int)length) {
         debug_error("AT24CXX: Sequential read failed (expected %d, got %d)", length, result);
         return false;
@@ -1,4 +1,5 @@
 #include "ch423_driver.h"
+#include "i2c_bus.h"
 #include "../../src/debug_uart.h"
 
 bool ch423_init(ch423_t *ctx, i2c_inst_t *i2c_port, uint8_t address) {
@@ -40,7 +41,7 @@ bool ch423_write(ch423_t *ctx, uint16_t data) {
     buffer[0] = CH423_CMD_WRITE_OC;
     buffer[1] = (uint8_t)(data & 0xFF);  // Low byte
     
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, 2, false);
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, 2, false);
     if (result != 2) {
         debug_error("CH423: Write OC failed (result=%d, addr=0x%02X)", result, ctx->address);
         return false;
@@ -50,7 +51,7 @@ bool ch423_write(ch423_t *ctx, uint16_t data) {
     buffer[0] = CH423_CMD_WRITE_PP;
     buffer[1] = (uint8_t)(data >> 8);  // High byte
     
-    result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, 2, false);
+    result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, 2, false);
     if (result != 2) {
         debug_error("CH423: Write PP failed (result=%d, addr=0x%02X)", result, ctx->address);
         return false;
@@ -70,14 +71,14 @@ bool ch423_read(ch423_t *ctx, uint16_t *data) {
     buffer[0] = CH423_CMD_READ_IO;
     
     // Write command
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, 1, true);
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, 1, true);
     if (result != 1) {
         debug_error("CH423: Read command failed (result=%d)", result);
         return false;
     }
     
     // Read 2 bytes back
-    result = i2c_read_blocking(ctx->i2c_port, ctx->address, buffer, 2, false);
+    result = i2c_bus_read_blocking(ctx->i2c_port, ctx->address, buffer, 2, false);
     if (result != 2) {
         debug_error("CH423: Read data failed (result=%d)", result);
         return false;
@@ -141,7 +142,7 @@ bool ch423_set_io_direction(ch423_t *ctx, uint8_t pin, bool is_input) {
     buffer[1] = (uint8_t)(new_direction & 0xFF);      // Low byte
     buffer[2] = (uint8_t)(new_direction >> 8);        // High byte
     
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, 3, false);
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, 3, false);
     if (result != 3) {
         debug_error("CH423: Set IO direction failed (result=%d)", result);
         return false;
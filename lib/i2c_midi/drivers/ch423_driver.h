@@ -8,6 +8,9 @@
 // CH423 default I2C address
 #define CH423_DEFAULT_ADDRESS 0x24
 
+// Fastest I2C clock the chip supports (Fast-mode, no Fast-mode Plus)
+#define CH423_MAX_FREQ        400000
+
 // CH423 Command bytes
 #define CH423_CMD_WRITE_OC  0x01  // Write to open-collector outputs (OC0-OC7)
 #define CH423_CMD_WRITE_PP  0x02  // Write to push-pull outputs (PP0-PP7)
@@ -1,4 +1,5 @@
 #include "pcf857x_driver.h"
+#include "i2c_bus.h"
 #include "../../../src/debug_uart.h"
 
 bool pcf857x_init(pcf857x_t *ctx, i2c_inst_t *i2c_port, uint8_t address, pcf857x_chip_type_t chip_type) {
@@ -46,7 +47,10 @@ bool pcf857x_write(pcf857x_t *ctx, uint16_t data) {
         bytes_to_write = 2;
     }
     
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, bytes_to_write, false);
+    // On a PIO bus success means queued: a NAK fails the next write instead,
+    // which is not sent. pin_state then still holds the NAKed state, and
+    // since every write carries all pins the next one that goes out sends it.
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, bytes_to_write, false);
     if (result == bytes_to_write) {
         ctx->pin_state = data;
         debug_printf("%s: Write success: 0x%04X\n", chip_name, data);
@@ -73,7 +77,7 @@ bool pcf857x_read(pcf857x_t *ctx, uint16_t *data) {
         bytes_to_read = 2;
     }
     
-    int result = i2c_read_blocking(ctx->i2c_port, ctx->address, buffer, bytes_to_read, false);
+    int result = i2c_bus_read_blocking(ctx->i2c_port, ctx->address, buffer, bytes_to_read, false);
     if (result == bytes_to_read) {
         if (ctx->chip_type == PCF8574_CHIP) {
             *data = buffer[0];
@@ -9,6 +9,10 @@
 #define PCF857X_DEFAULT_ADDRESS 0x20
 #define PCF8575_DEFAULT_ADDRESS 0x20
 
+// Fastest I2C clock each chip supports (datasheet maximum)
+#define PCF8574_MAX_FREQ        100000  // Standard-mode only
+#define PCF8575_MAX_FREQ        400000  // Fast-mode
+
 // PCF857x chip types
 typedef enum {
     PCF8574_CHIP = 0,  // 8-bit I/O expander
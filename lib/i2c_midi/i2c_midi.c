@@ -6,9 +6,15 @@
 #include "drivers/ch423_driver.h"
 #endif
 #include "hardware/gpio.h"
+#include "i2c_bus.h"
 #include "../../src/debug_uart.h"
 #include <string.h>
 
+#ifdef USE_PCF857X_DRIVER
+// Chip the PCF857x driver is set up as (16 pins)
+#define I2C_MIDI_PCF857X_CHIP   PCF8575_CHIP
+#endif
+
 //--------------------------------------------------------------------+
 // IO Expander Abstraction Layer
 //--------------------------------------------------------------------+
@@ -187,7 +193,7 @@ bool i2c_midi_init(i2c_midi_t *ctx, i2c_inst_t *i2c_port, uint sda_pin, uint scl
     switch (ctx->config.io_type) {
 #ifdef USE_PCF857X_DRIVER
         case IO_EXPANDER_PCF8574:
-            if (!pcf857x_init(&ctx->driver.pcf857x, i2c_port, ctx->config.io_address, PCF8575_CHIP)) {
+            if (!pcf857x_init(&ctx->driver.pcf857x, i2c_port, ctx->config.io_address, I2C_MIDI_PCF857X_CHIP)) {
                 debug_error("I2C_MIDI: PCF857x initialization failed");
             }
             break;
@@ -227,11 +233,16 @@ bool i2c_midi_init_with_config(i2c_midi_t *ctx, i2c_midi_config_t *config, uint
     // We do NOT re-initialize it here to avoid bus conflicts
     debug_info("I2C_MIDI: Using pre-initialized I2C bus (assumed %d Hz)", baudrate);
 
+    // Move the expander to its own PIO bus so it runs in parallel with the others
+    if (ctx->config.pio_bus != I2C_BUS_ROUTE_HW) {
+        i2c_bus_route_device(ctx->config.i2c_port, ctx->config.io_address, ctx->config.pio_bus);
+    }
+
     // Initialize IO expander driver
     switch (ctx->config.io_type) {
 #ifdef USE_PCF857X_DRIVER
         case IO_EXPANDER_PCF8574:
-            if (!pcf857x_init(&ctx->driver.pcf857x, config->i2c_port, ctx->config.io_address, PCF8575_CHIP)) {
+            if (!pcf857x_init(&ctx->driver.pcf857x, config->i2c_port, ctx->config.io_address, I2C_MIDI_PCF857X_CHIP)) {
                 debug_error("I2C_MIDI: PCF857x initialization failed");
             }
             break;
@@ -267,8 +278,8 @@ bool i2c_midi_process_message(i2c_midi_t *ctx, uint8_t status, uint8_t note, uin
     uint8_t message_type = status & 0xF0;
     uint8_t channel = (status & 0x0F) + 1; // MIDI channels are 1-16, status byte is 0-15
 
-    // Check if message is for our channel
-    if (channel != ctx->config.midi_channel) {
+    // Check if message is for our channel (0xFF = all channels, see midi_handler_set_channel)
+    if (ctx->config.midi_channel != 0xFF && channel != ctx->config.midi_channel) {
         // Debug output disabled for performance (causes stuttering)
         // debug_printf("I2C_MIDI: Ignored - wrong channel (msg ch:%d, expected:%d)\n", channel, ctx->config.midi_channel);
         return false;
@@ -421,3 +432,21 @@ bool i2c_midi_reset(i2c_midi_t *ctx) {
     ctx->pin_state = 0x00;
     return io_write(ctx, 0x00);
 }
+
+/**
+ * Get the fastest I2C clock an IO expander type supports
+ */
+uint32_t i2c_midi_get_io_max_freq(io_expander_type_t io_type) {
+    switch (io_type) {
+#ifdef USE_PCF857X_DRIVER
+        case IO_EXPANDER_PCF8574:
+            return (I2C_MIDI_PCF857X_CHIP == PCF8574_CHIP) ? PCF8574_MAX_FREQ : PCF8575_MAX_FREQ;
+#endif
+#ifdef USE_CH423_DRIVER
+        case IO_EXPANDER_CH423:
+            return CH423_MAX_FREQ;
+#endif
+        default:
+            return 100000;  // Standard-mode: every part supports it
+    }
+}
@@ -56,6 +56,7 @@ typedef struct {
     i2c_inst_t *i2c_port;                   // I2C port to use (i2c0 or i2c1)
     io_expander_type_t io_type;             // Type of IO expander to use
     i2c_midi_semitone_mode_t semitone_mode; // How to handle semitone notes
+    uint8_t pio_bus;                        // 0 = hardware I2C, 1-4 = PIO I2C bus (USE_PIO_I2C)
 } i2c_midi_config_t;
 
 /**
@@ -144,4 +145,15 @@ bool i2c_midi_set_semitone_mode(i2c_midi_t *ctx, i2c_midi_semitone_mode_t mode);
  */
 bool i2c_midi_reset(i2c_midi_t *ctx);
 
+/**
+ * Get the fastest I2C clock an IO expander type supports
+ * 
+ * Register the expander's bus speed no higher than this: the PCF857x and
+ * CH423 do not support Fast-mode Plus.
+ * 
+ * @param io_type Type of IO expander
+ * @return Clock in Hz
+ */
+uint32_t i2c_midi_get_io_max_freq(io_expander_type_t io_type);
+
 #endif // I2C_MIDI_H
@@ -1,4 +1,5 @@
 #include "pca9685_driver.h"
+#include "i2c_bus.h"
 #include "pico/stdlib.h"
 #include <stdio.h>
 
@@ -9,23 +10,92 @@
 #define PCA9685_PRINTF(...)
 #endif
 
+// queued_channel values besides a channel number
+#define PCA9685_NO_CHANNEL   0xFF                   // Nothing awaiting its ACK
+#define PCA9685_ALL_CHANNELS PCA9685_NUM_CHANNELS   // The ALL_LED registers
+
+/**
+ * Note the outcome of a write for the channel write queued before it: a
+ * write that went out means that one was ACKed, a failed one may stand
+ * for its NAK (PIO write-behind), so the channel is owed again
+ */
+static void pca9685_settle_queued(pca9685_t *ctx, bool written) {
+    if (!written) {
+        if (ctx->queued_channel == PCA9685_ALL_CHANNELS) {
+            ctx->resend_mask = 0xFFFF;
+        } else if (ctx->queued_channel < PCA9685_NUM_CHANNELS) {
+            ctx->resend_mask |= 1u << ctx->queued_channel;
+        }
+    }
+    ctx->queued_channel = PCA9685_NO_CHANNEL;
+}
+
 /**
  * Write a single byte to a PCA9685 register
  */
 static bool pca9685_write_register(pca9685_t *ctx, uint8_t reg, uint8_t value) {
     uint8_t buffer[2] = {reg, value};
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, 2, false);
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, 2, false);
+    pca9685_settle_queued(ctx, result == 2);
     return result == 2;
 }
 
+/**
+ * Write the ON/OFF registers of a channel (or ALL_LED) with auto-increment
+ */
+static bool pca9685_write_channel(pca9685_t *ctx, uint8_t reg_base, uint16_t on_time, uint16_t off_time) {
+    // Write all 4 bytes (ON_L, ON_H, OFF_L, OFF_H) using auto-increment
+    uint8_t buffer[5];
+    buffer[0] = reg_base;
+    buffer[1] = on_time & 0xFF;         // ON_L
+    buffer[2] = (on_time >> 8) & 0x0F;  // ON_H
+    buffer[3] = off_time & 0xFF;        // OFF_L
+    buffer[4] = (off_time >> 8) & 0x0F; // OFF_H
+    
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, buffer, 5, false);
+    return result == 5;
+}
+
+/**
+ * Send every channel in the resend mask, trying once more after a failed
+ * write (which puts the channel queued before it back in the mask)
+ */
+static bool pca9685_send_channels(pca9685_t *ctx) {
+    bool retried = false;
+    
+    for (uint8_t channel = 0; channel < PCA9685_NUM_CHANNELS && ctx->resend_mask; channel++) {
+        uint16_t bit = 1u << channel;
+        if (!(ctx->resend_mask & bit)) {
+            continue;
+        }
+        
+        if (pca9685_write_channel(ctx, PCA9685_LED0_ON_L + (channel * 4),
+                                  ctx->channel_on[channel], ctx->channel_off[channel])) {
+            ctx->resend_mask &= ~bit;
+            ctx->queued_channel = channel;
+            continue;
+        }
+        
+        pca9685_settle_queued(ctx, false);
+        if (retried) {
+            PCA9685_PRINTF("PCA9685: Channel writes failed, 0x%04X left to send\n", ctx->resend_mask);
+            return false;
+        }
+        retried = true;
+        channel = UINT8_MAX;    // Start over from channel 0
+    }
+    return true;
+}
+
 /**
  * Read a single byte from a PCA9685 register
  */
 static bool pca9685_read_register(pca9685_t *ctx, uint8_t reg, uint8_t *value) {
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, &reg, 1, true);
+    int result = i2c_bus_write_blocking(ctx->i2c_port, ctx->address, &reg, 1, true);
+    pca9685_settle_queued(ctx, result == 1);
     if (result != 1) return false;
     
-    result = i2c_read_blocking(ctx->i2c_port, ctx->address, value, 1, false);
+    result = i2c_bus_read_blocking(ctx->i2c_port, ctx->address, value, 1, false);
     return result == 1;
 }
 
@@ -34,7 +104,7 @@ static bool pca9685_read_register(pca9685_t *ctx, uint8_t reg, uint8_t *value) {
  */
 static void pca9685_software_reset(i2c_inst_t *i2c_port) {
     uint8_t reset_cmd = 0x06;  // SWRST - Software Reset
-    i2c_write_blocking(i2c_port, 0x00, &reset_cmd, 1, false);  // General call address
+    i2c_bus_write_blocking(i2c_port, 0x00, &reset_cmd, 1, false);  // General call address
     sleep_ms(10);  // Wait for reset to complete
 }
 
@@ -48,6 +118,8 @@ bool pca9685_init(pca9685_t *ctx, i2c_inst_t *i2c_port, uint8_t address, uint8_t
     ctx->address = address;
     ctx->frequency = frequency;
     ctx->initialized = false;
+    ctx->resend_mask = 0;
+    ctx->queued_channel = PCA9685_NO_CHANNEL;
     
     // Perform software reset
     pca9685_software_reset(i2c_port);
@@ -70,13 +142,16 @@ bool pca9685_init(pca9685_t *ctx, i2c_inst_t *i2c_port, uint8_t address, uint8_t
         return false;
     }
     
+    // Channel writes below check the initialized flag
+    ctx->initialized = true;
+    
     // Initialize all channels to 0 (servos at neutral/off)
     if (!pca9685_set_all_servos(ctx, 90)) {  // Start at 90 degrees (center)
         PCA9685_PRINTF("PCA9685: Failed to initialize channels\n");
+        ctx->initialized = false;
         return false;
     }
     
-    ctx->initialized = true;
     PCA9685_PRINTF("PCA9685: Initialized at address 0x%02X, frequency %dHz\n", address, frequency);
     
     return true;
@@ -128,27 +203,17 @@ bool pca9685_set_pwm_frequency(pca9685_t *ctx, uint8_t frequency) {
 }
 
 bool pca9685_set_pwm(pca9685_t *ctx, uint8_t channel, uint16_t on_time, uint16_t off_time) {
-    if (!ctx || !ctx->initialized || channel > 15) {
+    if (!ctx || !ctx->initialized || channel >= PCA9685_NUM_CHANNELS) {
         return false;
     }
     
     // Clamp values to 12-bit
-    on_time &= 0x0FFF;
-    off_time &= 0x0FFF;
-    
-    // Calculate register address for this channel
-    uint8_t reg_base = PCA9685_LED0_ON_L + (channel * 4);
+    ctx->channel_on[channel] = on_time & 0x0FFF;
+    ctx->channel_off[channel] = off_time & 0x0FFF;
+    ctx->resend_mask |= 1u << channel;
     
-    // Write all 4 bytes (ON_L, ON_H, OFF_L, OFF_H) using auto-increment
-    uint8_t buffer[5];
-    buffer[0] = reg_base;
-    buffer[1] = on_time & 0xFF;         // ON_L
-    buffer[2] = (on_time >> 8) & 0x0F;  // ON_H
-    buffer[3] = off_time & 0xFF;        // OFF_L
-    buffer[4] = (off_time >> 8) & 0x0F; // OFF_H
-    
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, 5, false);
-    return result == 5;
+    // Channels still owed from a failed write go out first
+    return pca9685_send_channels(ctx);
 }
 
 bool pca9685_set_servo_pulse(pca9685_t *ctx, uint8_t channel, uint16_t pulse_us) {
@@ -204,16 +269,20 @@ bool pca9685_set_all_servos(pca9685_t *ctx, uint16_t degrees) {
     float count_per_us = 4096.0f / pulse_length;
     uint16_t off_time = (uint16_t)(pulse_us * count_per_us + 0.5f);
     
-    // Write to ALL_LED registers
-    uint8_t buffer[5];
-    buffer[0] = PCA9685_ALL_LED_ON_L;
-    buffer[1] = 0;                          // ALL_LED_ON_L
-    buffer[2] = 0;                          // ALL_LED_ON_H
-    buffer[3] = off_time & 0xFF;            // ALL_LED_OFF_L
-    buffer[4] = (off_time >> 8) & 0x0F;     // ALL_LED_OFF_H
+    for (uint8_t channel = 0; channel < PCA9685_NUM_CHANNELS; channel++) {
+        ctx->channel_on[channel] = 0;
+        ctx->channel_off[channel] = off_time & 0x0FFF;
+    }
     
-    int result = i2c_write_blocking(ctx->i2c_port, ctx->address, buffer, 5, false);
-    return result == 5;
+    // Write to ALL_LED registers; if that fails, every channel is owed
+    if (pca9685_write_channel(ctx, PCA9685_ALL_LED_ON_L, 0, off_time)) {
+        ctx->resend_mask = 0;
+        ctx->queued_channel = PCA9685_ALL_CHANNELS;
+        return true;
+    }
+    ctx->resend_mask = 0xFFFF;
+    pca9685_settle_queued(ctx, false);
+    return pca9685_send_channels(ctx);
 }
 
 bool pca9685_reset(pca9685_t *ctx) {
@@ -34,6 +34,9 @@
 #define PCA9685_MODE2_OUTDRV 0x04  // Totem pole (vs open drain)
 #define PCA9685_MODE2_INVRT 0x10   // Invert output
 
+// Number of PWM channels
+#define PCA9685_NUM_CHANNELS 16
+
 // PWM frequency settings
 #define PCA9685_INTERNAL_CLOCK 25000000  // 25MHz internal oscillator
 #define PCA9685_DEFAULT_FREQUENCY 50     // 50Hz for servos
@@ -50,6 +53,10 @@ typedef struct {
     uint8_t address;         // I2C address of PCA9685
     uint8_t frequency;       // PWM frequency in Hz
     bool initialized;        // Initialization flag
+    uint16_t channel_on[PCA9685_NUM_CHANNELS];   // Last ON time requested per channel
+    uint16_t channel_off[PCA9685_NUM_CHANNELS];  // Last OFF time requested per channel
+    uint16_t resend_mask;    // Channels whose last request may not have reached the chip
+    uint8_t queued_channel;  // Channel of the last write the bus took (write-behind: not yet ACKed)
 } pca9685_t;
 
 /**
@@ -74,6 +81,11 @@ bool pca9685_set_pwm_frequency(pca9685_t *ctx, uint8_t frequency);
 
 /**
  * Set PWM duty cycle for a channel
+ *
+ * The values are kept per channel. On a PIO bus a write only queues the
+ * transfer, and a NAK on it fails the next write instead, which is not
+ * sent either; when a write fails, both channels are sent again (once
+ * straight away, then with the next call until they get through).
  * 
  * @param ctx Pointer to PCA9685 context structure
  * @param channel Channel number (0-15)
@@ -1,4 +1,5 @@
 #include "i2c_pca9685_midi.h"
+#include "i2c_bus.h"
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include <stdio.h>
@@ -91,12 +92,16 @@ bool pca9685_midi_init_with_config(pca9685_midi_t *ctx, pca9685_midi_config_t *c
     ctx->config.high_note = calculate_high_note(ctx->config.low_note, ctx->config.note_range, 
                                                  ctx->config.semitone_mode);
     
-    // Initialize I2C
-    i2c_init(config->i2c_port, i2c_speed);
-    gpio_set_function(sda_pin, GPIO_FUNC_I2C);
-    gpio_set_function(scl_pin, GPIO_FUNC_I2C);
-    gpio_pull_up(sda_pin);
-    gpio_pull_up(scl_pin);
+    // Initialize I2C (no-op if the bus is already shared with other devices)
+    // and run the PCA9685 at its own speed, up to 1MHz Fast-mode Plus
+    if (!i2c_bus_init(config->i2c_port, sda_pin, scl_pin, i2c_speed)) {
+        PCA9685_MIDI_PRINTF("PCA9685_MIDI: Failed to initialize I2C bus\n");
+        return false;
+    }
+    i2c_bus_set_device_speed(config->i2c_port, config->i2c_address, i2c_speed);
+    if (config->pio_bus != I2C_BUS_ROUTE_HW) {
+        i2c_bus_route_device(config->i2c_port, config->i2c_address, config->pio_bus);
+    }
     
     // Initialize PCA9685 driver
     if (!pca9685_init(&ctx->pca9685, config->i2c_port, config->i2c_address, PCA9685_DEFAULT_FREQUENCY)) {
@@ -49,6 +49,7 @@ typedef struct {
     i2c_inst_t *i2c_port;                         // I2C port (i2c0 or i2c1)
     pca9685_midi_semitone_mode_t semitone_mode;   // How to handle semitone notes
     pca9685_strike_mode_t strike_mode;            // How servos strike notes
+    uint8_t pio_bus;                              // 0 = hardware I2C, 1-4 = PIO I2C bus (USE_PIO_I2C)
     
     // Strike mode angles (for SIMPLE mode)
     uint16_t rest_angle;                          // Servo rest position (default 30°)
@@ -87,7 +88,7 @@ typedef struct {
  * @param i2c_port I2C port to use (i2c0 or i2c1)
  * @param sda_pin GPIO pin for I2C SDA
  * @param scl_pin GPIO pin for I2C SCL
- * @param i2c_speed I2C speed in Hz (typically 100000 or 400000)
+ * @param i2c_speed I2C speed in Hz for the PCA9685 (100000, 400000 or 1000000)
  * @return true if initialization successful, false otherwise
  */
 bool pca9685_midi_init(pca9685_midi_t *ctx, i2c_inst_t *i2c_port, uint8_t sda_pin, uint8_t scl_pin, uint32_t i2c_speed);
@@ -99,7 +100,8 @@ bool pca9685_midi_init(pca9685_midi_t *ctx, i2c_inst_t *i2c_port, uint8_t sda_pi
  * @param config Pointer to configuration structure
  * @param sda_pin GPIO pin for I2C SDA
  * @param scl_pin GPIO pin for I2C SCL
- * @param i2c_speed I2C speed in Hz
+ * @param i2c_speed I2C speed in Hz for the PCA9685; also the bus default
+ *                  if the bus has not been initialized yet
  * @return true if initialization successful, false otherwise
  */
 bool pca9685_midi_init_with_config(pca9685_midi_t *ctx, pca9685_midi_config_t *config, 
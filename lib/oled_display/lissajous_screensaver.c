@@ -1,6 +1,5 @@
 #include "lissajous_screensaver.h"
 #include "oled_display.h"
-#include <math.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -11,6 +10,10 @@
 #define LISSAJOUS_POINTS 500        // Number of points to draw per frame
 #define LISSAJOUS_TIME_STEP 0.01f   // Time step between points
 #define LISSAJOUS_TIME_INCREMENT 0.02f  // Time increment per frame
+#define LISSAJOUS_MAX_SEGMENT 20    // Longer jumps between points are not joined
+
+// Angles are 32-bit fixed point: 2^32 is one full turn, so they wrap for free
+#define ANGLE_PER_RADIAN 683565275.6f   // 2^32 / (2 * pi)
 
 // Parameter change probability (1/N chance per frame)
 #define PARAM_CHANGE_PROBABILITY 200
@@ -28,10 +31,92 @@ typedef struct {
     uint8_t hue;    // Color hue (for future color displays, unused on monochrome)
 } lissajous_params_t;
 
+// Fixed-point form of the parameters, used for drawing
+typedef struct {
+    int32_t amp_x;          // A in pixels
+    int32_t amp_y;          // B in pixels
+    uint32_t step_x;        // Angle a * t advances per point
+    uint32_t step_y;        // Angle b * t advances per point
+    uint32_t frame_x;       // ... and per frame
+    uint32_t frame_y;
+} lissajous_fixed_t;
+
 static lissajous_params_t params;
-static float current_time = 0.0f;
+static lissajous_fixed_t fixed;
+static uint32_t phase_x = 0;    // a * t + delta at the first point of the frame
+static uint32_t phase_y = 0;    // b * t at the first point of the frame
+
+// Curve layer state: the frame's starting angles and the parameters
+typedef struct {
+    uint32_t phase_x;
+    uint32_t phase_y;
+    lissajous_fixed_t fixed;
+} lissajous_curve_t;
 static uint32_t frame_count = 0;
 
+//--------------------------------------------------------------------+
+// Fixed-Point Sine
+//--------------------------------------------------------------------+
+
+// sin(i * pi / 512) in Q15 for the first quarter wave, plus its end point
+static const int16_t sine_quarter[257] = {
+        0,   201,   402,   603,   804,  1005,  1206,  1407,  1608,  1809,  2009,  2210,
+     2410,  2611,  2811,  3012,  3212,  3412,  3612,  3811,  4011,  4210,  4410,  4609,
+     4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,  6393,  6590,  6786,  6983,
+     7179,  7375,  7571,  7767,  7962,  8157,  8351,  8545,  8739,  8933,  9126,  9319,
+     9512,  9704,  9896, 10087, 10278, 10469, 10659, 10849, 11039, 11228, 11417, 11605,
+    11793, 11980, 12167, 12353, 12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+    14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269, 15446, 15623, 15800, 15976,
+    16151, 16325, 16499, 16673, 16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+    18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357, 19519, 19680, 19841, 20000,
+    20159, 20317, 20475, 20631, 20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+    22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027, 23170, 23311, 23452, 23592,
+    23731, 23870, 24007, 24143, 24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+    25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198, 26319, 26438, 26556, 26674,
+    26790, 26905, 27019, 27133, 27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+    28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803, 28898, 28992, 29085, 29177,
+    29268, 29358, 29447, 29534, 29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+    30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783, 30852, 30919, 30985, 31050,
+    31113, 31176, 31237, 31297, 31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+    31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098, 32137, 32176, 32213, 32250,
+    32285, 32318, 32351, 32382, 32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+    32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717, 32728, 32737, 32745, 32752,
+    32757, 32761, 32765, 32766, 32767
+};
+
+/**
+ * Sine of a 32-bit angle in Q15
+ *
+ * Quarter-wave table, mirrored for the other quadrants, with linear
+ * interpolation on the next 8 bits of the angle.
+ */
+static int32_t sine_q15(uint32_t angle) {
+    uint32_t quadrant = angle >> 30;
+    uint32_t offset = angle & 0x3FFFFFFF;
+    if (quadrant & 1) {
+        offset = 0x40000000 - offset;   // Falling half of each lobe
+    }
+    
+    uint32_t index = offset >> 22;
+    int32_t value = sine_quarter[index];
+    if (index < 256) {
+        uint32_t frac = (offset >> 14) & 0xFF;
+        value += ((sine_quarter[index + 1] - value) * (int32_t)frac) >> 8;
+    }
+    return (quadrant & 2) ? -value : value;
+}
+
+// amplitude * sin, truncated toward zero like the float (int) cast
+static inline int32_t scale_q15(int32_t amplitude, int32_t sine) {
+    int32_t product = amplitude * sine;
+    return product >= 0 ? (product >> 15) : -((-product) >> 15);
+}
+
+// Float angle in radians to fixed point (wraps modulo one turn)
+static uint32_t angle_from_radians(float radians) {
+    return (uint32_t)(int64_t)(radians * ANGLE_PER_RADIAN);
+}
+
 //--------------------------------------------------------------------+
 // Random Number Generator (simple LCG)
 //--------------------------------------------------------------------+
@@ -78,6 +163,44 @@ static void generate_random_params(void) {
     
     // Color hue (for future use with color displays)
     params.hue = lissajous_rand_int(0, 255);
+    
+    fixed.amp_x = (int32_t)params.A;
+    fixed.amp_y = (int32_t)params.B;
+    fixed.step_x = angle_from_radians(params.a * LISSAJOUS_TIME_STEP);
+    fixed.step_y = angle_from_radians(params.b * LISSAJOUS_TIME_STEP);
+    fixed.frame_x = angle_from_radians(params.a * LISSAJOUS_TIME_INCREMENT);
+    fixed.frame_y = angle_from_radians(params.b * LISSAJOUS_TIME_INCREMENT);
+}
+
+// Restart the curve at t = 0 for the current parameters
+static void reset_phase(void) {
+    phase_x = angle_from_radians(params.delta);
+    phase_y = 0;
+}
+
+/**
+ * Integer Bresenham line, endpoints included
+ */
+static void draw_line(int x0, int y0, int x1, int y1) {
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    
+    while (true) {
+        oled_set_pixel(x0, y0, 1);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
 }
 
 //--------------------------------------------------------------------+
@@ -91,40 +214,34 @@ void lissajous_screensaver_init(void) {
     // Generate initial parameters
     generate_random_params();
     
-    current_time = 0.0f;
+    reset_phase();
     frame_count = 0;
 }
 
-void lissajous_screensaver_update(void) {
-    // Occasionally change parameters for variety
-    if ((lissajous_rand() % PARAM_CHANGE_PROBABILITY) == 0) {
-        generate_random_params();
-        current_time = 0.0f;  // Reset time for smooth transition
-    }
-    
-    // Clear display
-    oled_clear();
+/**
+ * Draw the curve from the frame's starting angles
+ *
+ * A layer (see oled_draw_layer()), so it only reads its copy of the curve.
+ */
+static void draw_curve(const void* state) {
+    const lissajous_curve_t* curve = state;
     
     // Calculate center of display
     const int center_x = OLED_WIDTH / 2;
     const int center_y = OLED_HEIGHT / 2;
     
     // Draw Lissajous curve
+    // x = A * sin(a * t + delta), y = B * sin(b * t), stepping both angles
     int prev_x = -1;
     int prev_y = -1;
+    uint32_t angle_x = curve->phase_x;
+    uint32_t angle_y = curve->phase_y;
     
     for (int i = 0; i < LISSAJOUS_POINTS; i++) {
-        float t = current_time + i * LISSAJOUS_TIME_STEP;
-        
-        // Lissajous parametric equations
-        // x = A * sin(a * t + delta)
-        // y = B * sin(b * t)
-        float x = params.A * sinf(params.a * t + params.delta);
-        float y = params.B * sinf(params.b * t);
-        
-        // Convert to screen coordinates
-        int screen_x = center_x + (int)x;
-        int screen_y = center_y + (int)y;
+        int screen_x = center_x + scale_q15(curve->fixed.amp_x, sine_q15(angle_x));
+        int screen_y = center_y + scale_q15(curve->fixed.amp_y, sine_q15(angle_y));
+        angle_x += curve->fixed.step_x;
+        angle_y += curve->fixed.step_y;
         
         // Clamp to display bounds
         if (screen_x < 0) screen_x = 0;
@@ -132,40 +249,39 @@ void lissajous_screensaver_update(void) {
         if (screen_y < 0) screen_y = 0;
         if (screen_y >= OLED_HEIGHT) screen_y = OLED_HEIGHT - 1;
         
-        // Draw pixel
-        oled_set_pixel(screen_x, screen_y, 1);
-        
-        // Draw line from previous point for smoother curve
-        if (prev_x >= 0) {
-            // Simple line drawing using Bresenham's algorithm
-            int dx = screen_x - prev_x;
-            int dy = screen_y - prev_y;
-            int steps = (abs(dx) > abs(dy)) ? abs(dx) : abs(dy);
-            
-            if (steps > 0 && steps < 20) {  // Only draw if distance is reasonable
-                for (int j = 0; j <= steps; j++) {
-                    int x_line = prev_x + (dx * j) / steps;
-                    int y_line = prev_y + (dy * j) / steps;
-                    
-                    if (x_line >= 0 && x_line < OLED_WIDTH && 
-                        y_line >= 0 && y_line < OLED_HEIGHT) {
-                        oled_set_pixel(x_line, y_line, 1);
-                    }
-                }
-            }
+        // Join to the previous point for a smoother curve
+        int dx = abs(screen_x - prev_x);
+        int dy = abs(screen_y - prev_y);
+        if (prev_x >= 0 && (dx > dy ? dx : dy) < LISSAJOUS_MAX_SEGMENT) {
+            draw_line(prev_x, prev_y, screen_x, screen_y);
+        } else {
+            oled_set_pixel(screen_x, screen_y, 1);
         }
         
         prev_x = screen_x;
         prev_y = screen_y;
     }
+}
+
+void lissajous_screensaver_update(void) {
+    // Occasionally change parameters for variety
+    if ((lissajous_rand() % PARAM_CHANGE_PROBABILITY) == 0) {
+        generate_random_params();
+        reset_phase();  // Reset time for smooth transition
+    }
     
-    // Update time
-    current_time += LISSAJOUS_TIME_INCREMENT;
+    // Clear display and draw this frame's curve
+    lissajous_curve_t curve = {
+        .phase_x = phase_x,
+        .phase_y = phase_y,
+        .fixed = fixed,
+    };
+    oled_clear();
+    oled_draw_layer(draw_curve, &curve, sizeof(curve));
     
-    // Keep time in reasonable range to avoid float overflow
-    if (current_time > 1000.0f) {
-        current_time = 0.0f;
-    }
+    // Update time
+    phase_x += fixed.frame_x;
+    phase_y += fixed.frame_y;
     
     frame_count++;
     
@@ -1,9 +1,13 @@
 #include "oled_display.h"
-#include "hardware/i2c.h"
+#include "oled_transport.h"
+#include "pico/time.h"
+#include "../../src/debug_uart.h"
 #include <string.h>
 #include <stdio.h>
 
 // SSD1306 Commands
+#define SSD1306_SETLOWCOLUMN        0x00  // Page addressing: column bits 0-3
+#define SSD1306_SETHIGHCOLUMN       0x10  // Page addressing: column bits 4-7
 #define SSD1306_MEMORYMODE          0x20
 #define SSD1306_COLUMNADDR          0x21
 #define SSD1306_PAGEADDR            0x22
@@ -23,10 +27,118 @@
 #define SSD1306_SETPRECHARGE        0xD9
 #define SSD1306_SETCOMPINS          0xDA
 #define SSD1306_SETVCOMDETECT       0xDB
+#define SSD1306_SETPAGESTART        0xB0  // Page addressing: page 0-7
+#define SSD1306_SETSTARTLINE        0x40  // RAM row shown on the first line: 0x40 | row
 
-// Display buffer
-static uint8_t oled_buffer[OLED_WIDTH * OLED_PAGES];
-static i2c_inst_t* i2c_instance = NULL;
+#define SSD1306_ADDR_MODE_PAGE      0x02
+
+// Flush transfer sizing
+#define OLED_FLUSH_MIN_CHUNK        8     // Bytes sent per step even when over budget
+
+static uint32_t bus_speed_hz = 0;
+
+#ifdef OLED_TILE_MODE
+// Display list entries: a type byte, then the fields below (x and y as for
+// the draw call that recorded them)
+#define DL_TEXT          1    // x, y, length, characters
+#define DL_TEXT_INVERTED 2
+#define DL_RECT          3    // x, y, width, height, color
+#define DL_COLUMNS       4    // x, y, count, pointer to the columns
+#define DL_COLUMNS_INVERTED 5
+#define DL_LAYER         6    // Pointer to the layer's draw function, state size, state
+
+#define OLED_DL_BYTES    256  // Per list; the busiest screen needs about 200
+#define OLED_LAYER_STATE_MAX 132  // Largest layer state (the piano roll's)
+#define OLED_TILE_CHUNK  8    // Columns per change check
+#define OLED_TILE_CHUNKS (OLED_WIDTH / OLED_TILE_CHUNK)
+
+typedef struct {
+    uint8_t data[OLED_DL_BYTES];
+    uint16_t length;
+    uint16_t last;            // Offset of the last entry, which may still grow
+    bool border;
+} display_list_t;
+
+// Draw calls are recorded in the back list; oled_display() commits it to
+// the front list, which pages are rendered from as they go out
+static display_list_t dl_back;
+static display_list_t dl_front;
+static bool dl_overflow = false;          // Reported once per screen
+
+// The page being rendered or sent. Column x is at [x + 1]; the spare byte
+// in front lets a span go out in place behind its data control byte.
+static uint8_t tile[OLED_WIDTH + 1];
+static uint8_t tile_page = OLED_PAGES;    // Page in tile (OLED_PAGES = none)
+static uint8_t render_page = OLED_PAGES;  // Draw calls write to tile while set
+
+// CRC of each chunk of columns as last sent: what the panel holds
+static uint16_t tile_crc[OLED_PAGES][OLED_TILE_CHUNKS];
+static bool front_valid = false;
+
+// CRC of the committed entries that reach each page. A page whose entries
+// changed is rendered once, when the flush gets to it, and only its chunks
+// that no longer match the panel go out.
+static uint16_t page_crc[OLED_PAGES];
+static uint8_t check_pages = 0;           // Bit per page still to render and compare
+static uint8_t resend_pages = 0;          // ... whose chunks all go out (panel RAM unknown)
+
+// Aligned copy of the state of the layer being rendered
+static uint32_t layer_state[OLED_LAYER_STATE_MAX / sizeof(uint32_t)];
+#else
+// Back buffer - everything draws here
+static uint8_t oled_buffer[OLED_PAGES][OLED_WIDTH];
+
+// Columns drawn since the last commit, per page (start > end = clean)
+static uint8_t dirty_start[OLED_PAGES];
+static uint8_t dirty_end[OLED_PAGES];
+
+// Front buffer - the committed frame, and the panel RAM once it is flushed.
+// Column x of a page is at [page][x + 1]; the spare byte in front of each
+// page lets a span go out in place behind its data control byte.
+static uint8_t oled_front[OLED_PAGES][OLED_WIDTH + 1];
+static bool front_valid = false;
+#endif
+
+// Flush in flight: column span of each page still to send
+static uint8_t flush_start[OLED_PAGES];
+static uint8_t flush_end[OLED_PAGES];
+static uint8_t flush_page = OLED_PAGES;   // OLED_PAGES = idle
+static bool commit_pending = false;       // oled_display() called during a flush
+
+// Display start line: drawn, committed with the frame, and on the panel.
+// The panel's only changes once the frame's data is sent, so it never
+// scrolls ahead of what it shows.
+static uint8_t back_start_line = 0;
+static uint8_t front_start_line = 0;
+static uint8_t panel_start_line = 0;
+
+// Piano roll: lanes across, one RAM row per tick (see oled_piano_roll_tick())
+static uint8_t roll_lanes = 0;
+static uint8_t roll_head = 0;             // RAM row the next tick writes
+
+#ifdef OLED_TILE_MODE
+// Roll layer state: lanes across and the lanes lit in each RAM row
+typedef struct {
+    uint8_t lanes;
+    uint16_t rows[OLED_HEIGHT];
+} roll_layer_t;
+
+static roll_layer_t roll_layer;
+#endif
+
+// Bouncing balls are on screen at their last positions (oled_clear() wipes them)
+static bool balls_drawn = false;
+
+static uint32_t clear_count = 0;
+static uint32_t frame_count = 0;          // Commits that changed the front buffer
+
+// Panel write position after the last data transfer (page OLED_PAGES = unknown)
+static uint8_t cursor_page = OLED_PAGES;
+static uint8_t cursor_col = 0;
+
+// Per-step budget (0 = unlimited, both 0 = oled_display() flushes at once)
+static uint32_t budget_bytes = 0;
+static uint32_t budget_us = 0;
 
 // Simple 5x7 font (ASCII 32-127)
 static const uint8_t font5x7[][5] = {
@@ -132,61 +244,320 @@ static const char* note_names[] = {
     "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"
 };
 
-// Send command to SSD1306
-static void oled_send_command(uint8_t cmd) {
-    uint8_t buf[2] = {0x00, cmd};
-    i2c_write_blocking(i2c_instance, OLED_I2C_ADDRESS, buf, 2, false);
-}
-
-// Send data to SSD1306
-static void oled_send_data(const uint8_t* data, size_t len) {
-    uint8_t buf[len + 1];
-    buf[0] = 0x40;
-    memcpy(&buf[1], data, len);
-    i2c_write_blocking(i2c_instance, OLED_I2C_ADDRESS, buf, len + 1, false);
-}
-
-bool oled_init(void* i2c_inst) {
-    i2c_instance = (i2c_inst_t*)i2c_inst;
-    
-    // Initialization sequence
-    oled_send_command(SSD1306_DISPLAYOFF);
-    oled_send_command(SSD1306_SETDISPLAYCLOCKDIV);
-    oled_send_command(0x80);
-    oled_send_command(SSD1306_SETMULTIPLEX);
-    oled_send_command(OLED_HEIGHT - 1);
-    oled_send_command(SSD1306_SETDISPLAYOFFSET);
-    oled_send_command(0x00);
-    oled_send_command(0x40); // Set start line
-    oled_send_command(SSD1306_CHARGEPUMP);
-    oled_send_command(0x14);
-    oled_send_command(SSD1306_MEMORYMODE);
-    oled_send_command(0x00); // Horizontal addressing mode
-    oled_send_command(SSD1306_SEGREMAP | 0x01);
-    oled_send_command(SSD1306_COMSCANDEC);
-    oled_send_command(SSD1306_SETCOMPINS);
-    oled_send_command(0x12);
-    oled_send_command(SSD1306_SETCONTRAST);
-    oled_send_command(0xCF);
-    oled_send_command(SSD1306_SETPRECHARGE);
-    oled_send_command(0xF1);
-    oled_send_command(SSD1306_SETVCOMDETECT);
-    oled_send_command(0x40);
-    oled_send_command(SSD1306_DISPLAYALLON_RESUME);
-    oled_send_command(SSD1306_NORMALDISPLAY);
-    oled_send_command(SSD1306_DISPLAYON);
+// Initialization sequence, sent as a single command stream
+static const uint8_t oled_init_sequence[] = {
+    SSD1306_CONTROL_COMMAND,
+    SSD1306_DISPLAYOFF,
+    SSD1306_SETDISPLAYCLOCKDIV, 0x80,
+    SSD1306_SETMULTIPLEX, OLED_HEIGHT - 1,
+    SSD1306_SETDISPLAYOFFSET, 0x00,
+    SSD1306_SETSTARTLINE | 0,
+    SSD1306_CHARGEPUMP, 0x14,
+    SSD1306_MEMORYMODE, SSD1306_ADDR_MODE_PAGE, // Page addressing, flushes go page by page
+    SSD1306_SEGREMAP | 0x01,
+    SSD1306_COMSCANDEC,
+    SSD1306_SETCOMPINS, 0x12,
+    SSD1306_SETCONTRAST, 0xCF,
+    SSD1306_SETPRECHARGE, 0xF1,
+    SSD1306_SETVCOMDETECT, 0x40,
+    SSD1306_DISPLAYALLON_RESUME,
+    SSD1306_NORMALDISPLAY,
+    SSD1306_DISPLAYON,
+};
+
+#ifdef OLED_TILE_MODE
+static void render_tile(uint8_t page);
+static bool dl_entry_bounds(const uint8_t* entry, int16_t* x0, int16_t* y0, int16_t* x1, int16_t* y1);
+static uint16_t dl_entry_size(const uint8_t* entry);
+
+/**
+ * CRC-16/CCITT, continuing from crc (0xFFFF to start)
+ *
+ * Any change within two neighbouring bytes (a burst of 16 bits or less)
+ * always changes the CRC, which covers most of what moves between frames.
+ */
+static uint16_t crc16(uint16_t crc, const uint8_t* data, uint16_t len) {
+    // A byte at a time: the polynomial 0x1021 folded into shifts
+    for (uint16_t i = 0; i < len; i++) {
+        uint16_t x = (crc >> 8) ^ data[i];
+        x ^= x >> 4;
+        crc = (uint16_t)((crc << 8) ^ (x << 12) ^ (x << 5) ^ x);
+    }
+    return crc;
+}
+
+// CRC of the committed entries that can reach a page (the columns an
+// entry points to count as part of it)
+static uint16_t page_entries_crc(uint8_t page) {
+    uint16_t crc = crc16(0xFFFF, (const uint8_t*)&dl_front.border, sizeof(dl_front.border));
+    
+    uint16_t at = 0;
+    while (at < dl_front.length) {
+        const uint8_t* entry = &dl_front.data[at];
+        uint16_t size = dl_entry_size(entry);
+        at += size;
+        
+        int16_t x0, y0, x1, y1;
+        if (dl_entry_bounds(entry, &x0, &y0, &x1, &y1) && (y1 / 8 < page || y0 / 8 > page)) {
+            continue;
+        }
+        crc = crc16(crc, entry, size);
+        if (entry[0] == DL_COLUMNS || entry[0] == DL_COLUMNS_INVERTED) {
+            const uint8_t* columns;
+            memcpy(&columns, &entry[4], sizeof(columns));
+            crc = crc16(crc, columns, entry[3]);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Commit the back list and start flushing the pages whose entries changed
+ *
+ * Nothing is rendered here: each of those pages is rendered when the flush
+ * reaches it (see check_page()).
+ */
+static void commit_frame(void) {
+    bool changed = front_start_line != back_start_line;
+    
+    dl_front = dl_back;
+    tile_page = OLED_PAGES;
+    check_pages = 0;
+    resend_pages = front_valid ? 0 : (uint8_t)((1u << OLED_PAGES) - 1);
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        uint16_t crc = page_entries_crc(page);
+        if (!front_valid || crc != page_crc[page]) {
+            page_crc[page] = crc;
+            check_pages |= 1u << page;
+            changed = true;
+        }
+        flush_start[page] = 0xFF;
+        flush_end[page] = 0;
+    }
+    front_start_line = back_start_line;
+    front_valid = true;
+    commit_pending = false;
+    if (changed) {
+        frame_count++;
+    }
+    flush_page = 0;
+}
+
+/**
+ * Render a page of the committed frame and set its flush span to the
+ * chunks that no longer match what the panel holds
+ */
+static void check_page(uint8_t page) {
+    uint8_t bit = 1u << page;
+    uint8_t start = 0xFF;
+    uint8_t end = 0;
+    
+    render_tile(page);
+    for (uint8_t chunk = 0; chunk < OLED_TILE_CHUNKS; chunk++) {
+        uint16_t crc = crc16(0xFFFF, &tile[1 + chunk * OLED_TILE_CHUNK], OLED_TILE_CHUNK);
+        if ((resend_pages & bit) || crc != tile_crc[page][chunk]) {
+            tile_crc[page][chunk] = crc;
+            if (start > end) start = chunk * OLED_TILE_CHUNK;
+            end = chunk * OLED_TILE_CHUNK + OLED_TILE_CHUNK - 1;
+        }
+    }
+    flush_start[page] = start;
+    flush_end[page] = end;
+    check_pages &= ~bit;
+    resend_pages &= ~bit;
+}
+
+// Committed page to send from, column x at [x + 1]
+static uint8_t* frame_row(uint8_t page) {
+    if (tile_page != page) {
+        render_tile(page);
+    }
+    return tile;
+}
+#else
+// Mark a column of a page as changed
+static inline void mark_dirty(uint8_t page, uint8_t x) {
+    if (x < dirty_start[page]) dirty_start[page] = x;
+    if (x > dirty_end[page]) dirty_end[page] = x;
+}
+
+/**
+ * Copy the changed columns of the back buffer into the front buffer and
+ * start flushing them
+ */
+static void commit_frame(void) {
+    bool changed = front_start_line != back_start_line;
+    
+    oled_transport_wait();      // The last span may still be going out
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        uint8_t start = dirty_start[page];
+        uint8_t end = dirty_end[page];
+        const uint8_t* row = oled_buffer[page];
+        uint8_t* front = &oled_front[page][1];
+        
+        // Screens are redrawn from scratch; trim columns that came out the same
+        if (front_valid && start <= end) {
+            while (start <= end && row[start] == front[start]) start++;
+            while (start <= end && row[end] == front[end]) end--;
+        }
+        if (start <= end) {
+            memcpy(&front[start], &row[start], end - start + 1);
+            changed = true;
+        }
+        flush_start[page] = start;
+        flush_end[page] = end;
+    }
+    memset(dirty_start, 0xFF, sizeof(dirty_start));
+    memset(dirty_end, 0, sizeof(dirty_end));
+    front_start_line = back_start_line;
+    front_valid = true;
+    commit_pending = false;
+    if (changed) {
+        frame_count++;
+    }
+    flush_page = 0;
+}
+
+// Committed page to send from, column x at [x + 1]
+static uint8_t* frame_row(uint8_t page) {
+    return oled_front[page];
+}
+#endif
+
+/**
+ * Send the next piece of the frame in flight
+ *
+ * @param max_len Most data bytes to send
+ * @return Data bytes sent, 0 once the frame is complete
+ */
+static uint32_t flush_chunk(uint32_t max_len) {
+    while (flush_page < OLED_PAGES) {
+#ifdef OLED_TILE_MODE
+        if (check_pages & (1u << flush_page)) {
+            check_page(flush_page);
+        }
+#endif
+        if (flush_start[flush_page] <= flush_end[flush_page]) {
+            break;
+        }
+        flush_page++;
+    }
+    if (flush_page == OLED_PAGES) {
+        // Frame data is out; now the panel may show it at the new offset
+        if (panel_start_line != front_start_line) {
+            const uint8_t start_line[] = {
+                SSD1306_CONTROL_COMMAND,
+                SSD1306_SETSTARTLINE | front_start_line,
+            };
+            oled_transport_send(start_line, sizeof(start_line));
+            panel_start_line = front_start_line;
+        }
+        return 0;
+    }
+    
+    uint8_t page = flush_page;
+    uint8_t start = flush_start[page];
+    uint32_t len = flush_end[page] - start + 1;
+    if (len > max_len) {
+        len = max_len;
+    }
+    
+    // A slice that picks up where the last one stopped needs no positioning
+    if (cursor_page != page || cursor_col != start) {
+        const uint8_t position[] = {
+            SSD1306_CONTROL_COMMAND,
+            SSD1306_SETPAGESTART | page,
+            SSD1306_SETLOWCOLUMN | (start & 0x0F),
+            SSD1306_SETHIGHCOLUMN | (start >> 4),
+        };
+        oled_transport_send(position, sizeof(position));
+    }
+    
+    // Send the span in one transfer, borrowing the byte in front of it
+    // (the column before, or the page's spare byte) for the control byte;
+    // the last span may still be going out from that byte
+    oled_transport_wait();
+    uint8_t* packet = &frame_row(page)[start];
+    uint8_t saved = *packet;
+    *packet = SSD1306_CONTROL_DATA;
+    oled_transport_send(packet, len + 1);
+    *packet = saved;
+    
+    // Page mode wraps to column 0 of the same page after the last column
+    cursor_page = page;
+    cursor_col = (start + len) % OLED_WIDTH;
+    
+    // Resume after the sent columns; start past end marks the page done
+    flush_start[page] = start + len;
+    return len;
+}
+
+bool oled_init(void* bus_inst) {
+    if (!oled_transport_init(bus_inst)) {
+        return false;
+    }
+    bus_speed_hz = oled_transport_get_speed_hz();
     
+    oled_transport_send(oled_init_sequence, sizeof(oled_init_sequence));
+    
+    // Panel RAM is undefined after power-up - send the whole frame once,
+    // dropping anything a previous init left in flight
+    flush_page = OLED_PAGES;
+    commit_pending = false;
+    cursor_page = OLED_PAGES;
+    panel_start_line = 0;
     oled_clear();
+    oled_invalidate();
     oled_display();
+    oled_display_flush();
     
     return true;
 }
 
 void oled_clear(void) {
-    memset(oled_buffer, 0, sizeof(oled_buffer));
+    // Every screen but the piano roll is drawn unscrolled
+    back_start_line = 0;
+    roll_lanes = 0;
+    balls_drawn = false;
+    clear_count++;
+    
+#ifdef OLED_TILE_MODE
+    dl_back.length = 0;
+    dl_back.border = false;
+    dl_overflow = false;
+#else
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        uint8_t* row = oled_buffer[page];
+        for (uint8_t x = 0; x < OLED_WIDTH; x++) {
+            if (row[x]) {
+                row[x] = 0;
+                mark_dirty(page, x);
+            }
+        }
+    }
+#endif
+}
+
+void oled_set_start_line(uint8_t line) {
+    back_start_line = line % OLED_HEIGHT;
+}
+
+void oled_invalidate(void) {
+#ifndef OLED_TILE_MODE
+    memset(dirty_start, 0, sizeof(dirty_start));
+    memset(dirty_end, OLED_WIDTH - 1, sizeof(dirty_end));
+#endif
+    front_valid = false;
 }
 
 void oled_draw_border(void) {
+#ifdef OLED_TILE_MODE
+    if (render_page == OLED_PAGES) {
+        dl_back.border = true;
+        return;
+    }
+#endif
+    
     // Draw top and bottom borders
     for (uint8_t x = 0; x < OLED_WIDTH; x++) {
         oled_set_pixel(x, 0, 1);                    // Top border
@@ -201,66 +572,453 @@ void oled_draw_border(void) {
 }
 
 void oled_display(void) {
-    oled_send_command(SSD1306_COLUMNADDR);
-    oled_send_command(0);
-    oled_send_command(OLED_WIDTH - 1);
-    oled_send_command(SSD1306_PAGEADDR);
-    oled_send_command(0);
-    oled_send_command(OLED_PAGES - 1);
+    // Never touch the front buffer while it is going out; the back buffer
+    // keeps its dirty spans and is committed when the flush completes
+    if (flush_page < OLED_PAGES) {
+        commit_pending = true;
+    } else {
+        commit_frame();
+    }
     
-    // Send buffer in chunks
-    for (int i = 0; i < sizeof(oled_buffer); i += 16) {
-        size_t chunk_size = (sizeof(oled_buffer) - i) < 16 ? (sizeof(oled_buffer) - i) : 16;
-        oled_send_data(&oled_buffer[i], chunk_size);
+    if (budget_bytes == 0 && budget_us == 0) {
+        oled_display_flush();
     }
 }
 
-void oled_set_pixel(uint8_t x, uint8_t y, uint8_t color) {
+void oled_set_flush_budget(uint32_t max_bytes, uint32_t max_us) {
+    budget_bytes = max_bytes;
+    budget_us = max_us;
+}
+
+bool oled_flush_step(void) {
+    uint32_t start_us = time_us_32();
+    uint32_t sent = 0;
+    
+    while (true) {
+        if (flush_page == OLED_PAGES) {
+            if (!commit_pending) {
+                return true;
+            }
+            commit_frame();
+        }
+        
+        // Size the next transfer to what is left of the budget
+        uint32_t max_len = OLED_WIDTH;
+        if (budget_bytes) {
+            uint32_t left = sent < budget_bytes ? budget_bytes - sent : 0;
+            if (left < max_len) max_len = left;
+        }
+        if (budget_us && bus_speed_hz) {
+            uint32_t elapsed = time_us_32() - start_us;
+            uint32_t left_us = elapsed < budget_us ? budget_us - elapsed : 0;
+            uint32_t left = (uint32_t)(((uint64_t)left_us * bus_speed_hz) / (OLED_TRANSPORT_BITS_PER_BYTE * 1000000ull));
+            left = left > 8 ? left - 8 : 0;   // Position command, address and control bytes
+            if (left < max_len) max_len = left;
+        }
+        if (max_len == 0 || (max_len < OLED_FLUSH_MIN_CHUNK && sent > 0)) {
+            return false;
+        }
+        if (max_len < OLED_FLUSH_MIN_CHUNK) {
+            max_len = OLED_FLUSH_MIN_CHUNK;   // Always make progress
+        }
+        
+        uint32_t len = flush_chunk(max_len);
+        if (len == 0) {
+            continue;   // Frame complete, commit the pending one if any
+        }
+        sent += len;
+    }
+}
+
+bool oled_flush_idle(void) {
+    return flush_page == OLED_PAGES && !commit_pending;
+}
+
+uint32_t oled_get_clear_count(void) {
+    return clear_count;
+}
+
+const uint8_t* oled_get_frame_page(uint8_t page) {
+    return &frame_row(page % OLED_PAGES)[1];
+}
+
+uint8_t oled_get_frame_start_line(void) {
+    return front_start_line;
+}
+
+uint32_t oled_get_frame_count(void) {
+    return frame_count;
+}
+
+uint32_t oled_get_bus_time_us(void) {
+    if (bus_speed_hz == 0) {
+        return 0;
+    }
+    return (uint32_t)((oled_transport_get_bits() * 1000000ull) / bus_speed_hz);
+}
+
+void oled_display_flush(void) {
+    while (flush_page < OLED_PAGES || commit_pending) {
+        if (flush_page == OLED_PAGES) {
+            commit_frame();
+        }
+        while (flush_chunk(OLED_WIDTH)) {
+        }
+    }
+    oled_transport_wait();
+}
+
+// Replace the bits of one buffer byte selected by mask
+static inline void write_cell(uint8_t page, uint8_t x, uint8_t bits, uint8_t mask) {
+#ifdef OLED_TILE_MODE
+    // Only the page being rendered exists
+    if (page != render_page) return;
+    uint8_t* cell = &tile[x + 1];
+    *cell = (*cell & ~mask) | (bits & mask);
+#else
+    uint8_t* cell = &oled_buffer[page][x];
+    uint8_t value = (*cell & ~mask) | (bits & mask);
+    if (value != *cell) {
+        *cell = value;
+        mark_dirty(page, x);
+    }
+#endif
+}
+
+/**
+ * Write an 8-pixel column (bit 0 = top) with its top at row y
+ *
+ * Only the pixels selected by mask change. A page-aligned column is a
+ * single byte; otherwise it straddles two pages.
+ */
+static inline void blit_column(uint8_t x, uint8_t y, uint8_t bits, uint8_t mask) {
     if (x >= OLED_WIDTH || y >= OLED_HEIGHT) return;
     
-    if (color) {
-        oled_buffer[x + (y / 8) * OLED_WIDTH] |= (1 << (y & 7));
+    uint8_t page = y / 8;
+    uint8_t shift = y & 7;
+    if (shift == 0) {
+        write_cell(page, x, bits, mask);
+        return;
+    }
+    
+    write_cell(page, x, (uint8_t)(bits << shift), (uint8_t)(mask << shift));
+    if (page + 1 < OLED_PAGES) {
+        write_cell(page + 1, x, bits >> (8 - shift), mask >> (8 - shift));
+    }
+}
+
+#ifdef OLED_TILE_MODE
+//--------------------------------------------------------------------+
+// Display List (tile mode)
+//--------------------------------------------------------------------+
+
+// Size in bytes of an entry
+static uint16_t dl_entry_size(const uint8_t* entry) {
+    switch (entry[0]) {
+        case DL_TEXT:
+        case DL_TEXT_INVERTED:    return 4 + entry[3];
+        case DL_RECT:             return 6;
+        case DL_COLUMNS:
+        case DL_COLUMNS_INVERTED: return 4 + sizeof(const uint8_t*);
+        default:                  return 2 + sizeof(oled_layer_fn_t) + entry[1 + sizeof(oled_layer_fn_t)];
+    }
+}
+
+/**
+ * Rows and columns an entry can touch (inclusive)
+ *
+ * @return false for a layer, which may draw anywhere
+ */
+static bool dl_entry_bounds(const uint8_t* entry, int16_t* x0, int16_t* y0, int16_t* x1, int16_t* y1) {
+    *x0 = entry[1];
+    *y0 = entry[2] + 1;     // Text and columns start one row down
+    *y1 = entry[2] + 8;
+    switch (entry[0]) {
+        case DL_TEXT:
+        case DL_TEXT_INVERTED:
+            *x1 = entry[1] + 6 * entry[3] - 1;
+            return true;
+        case DL_RECT:
+            *x1 = entry[1] + entry[3] - 1;
+            *y0 = entry[2];
+            *y1 = entry[2] + entry[4] - 1;
+            return true;
+        case DL_COLUMNS:
+        case DL_COLUMNS_INVERTED:
+            *x1 = entry[1] + entry[3] - 1;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Start a new entry at the end of the back list (NULL if it is full)
+static uint8_t* dl_append(uint8_t type, uint16_t size) {
+    if (dl_back.length + size > OLED_DL_BYTES) {
+        if (!dl_overflow) {
+            debug_error("OLED: Display list full, drawing dropped");
+            dl_overflow = true;
+        }
+        return NULL;
+    }
+    uint8_t* entry = &dl_back.data[dl_back.length];
+    entry[0] = type;
+    dl_back.last = dl_back.length;
+    dl_back.length += size;
+    return entry;
+}
+
+// The last entry, if it has the given type and may still grow
+static uint8_t* dl_last(uint8_t type) {
+    if (dl_back.length == 0 || dl_back.data[dl_back.last] != type) {
+        return NULL;
+    }
+    return &dl_back.data[dl_back.last];
+}
+
+/**
+ * Drop the entries the last (opaque) entry paints over completely, so
+ * redrawing part of a screen without clearing it does not fill the list
+ */
+static void dl_prune_under_last(void) {
+    int16_t x0, y0, x1, y1;
+    dl_entry_bounds(&dl_back.data[dl_back.last], &x0, &y0, &x1, &y1);
+    
+    uint16_t at = 0;
+    while (at < dl_back.last) {
+        uint8_t* entry = &dl_back.data[at];
+        uint16_t size = dl_entry_size(entry);
+        int16_t ex0, ey0, ex1, ey1;
+        if (dl_entry_bounds(entry, &ex0, &ey0, &ex1, &ey1) &&
+            ex0 >= x0 && ex1 <= x1 && ey0 >= y0 && ey1 <= y1) {
+            memmove(entry, entry + size, dl_back.length - at - size);
+            dl_back.length -= size;
+            dl_back.last -= size;
+        } else {
+            at += size;
+        }
+    }
+}
+
+static void dl_record_char(uint8_t x, uint8_t y, char c, bool inverted) {
+    uint8_t type = inverted ? DL_TEXT_INVERTED : DL_TEXT;
+    
+    // Characters drawn left to right on one line extend a single run
+    uint8_t* entry = dl_last(type);
+    if (entry && entry[2] == y && entry[1] + 6 * entry[3] == x &&
+        entry[3] < 255 && dl_back.length < OLED_DL_BYTES) {
+        entry[4 + entry[3]++] = c;
+        dl_back.length++;
     } else {
-        oled_buffer[x + (y / 8) * OLED_WIDTH] &= ~(1 << (y & 7));
+        entry = dl_append(type, 5);
+        if (!entry) return;
+        entry[1] = x;
+        entry[2] = y;
+        entry[3] = 1;
+        entry[4] = c;
+    }
+    if (inverted) {
+        dl_prune_under_last();
     }
 }
 
-void oled_draw_char(uint8_t x, uint8_t y, char c) {
-    if (c < 32 || c > 126) c = 32; // Printable ASCII only (32-126)
+static void dl_record_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color) {
+    // A line drawn a pixel at a time grows one rectangle
+    uint8_t* entry = dl_last(DL_RECT);
+    if (entry && entry[5] == color && h == 1 && entry[4] == 1 && entry[2] == y && entry[1] + entry[3] == x) {
+        entry[3] += w;
+    } else if (entry && entry[5] == color && w == 1 && entry[3] == 1 && entry[1] == x && entry[2] + entry[4] == y) {
+        entry[4] += h;
+    } else {
+        entry = dl_append(DL_RECT, 6);
+        if (!entry) return;
+        entry[1] = x;
+        entry[2] = y;
+        entry[3] = w;
+        entry[4] = h;
+        entry[5] = color;
+    }
+    dl_prune_under_last();
+}
+
+static void dl_record_columns(uint8_t x, uint8_t y, const uint8_t* columns, uint8_t count, bool inverted) {
+    uint8_t* entry = dl_append(inverted ? DL_COLUMNS_INVERTED : DL_COLUMNS, 4 + sizeof(columns));
+    if (!entry) return;
+    entry[1] = x;
+    entry[2] = y;
+    entry[3] = count;
+    memcpy(&entry[4], &columns, sizeof(columns));
+    dl_prune_under_last();
+}
+
+// Replace the state of a layer already in the back list
+static void dl_update_layer(oled_layer_fn_t draw, const void* state, uint8_t size) {
+    uint16_t at = 0;
+    while (at < dl_back.length) {
+        uint8_t* entry = &dl_back.data[at];
+        at += dl_entry_size(entry);
+        if (entry[0] != DL_LAYER) {
+            continue;
+        }
+        
+        oled_layer_fn_t entry_draw;
+        memcpy(&entry_draw, &entry[1], sizeof(entry_draw));
+        if (entry_draw == draw && entry[1 + sizeof(draw)] == size) {
+            memcpy(&entry[2 + sizeof(draw)], state, size);
+            return;
+        }
+    }
+}
+
+/**
+ * Render one page of the committed list into the tile
+ *
+ * The draw functions write straight to the tile while render_page is set;
+ * entries that cannot reach the page are skipped.
+ */
+static void render_tile(uint8_t page) {
+    oled_transport_wait();      // The last span may still be going out
+    memset(&tile[1], 0, OLED_WIDTH);
+    tile_page = page;
+    render_page = page;
     
-    const uint8_t* glyph = font5x7[c - 32];
+    if (dl_front.border) {
+        oled_draw_border();
+    }
     
-    for (int i = 0; i < 5; i++) {
-        uint8_t line = glyph[i];
-        for (int j = 0; j < 8; j++) {
-            if (line & (1 << j)) {
-                oled_set_pixel(x + i, y + j + 1, 1);
+    uint16_t at = 0;
+    while (at < dl_front.length) {
+        const uint8_t* entry = &dl_front.data[at];
+        at += dl_entry_size(entry);
+        
+        int16_t x0, y0, x1, y1;
+        if (dl_entry_bounds(entry, &x0, &y0, &x1, &y1) && (y1 / 8 < page || y0 / 8 > page)) {
+            continue;
+        }
+        
+        switch (entry[0]) {
+            case DL_TEXT:
+            case DL_TEXT_INVERTED:
+                for (uint8_t i = 0; i < entry[3]; i++) {
+                    if (entry[0] == DL_TEXT_INVERTED) {
+                        oled_draw_char_inverted(entry[1] + 6 * i, entry[2], entry[4 + i]);
+                    } else {
+                        oled_draw_char(entry[1] + 6 * i, entry[2], entry[4 + i]);
+                    }
+                }
+                break;
+            case DL_RECT:
+                oled_fill_rect(entry[1], entry[2], entry[3], entry[4], entry[5]);
+                break;
+            case DL_COLUMNS:
+            case DL_COLUMNS_INVERTED: {
+                const uint8_t* columns;
+                memcpy(&columns, &entry[4], sizeof(columns));
+                oled_draw_columns(entry[1], entry[2], columns, entry[3], entry[0] == DL_COLUMNS_INVERTED);
+                break;
             }
+            default: {
+                oled_layer_fn_t draw;
+                memcpy(&draw, &entry[1], sizeof(draw));
+                memcpy(layer_state, &entry[2 + sizeof(draw)], entry[1 + sizeof(draw)]);
+                draw(layer_state);
+                break;
+            }
+        }
+    }
+    
+    render_page = OLED_PAGES;
+}
+#endif
+
+void oled_set_pixel(uint8_t x, uint8_t y, uint8_t color) {
+    if (x >= OLED_WIDTH || y >= OLED_HEIGHT) return;
+    
+#ifdef OLED_TILE_MODE
+    if (render_page == OLED_PAGES) {
+        dl_record_rect(x, y, 1, 1, color ? 1 : 0);
+        return;
+    }
+#endif
+    uint8_t bit = 1 << (y & 7);
+    write_cell(y / 8, x, color ? bit : 0, bit);
+}
+
+void oled_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color) {
+    if (x >= OLED_WIDTH || y >= OLED_HEIGHT || w == 0 || h == 0) return;
+    if (w > OLED_WIDTH - x) w = OLED_WIDTH - x;
+    if (h > OLED_HEIGHT - y) h = OLED_HEIGHT - y;
+    
+#ifdef OLED_TILE_MODE
+    if (render_page == OLED_PAGES) {
+        dl_record_rect(x, y, w, h, color ? 1 : 0);
+        return;
+    }
+#endif
+    // One masked byte per column and page
+    uint8_t bottom = y + h - 1;
+    for (uint8_t page = y / 8; page <= bottom / 8; page++) {
+        uint8_t first = page == y / 8 ? (y & 7) : 0;
+        uint8_t last = page == bottom / 8 ? (bottom & 7) : 7;
+        uint8_t mask = (uint8_t)((0xFF << first) & (0xFF >> (7 - last)));
+        for (uint8_t i = 0; i < w; i++) {
+            write_cell(page, x + i, color ? mask : 0, mask);
         }
     }
 }
 
-void oled_draw_char_inverted(uint8_t x, uint8_t y, char c) {
+void oled_draw_layer(oled_layer_fn_t draw, const void* state, uint8_t size) {
+#ifdef OLED_TILE_MODE
+    if (render_page == OLED_PAGES) {
+        if (size > OLED_LAYER_STATE_MAX) {
+            debug_error("OLED: Layer state of %u bytes dropped", size);
+            return;
+        }
+        uint8_t* entry = dl_append(DL_LAYER, 2 + sizeof(draw) + size);
+        if (entry) {
+            memcpy(&entry[1], &draw, sizeof(draw));
+            entry[1 + sizeof(draw)] = size;
+            memcpy(&entry[2 + sizeof(draw)], state, size);
+        }
+        return;
+    }
+#endif
+    draw(state);
+}
+
+void oled_draw_char(uint8_t x, uint8_t y, char c) {
     if (c < 32 || c > 126) c = 32; // Printable ASCII only (32-126)
     
+#ifdef OLED_TILE_MODE
+    if (render_page == OLED_PAGES) {
+        dl_record_char(x, y, c, false);
+        return;
+    }
+#endif
     const uint8_t* glyph = font5x7[c - 32];
     
-    // Draw background box (6x8 pixels for 5x7 font with spacing)
-    for (int i = 0; i < 6; i++) {
-        for (int j = 0; j < 8; j++) {
-            oled_set_pixel(x + i, y + j + 1, 1);
-        }
+    // Glyph rows start one pixel down (clear of the top border)
+    for (uint8_t i = 0; i < 5; i++) {
+        blit_column(x + i, y + 1, glyph[i], glyph[i]);
+    }
+}
+
+void oled_draw_char_inverted(uint8_t x, uint8_t y, char c) {
+    if (c < 32 || c > 126) c = 32; // Printable ASCII only (32-126)
+    
+#ifdef OLED_TILE_MODE
+    if (render_page == OLED_PAGES) {
+        dl_record_char(x, y, c, true);
+        return;
     }
+#endif
+    const uint8_t* glyph = font5x7[c - 32];
     
-    // Draw character in black (inverted)
-    for (int i = 0; i < 5; i++) {
-        uint8_t line = glyph[i];
-        for (int j = 0; j < 8; j++) {
-            if (line & (1 << j)) {
-                oled_set_pixel(x + i, y + j + 1, 0);
-            }
-        }
+    // Black glyph on a white 6x8 box (5x7 font with spacing)
+    for (uint8_t i = 0; i < 5; i++) {
+        blit_column(x + i, y + 1, ~glyph[i], 0xFF);
     }
+    blit_column(x + 5, y + 1, 0xFF, 0xFF);
 }
 
 void oled_draw_string(uint8_t x, uint8_t y, const char* str) {
@@ -283,6 +1041,31 @@ void oled_draw_string_inverted(uint8_t x, uint8_t y, const char* str) {
     }
 }
 
+uint8_t oled_render_string(const char* str, uint8_t* columns, uint8_t max_columns) {
+    uint8_t count = 0;
+    while (*str && count + 6 <= max_columns) {
+        char c = *str++;
+        if (c < 32 || c > 126) c = 32; // Printable ASCII only (32-126)
+        memcpy(&columns[count], font5x7[c - 32], 5);
+        columns[count + 5] = 0;
+        count += 6;
+    }
+    return count;
+}
+
+void oled_draw_columns(uint8_t x, uint8_t y, const uint8_t* columns, uint8_t count, bool inverted) {
+#ifdef OLED_TILE_MODE
+    if (render_page == OLED_PAGES) {
+        dl_record_columns(x, y, columns, count, inverted);
+        return;
+    }
+#endif
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t bits = inverted ? ~columns[i] : columns[i];
+        blit_column(x + i, y + 1, bits, 0xFF);
+    }
+}
+
 void oled_note_to_name(uint8_t note, char* name_buffer) {
     if (note > 127) note = 127;
     
@@ -324,11 +1107,7 @@ void oled_display_single_note(uint8_t note_num, uint8_t velocity, uint8_t channe
     
     // Velocity bar
     uint8_t bar_width = (velocity * 100) / 127;
-    for (int i = 0; i < bar_width; i++) {
-        for (int j = 54; j < 62; j++) {
-            oled_set_pixel(i + 14, j, 1);
-        }
-    }
+    oled_fill_rect(14, 54, bar_width, 8, 1);
     
     oled_display();
 }
@@ -383,13 +1162,72 @@ void oled_display_channel_activity(const uint8_t* channel_activity) {
         
         // Activity bar (vertical)
         uint8_t bar_height = (channel_activity[ch] * 14) / 127;
-        for (int i = 0; i < bar_height; i++) {
-            for (int j = 0; j < 4; j++) {
-                oled_set_pixel(x + j + 6, y + 14 - i, 1);
-            }
+        oled_fill_rect(x + 6, y + 15 - bar_height, 4, bar_height, 1);
+    }
+    
+    oled_display();
+}
+
+// Draw one RAM row of a roll with the given number of lanes: each lane a
+// bar with a one-column gap on its right, so neighbouring notes stay apart
+static void draw_roll_row(uint8_t lanes, uint8_t row, uint16_t lanes_on) {
+    if (lanes == 0) {
+        return;
+    }
+    uint8_t lane_width = OLED_WIDTH / lanes;
+    uint8_t page = row / 8;
+    uint8_t bit = 1 << (row & 7);
+    uint8_t x = 0;
+    for (uint8_t lane = 0; lane < lanes; lane++) {
+        uint8_t on = (lanes_on >> lane) & 1;
+        for (uint8_t i = 0; i < lane_width; i++, x++) {
+            bool lit = on && (i + 1 < lane_width || lane_width == 1);
+            write_cell(page, x, lit ? bit : 0, bit);
         }
     }
+}
+
+#ifdef OLED_TILE_MODE
+// Roll layer: the rows of the page being rendered, from the row history
+static void draw_roll(const void* state) {
+    const roll_layer_t* roll = state;
+    for (uint8_t row = render_page * 8; row < render_page * 8 + 8; row++) {
+        draw_roll_row(roll->lanes, row, roll->rows[row]);
+    }
+}
+#endif
+
+void oled_piano_roll_begin(uint8_t lanes) {
+    if (lanes == 0) lanes = 1;
+    if (lanes > OLED_PIANO_ROLL_MAX_LANES) lanes = OLED_PIANO_ROLL_MAX_LANES;
+    
+    oled_clear();
+    roll_lanes = lanes;
+    roll_head = 0;
+#ifdef OLED_TILE_MODE
+    memset(&roll_layer, 0, sizeof(roll_layer));
+    roll_layer.lanes = lanes;
+    oled_draw_layer(draw_roll, &roll_layer, sizeof(roll_layer));
+#endif
+    oled_display();
+}
+
+void oled_piano_roll_tick(uint16_t lanes_on) {
+    if (roll_lanes == 0) {
+        return;     // Another screen has been drawn since oled_piano_roll_begin()
+    }
+    
+    // Rewrite the oldest RAM row with the new slice
+#ifdef OLED_TILE_MODE
+    roll_layer.rows[roll_head] = lanes_on;
+    dl_update_layer(draw_roll, &roll_layer, sizeof(roll_layer));
+#else
+    draw_roll_row(roll_lanes, roll_head, lanes_on);
+#endif
     
+    // Scroll by one row so the new slice is on the bottom line
+    roll_head = (roll_head + 1) % OLED_HEIGHT;
+    oled_set_start_line(roll_head);
     oled_display();
 }
 
@@ -399,6 +1237,9 @@ void oled_display_channel_activity(const uint8_t* channel_activity) {
 
 #define SCREENSAVER_NUM_BALLS 3
 #define BALL_RADIUS 3
+#define BALL_MIN_SIZE 2
+#define BALL_MAX_SIZE 4
+#define BALL_SPRITE_SPAN (2 * BALL_MAX_SIZE + 1)
 #define GRAVITY 8       // Gravity acceleration (fixed point 8.8)
 #define DAMPING 230     // Velocity damping on bounce (out of 256)
 
@@ -408,9 +1249,15 @@ typedef struct {
     int16_t vx;     // Velocity X (fixed point 8.8)
     int16_t vy;     // Velocity Y (fixed point 8.8)
     uint8_t size;   // Ball size/radius
+    int16_t drawn_x;    // Center it was last drawn at (pixels)
+    int16_t drawn_y;
 } ball_t;
 
 static ball_t balls[SCREENSAVER_NUM_BALLS];
+
+// Filled circle of each size as column masks: bit n is row n of the
+// ball's bounding square, column i its i-th column
+static uint16_t ball_sprites[BALL_MAX_SIZE + 1][BALL_SPRITE_SPAN];
 static uint32_t screensaver_frame = 0;
 
 // Simple pseudo-random number generator
@@ -421,17 +1268,40 @@ static uint32_t screensaver_rand(void) {
     return screensaver_seed;
 }
 
-// Draw a filled circle
-static void draw_filled_circle(int16_t cx, int16_t cy, uint8_t radius) {
-    for (int16_t y = -radius; y <= radius; y++) {
-        for (int16_t x = -radius; x <= radius; x++) {
-            if (x*x + y*y <= radius*radius) {
-                int16_t px = cx + x;
-                int16_t py = cy + y;
-                if (px >= 0 && px < OLED_WIDTH && py >= 0 && py < OLED_HEIGHT) {
-                    oled_set_pixel(px, py, 1);
+// Render the ball sprites (every point with x^2 + y^2 <= r^2)
+static void render_ball_sprites(void) {
+    for (int16_t r = BALL_MIN_SIZE; r <= BALL_MAX_SIZE; r++) {
+        for (int16_t x = -r; x <= r; x++) {
+            uint16_t mask = 0;
+            for (int16_t y = -r; y <= r; y++) {
+                if (x*x + y*y <= r*r) {
+                    mask |= 1u << (y + r);
                 }
             }
+            ball_sprites[r][x + r] = mask;
+        }
+    }
+}
+
+// Draw (set) or erase a ball sprite a column at a time, shifted into the
+// pages it covers
+static void blit_ball(int16_t cx, int16_t cy, uint8_t radius, bool set) {
+    int16_t top = cy - radius;
+    
+    for (int16_t i = 0; i <= 2 * radius; i++) {
+        int16_t x = cx - radius + i;
+        if (x < 0 || x >= OLED_WIDTH) continue;
+        
+        uint32_t mask = ball_sprites[radius][i];
+        int16_t row = top;
+        if (row < 0) {
+            mask >>= -row;      // Clip rows above the screen
+            row = 0;
+        }
+        mask <<= row & 7;
+        
+        for (uint8_t page = row / 8; mask && page < OLED_PAGES; page++, mask >>= 8) {
+            write_cell(page, x, set ? (uint8_t)mask : 0, (uint8_t)mask);
         }
     }
 }
@@ -450,15 +1320,42 @@ void oled_screensaver_init(void) {
         balls[i].vy = -((screensaver_rand() % 384) + 128);
         
         // Random size between 2-4 pixels
-        balls[i].size = 2 + (screensaver_rand() % 3);
+        balls[i].size = BALL_MIN_SIZE + (screensaver_rand() % 3);
     }
     
+    render_ball_sprites();
+    balls_drawn = false;
     screensaver_frame = 0;
 }
 
+#ifdef OLED_TILE_MODE
+// Ball layer state: where each ball was drawn, and its size
+typedef struct {
+    int16_t x;
+    int16_t y;
+    uint8_t size;
+} ball_sprite_t;
+
+static ball_sprite_t ball_layer[SCREENSAVER_NUM_BALLS];
+
+// Ball layer: every ball of the frame
+static void draw_balls(const void* state) {
+    const ball_sprite_t* sprites = state;
+    for (uint8_t i = 0; i < SCREENSAVER_NUM_BALLS; i++) {
+        blit_ball(sprites[i].x, sprites[i].y, sprites[i].size, true);
+    }
+}
+#endif
+
 void oled_screensaver_update(void) {
-    // Clear display
-    oled_clear();
+    // Erase the balls where they were, or start from a blank screen
+    if (balls_drawn) {
+        for (uint8_t i = 0; i < SCREENSAVER_NUM_BALLS; i++) {
+            blit_ball(balls[i].drawn_x, balls[i].drawn_y, balls[i].size, false);
+        }
+    } else {
+        oled_clear();
+    }
     
     // Update and draw each ball
     for (uint8_t i = 0; i < SCREENSAVER_NUM_BALLS; i++) {
@@ -509,9 +1406,26 @@ void oled_screensaver_update(void) {
         // Draw the ball
         px = balls[i].x >> 8;
         py = balls[i].y >> 8;
-        draw_filled_circle(px, py, balls[i].size);
+        blit_ball(px, py, balls[i].size, true);
+        balls[i].drawn_x = px;
+        balls[i].drawn_y = py;
+#ifdef OLED_TILE_MODE
+        ball_layer[i].x = px;
+        ball_layer[i].y = py;
+        ball_layer[i].size = balls[i].size;
+#endif
     }
     
+#ifdef OLED_TILE_MODE
+    // The layer draws the balls at their new positions (the blits above
+    // only reach a page while it is rendered)
+    if (balls_drawn) {
+        dl_update_layer(draw_balls, ball_layer, sizeof(ball_layer));
+    } else {
+        oled_draw_layer(draw_balls, ball_layer, sizeof(ball_layer));
+    }
+#endif
+    balls_drawn = true;
     screensaver_frame++;
     oled_display();
 }
@@ -6,9 +6,18 @@
 
 // SSD1306 OLED Display Configuration
 #define OLED_I2C_ADDRESS    0x3C  // 0x78 >> 1 (I2C address in 7-bit format)
+
+// SPI wiring (CMake option OLED_SPI), on the instance passed to oled_init()
+#define OLED_SPI_FREQ       10000000  // SSD1306 minimum clock period is 100 ns
+#define OLED_SPI_SCK_PIN    10
+#define OLED_SPI_MOSI_PIN   11
+#define OLED_SPI_DC_PIN     12
+#define OLED_SPI_CS_PIN     13
+#define OLED_SPI_RST_PIN    14
 #define OLED_WIDTH          128
 #define OLED_HEIGHT         64
 #define OLED_PAGES          (OLED_HEIGHT / 8)
+#define OLED_PIANO_ROLL_MAX_LANES 16
 
 // MIDI Note Structure for Display
 typedef struct {
@@ -18,13 +27,16 @@ typedef struct {
     bool active;            // Note on/off status
 } midi_note_info_t;
 
+// Drawing function for oled_draw_layer(), given its copy of the layer state
+typedef void (*oled_layer_fn_t)(const void* state);
+
 /**
  * @brief Initialize the OLED display
  * 
- * @param i2c_inst I2C instance (i2c0 or i2c1)
+ * @param bus_inst I2C instance (i2c0 or i2c1), or SPI instance with OLED_SPI
  * @return true if initialization successful, false otherwise
  */
-bool oled_init(void* i2c_inst);
+bool oled_init(void* bus_inst);
 
 /**
  * @brief Clear the entire display
@@ -38,9 +50,114 @@ void oled_draw_border(void);
 
 /**
  * @brief Update the display with buffered content
+ * 
+ * Commits the drawing buffer to the frame being sent. Only the columns
+ * changed since the last update are sent, page by page. With a flush budget
+ * set the frame goes out over oled_flush_step() calls; if one is still in
+ * flight the commit waits until it completes, so a frame never tears.
  */
 void oled_display(void);
 
+/**
+ * @brief Limit how much display traffic one oled_flush_step() may send
+ * 
+ * @param max_bytes Data bytes per step (0 = no limit)
+ * @param max_us Microseconds per step (0 = no limit)
+ * 
+ * With both 0 (the default) oled_display() sends the frame at once.
+ */
+void oled_set_flush_budget(uint32_t max_bytes, uint32_t max_us);
+
+/**
+ * @brief Send the next part of the committed frame within the flush budget
+ * 
+ * A step always sends at least a few bytes so a flush finishes even with a
+ * tiny budget. Call once per main loop pass.
+ * 
+ * @return true if no frame is left to send
+ */
+bool oled_flush_step(void);
+
+/**
+ * @brief Send the committed frame, and any waiting one, right away
+ */
+void oled_display_flush(void);
+
+/**
+ * @brief Check whether every committed frame has been sent
+ * 
+ * @return true if nothing is in flight or waiting
+ */
+bool oled_flush_idle(void);
+
+/**
+ * @brief Count of oled_clear() calls since boot
+ * 
+ * Lets a screen that updates only part of itself tell whether something
+ * else has been drawn since it was last drawn in full.
+ * 
+ * @return Number of clears (wraps)
+ */
+uint32_t oled_get_clear_count(void);
+
+/**
+ * @brief Get one page of the committed frame
+ * 
+ * The frame last committed by oled_display(), which is what the panel
+ * shows once it has been flushed.
+ * 
+ * @param page Page (0-7), 8 pixel rows each
+ * @return OLED_WIDTH column bytes (bit 0 = top row), valid until the next commit
+ *         (in tile mode, until the next oled_* call: the page is rendered into
+ *         the one tile buffer)
+ */
+const uint8_t* oled_get_frame_page(uint8_t page);
+
+/**
+ * @brief Get the display start line committed with the frame
+ * 
+ * @return RAM row shown on the panel's first line (0-63)
+ */
+uint8_t oled_get_frame_start_line(void);
+
+/**
+ * @brief Count of commits that changed the frame
+ * 
+ * In tile mode a commit counts when the entries reaching a page changed,
+ * which a redraw that renders the same may also do.
+ * 
+ * @return Number of changed frames since boot (wraps)
+ */
+uint32_t oled_get_frame_count(void);
+
+/**
+ * @brief Get the bus time spent on display traffic
+ * 
+ * Counts from oled_init() at the panel's bus speed; use differences, the
+ * value wraps after about 71 minutes.
+ * 
+ * @return Bus time in microseconds
+ */
+uint32_t oled_get_bus_time_us(void);
+
+/**
+ * @brief Set the RAM row the panel shows on its first line
+ * 
+ * Scrolls the whole image vertically without sending it again. Takes
+ * effect with the next oled_display(), once that frame has been sent.
+ * oled_clear() sets it back to 0.
+ * 
+ * @param line RAM row (0-63)
+ */
+void oled_set_start_line(uint8_t line);
+
+/**
+ * @brief Mark the whole buffer as changed so the next update sends all of it
+ * 
+ * Use after the panel has lost its RAM contents (reset, power cycle).
+ */
+void oled_invalidate(void);
+
 /**
  * @brief Set a pixel on the display buffer
  * 
@@ -50,6 +167,34 @@ void oled_display(void);
  */
 void oled_set_pixel(uint8_t x, uint8_t y, uint8_t color);
 
+/**
+ * @brief Fill a rectangle on the display buffer
+ * 
+ * @param x X coordinate of the left edge
+ * @param y Y coordinate of the top edge
+ * @param w Width in pixels (clipped at the right edge)
+ * @param h Height in pixels (clipped at the bottom edge)
+ * @param color 1 for white, 0 for black
+ */
+void oled_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t color);
+
+/**
+ * @brief Draw with a function from a copy of its state
+ * 
+ * In buffer mode this just calls draw(state). In tile mode (OLED_TILE_MODE)
+ * the state is copied into the display list and draw() is called again with
+ * that copy for every page as it is rendered, with only that page's pixels
+ * kept, until the next oled_clear(): for pictures that do not fit the
+ * display list, such as the screensavers and the piano roll. draw() gets
+ * an aligned copy of the state, must not read anything else that changes
+ * and must not call oled_clear() or oled_display().
+ * 
+ * @param draw Function drawing with the oled_* calls
+ * @param state Everything draw() reads that may change between frames
+ * @param size Size of the state in bytes
+ */
+void oled_draw_layer(oled_layer_fn_t draw, const void* state, uint8_t size);
+
 /**
  * @brief Draw a character at specified position
  * 
@@ -86,6 +231,37 @@ void oled_draw_char_inverted(uint8_t x, uint8_t y, char c);
  */
 void oled_draw_string_inverted(uint8_t x, uint8_t y, const char* str);
 
+/**
+ * @brief Render a string into font columns for oled_draw_columns()
+ * 
+ * Each character takes 6 columns (5 glyph columns and a blank one), bit 0
+ * of a column being the top row.
+ * 
+ * @param str String to render
+ * @param columns Buffer for the columns
+ * @param max_columns Size of the buffer
+ * @return Number of columns written
+ */
+uint8_t oled_render_string(const char* str, uint8_t* columns, uint8_t max_columns);
+
+/**
+ * @brief Draw pre-rendered font columns, replacing what is under them
+ * 
+ * Draws at the same rows as oled_draw_string() at (x, y). Unlike the text
+ * functions every pixel of the 8-row band is written, so a row drawn
+ * inverted can be redrawn normal without clearing it first.
+ * 
+ * @param x X coordinate of the first column
+ * @param y Y coordinate, as for oled_draw_string()
+ * @param columns Columns from oled_render_string()
+ * @param count Number of columns
+ * In tile mode only the pointer is kept, so the columns must stay
+ * unchanged until the next oled_clear().
+ * 
+ * @param inverted true for black text on white
+ */
+void oled_draw_columns(uint8_t x, uint8_t y, const uint8_t* columns, uint8_t count, bool inverted);
+
 /**
  * @brief Display MIDI note information
  * 
@@ -110,6 +286,26 @@ void oled_display_single_note(uint8_t note_num, uint8_t velocity, uint8_t channe
  */
 void oled_display_channel_activity(const uint8_t* channel_activity);
 
+/**
+ * @brief Start the scrolling piano roll
+ * 
+ * Clears the screen and splits its width into one lane per note. Every
+ * oled_piano_roll_tick() adds one row at the bottom and scrolls the rest
+ * up with the display start line, so the last 64 ticks stay visible and a
+ * tick only sends the row bytes that changed. Drawing any other screen
+ * (anything that calls oled_clear()) ends the roll.
+ * 
+ * @param lanes Number of lanes (1-16)
+ */
+void oled_piano_roll_begin(uint8_t lanes);
+
+/**
+ * @brief Add one time slice to the piano roll
+ * 
+ * @param lanes_on Bit n set if lane n (note low_note + n) sounded during the tick
+ */
+void oled_piano_roll_tick(uint16_t lanes_on);
+
 /**
  * @brief Convert MIDI note number to note name
  * 
@@ -0,0 +1,63 @@
+#ifndef OLED_TRANSPORT_H
+#define OLED_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * SSD1306 transport: how command streams and frame data reach the panel
+ *
+ * One implementation is built, chosen by the CMake option OLED_SPI:
+ *   oled_transport_i2c.c - the shared I2C bus, through i2c_bus (default)
+ *   oled_transport_spi.c - 4-wire SPI, frame data sent by DMA
+ *
+ * Every transfer starts with the SSD1306 I2C control byte. Over SPI it is
+ * not sent; it sets the D/C# pin instead.
+ */
+
+// Control byte leading every transfer (Co = 0: the rest is one stream)
+#define SSD1306_CONTROL_COMMAND     0x00
+#define SSD1306_CONTROL_DATA        0x40
+
+#ifdef OLED_SPI
+#define OLED_TRANSPORT_BITS_PER_BYTE 8    // No ACK, no address
+#else
+#define OLED_TRANSPORT_BITS_PER_BYTE 9    // 8 data bits + ACK
+#endif
+
+/**
+ * @brief Set up the transport
+ *
+ * @param bus_inst i2c_inst_t* (I2C) or spi_inst_t* (OLED_SPI)
+ * @return true if the transport is ready
+ */
+bool oled_transport_init(void* bus_inst);
+
+/**
+ * @brief Send a command stream or frame data
+ *
+ * May return while data is still going out (SPI DMA): buf must then stay
+ * unchanged until oled_transport_wait() or the next send.
+ *
+ * @param buf Control byte, then the commands or data
+ * @param len Length including the control byte
+ */
+void oled_transport_send(const uint8_t* buf, size_t len);
+
+/**
+ * @brief Wait until the last transfer is completely out
+ */
+void oled_transport_wait(void);
+
+/**
+ * @return Clock of the panel's bus in Hz
+ */
+uint32_t oled_transport_get_speed_hz(void);
+
+/**
+ * @return Bits clocked to the panel since init (ACK and address included)
+ */
+uint64_t oled_transport_get_bits(void);
+
+#endif // OLED_TRANSPORT_H
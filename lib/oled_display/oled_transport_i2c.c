@@ -0,0 +1,29 @@
+#include "oled_transport.h"
+#include "oled_display.h"
+#include "hardware/i2c.h"
+#include "i2c_bus.h"
+
+static i2c_inst_t* i2c_instance = NULL;
+static uint64_t bus_bits = 0;
+
+bool oled_transport_init(void* bus_inst) {
+    i2c_instance = (i2c_inst_t*)bus_inst;
+    return true;
+}
+
+void oled_transport_send(const uint8_t* buf, size_t len) {
+    i2c_bus_write_blocking(i2c_instance, OLED_I2C_ADDRESS, buf, len, false);
+    bus_bits += (len + 1) * OLED_TRANSPORT_BITS_PER_BYTE;   // Address byte included
+}
+
+void oled_transport_wait(void) {
+    // Transfers are blocking
+}
+
+uint32_t oled_transport_get_speed_hz(void) {
+    return i2c_bus_get_device_speed(i2c_instance, OLED_I2C_ADDRESS);
+}
+
+uint64_t oled_transport_get_bits(void) {
+    return bus_bits;
+}
@@ -0,0 +1,96 @@
+#include "oled_transport.h"
+#include "oled_display.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "pico/time.h"
+#include "../../src/debug_uart.h"
+
+// Shorter data goes out by CPU, which costs less than starting the DMA
+#define OLED_SPI_DMA_MIN    16
+
+static spi_inst_t* spi_instance = NULL;
+static int tx_dma = -1;
+static uint32_t speed_hz = 0;
+static uint64_t bus_bits = 0;
+
+bool oled_transport_init(void* bus_inst) {
+    spi_instance = (spi_inst_t*)bus_inst;
+
+    // SSD1306 samples on the rising edge: mode 0, MSB first
+    speed_hz = spi_init(spi_instance, OLED_SPI_FREQ);
+    spi_set_format(spi_instance, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    gpio_set_function(OLED_SPI_SCK_PIN, GPIO_FUNC_SPI);
+    gpio_set_function(OLED_SPI_MOSI_PIN, GPIO_FUNC_SPI);
+
+    // The panel is alone on this bus, so CS# stays low
+    gpio_init(OLED_SPI_CS_PIN);
+    gpio_set_dir(OLED_SPI_CS_PIN, GPIO_OUT);
+    gpio_put(OLED_SPI_CS_PIN, 0);
+    gpio_init(OLED_SPI_DC_PIN);
+    gpio_set_dir(OLED_SPI_DC_PIN, GPIO_OUT);
+    gpio_put(OLED_SPI_DC_PIN, 0);
+
+    // Hardware reset (RES# low for at least 3 us)
+    gpio_init(OLED_SPI_RST_PIN);
+    gpio_set_dir(OLED_SPI_RST_PIN, GPIO_OUT);
+    gpio_put(OLED_SPI_RST_PIN, 0);
+    sleep_ms(1);
+    gpio_put(OLED_SPI_RST_PIN, 1);
+    sleep_ms(1);
+
+    if (tx_dma < 0) {
+        tx_dma = dma_claim_unused_channel(false);
+        if (tx_dma < 0) {
+            debug_error("OLED: No free DMA channel for SPI");
+            return false;
+        }
+
+        // Bytes from the frame into the SPI TX FIFO; what comes back is not read
+        dma_channel_config tx = dma_channel_get_default_config(tx_dma);
+        channel_config_set_transfer_data_size(&tx, DMA_SIZE_8);
+        channel_config_set_read_increment(&tx, true);
+        channel_config_set_write_increment(&tx, false);
+        channel_config_set_dreq(&tx, spi_get_dreq(spi_instance, true));
+        dma_channel_configure(tx_dma, &tx, &spi_get_hw(spi_instance)->dr, NULL, 0, false);
+    }
+
+    return true;
+}
+
+void oled_transport_send(const uint8_t* buf, size_t len) {
+    if (len < 2) {
+        return;
+    }
+
+    // D/C# is sampled with the last bit of each byte: never change it
+    // under a transfer still shifting out
+    oled_transport_wait();
+    gpio_put(OLED_SPI_DC_PIN, buf[0] == SSD1306_CONTROL_DATA);
+
+    // Frame data goes out by DMA while the main loop carries on; commands
+    // are short and often on the stack, so they are sent before returning
+    if (buf[0] == SSD1306_CONTROL_DATA && len - 1 >= OLED_SPI_DMA_MIN) {
+        dma_channel_transfer_from_buffer_now(tx_dma, &buf[1], len - 1);
+    } else {
+        spi_write_blocking(spi_instance, &buf[1], len - 1);
+    }
+    bus_bits += (len - 1) * OLED_TRANSPORT_BITS_PER_BYTE;
+}
+
+void oled_transport_wait(void) {
+    if (tx_dma >= 0) {
+        dma_channel_wait_for_finish_blocking(tx_dma);
+    }
+    while (spi_is_busy(spi_instance)) {
+        tight_loop_contents();
+    }
+}
+
+uint32_t oled_transport_get_speed_hz(void) {
+    return speed_hz;
+}
+
+uint64_t oled_transport_get_bits(void) {
+    return bus_bits;
+}
@@ -0,0 +1,383 @@
+#include "pio_i2c.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "pio_i2c.pio.h"
+#include "../../src/debug_uart.h"
+
+//--------------------------------------------------------------------+
+// TX FIFO Word Encoding (see pio_i2c.pio)
+//--------------------------------------------------------------------+
+
+#define PIO_I2C_ICOUNT_LSB  10
+#define PIO_I2C_FINAL_LSB   9
+#define PIO_I2C_DATA_LSB    1
+#define PIO_I2C_NAK_LSB     0
+
+// Index into pio_i2c_set_scl_sda_program_instructions[]
+#define I2C_SC0_SD0 0
+#define I2C_SC0_SD1 1
+#define I2C_SC1_SD0 2
+#define I2C_SC1_SD1 3
+
+// START/RSTART (4) + address (1) + data + STOP (4)
+#define PIO_I2C_MAX_WORDS (PIO_I2C_MAX_WRITE + 9)
+
+// Timeout margin on top of the wire time of a transfer
+#define PIO_I2C_TIMEOUT_MARGIN_US 1000
+
+//--------------------------------------------------------------------+
+// Internal State
+//--------------------------------------------------------------------+
+
+/**
+ * Per-bus state
+ */
+typedef struct {
+    bool initialized;
+    uint sm;
+    int tx_dma;
+    int rx_dma;
+    uint32_t baudrate;
+    bool held;                          // Previous transfer ended without STOP
+    bool busy;                          // Write-behind transfer in flight
+    uint8_t busy_address;               // Device of the transfer in flight
+    uint32_t busy_timeout_us;           // Timeout of the transfer in flight
+    uint32_t busy_start_us;
+    bool result_pending;                // Outcome of a finished transfer not yet taken
+    uint8_t result_address;
+    bool result_acked;
+    uint32_t nak_count;
+    uint16_t tx_words[PIO_I2C_MAX_WORDS];
+    uint32_t rx_discard;                // DMA sink for bytes echoed on writes
+} pio_i2c_bus_t;
+
+static PIO const pio_i2c_pio = pio0;
+static int pio_i2c_offset = -1;
+static pio_i2c_bus_t pio_buses[PIO_I2C_MAX_BUSES];
+
+//--------------------------------------------------------------------+
+// Helpers
+//--------------------------------------------------------------------+
+
+static uint8_t put_start(uint16_t *words, uint8_t n, bool repeated) {
+    if (repeated) {
+        words[n++] = 3u << PIO_I2C_ICOUNT_LSB;
+        words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC0_SD1];
+        words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC1_SD1];
+        words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC1_SD0];
+        words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC0_SD0];
+    } else {
+        // Bus is idle: pull SDA low, then SCL
+        words[n++] = 1u << PIO_I2C_ICOUNT_LSB;
+        words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC1_SD0];
+        words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC0_SD0];
+    }
+    return n;
+}
+
+static uint8_t put_stop(uint16_t *words, uint8_t n) {
+    words[n++] = 2u << PIO_I2C_ICOUNT_LSB;
+    words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC0_SD0];
+    words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC1_SD0];
+    words[n++] = pio_i2c_set_scl_sda_program_instructions[I2C_SC1_SD1];
+    return n;
+}
+
+static void put_word_blocking(pio_i2c_bus_t *b, uint16_t word) {
+    while (pio_sm_is_tx_fifo_full(pio_i2c_pio, b->sm)) {
+        tight_loop_contents();
+    }
+    // Halfword write so the word lands in the OSR immediately (autopull 16)
+    *(io_rw_16 *)&pio_i2c_pio->txf[b->sm] = word;
+}
+
+static uint32_t wire_timeout_us(pio_i2c_bus_t *b, size_t words) {
+    // Every FIFO word is at most 9 SCL periods; x2 for clock stretching
+    uint64_t bits = (uint64_t)words * 9;
+    return (uint32_t)((bits * 2 * 1000000u) / b->baudrate) + PIO_I2C_TIMEOUT_MARGIN_US;
+}
+
+static bool nak_raised(pio_i2c_bus_t *b) {
+    return pio_interrupt_get(pio_i2c_pio, b->sm);
+}
+
+/**
+ * Get the state machine going again after a NAK or timeout and release the bus
+ */
+static void resume_after_error(pio_i2c_bus_t *b) {
+    dma_channel_abort(b->tx_dma);
+    dma_channel_abort(b->rx_dma);
+
+    pio_sm_drain_tx_fifo(pio_i2c_pio, b->sm);
+    while (!pio_sm_is_rx_fifo_empty(pio_i2c_pio, b->sm)) {
+        (void)pio_sm_get(pio_i2c_pio, b->sm);
+    }
+    pio_sm_exec(pio_i2c_pio, b->sm, pio_encode_jmp(pio_i2c_offset + pio_i2c_offset_entry_point));
+    pio_interrupt_clear(pio_i2c_pio, b->sm);
+
+    uint16_t words[4];
+    uint8_t n = put_stop(words, 0);
+    for (uint8_t i = 0; i < n; i++) {
+        put_word_blocking(b, words[i]);
+    }
+    b->held = false;
+}
+
+/**
+ * Wait for the state machine to run dry or raise a NAK
+ *
+ * @return 0 when idle, PICO_ERROR_GENERIC on NAK, PICO_ERROR_TIMEOUT on timeout
+ */
+static int wait_for_sm(pio_i2c_bus_t *b, uint32_t start, uint32_t timeout_us) {
+    uint32_t stall_mask = 1u << (PIO_FDEBUG_TXSTALL_LSB + b->sm);
+
+    // Wait until DMA has handed over everything and the FIFO is empty
+    while (dma_channel_is_busy(b->tx_dma) || !pio_sm_is_tx_fifo_empty(pio_i2c_pio, b->sm)) {
+        if (nak_raised(b)) {
+            return PICO_ERROR_GENERIC;
+        }
+        if (time_us_32() - start > timeout_us) {
+            return PICO_ERROR_TIMEOUT;
+        }
+    }
+
+    // The state machine stalls on the next pull once the last word is done
+    pio_i2c_pio->fdebug = stall_mask;
+    while (!(pio_i2c_pio->fdebug & stall_mask)) {
+        if (nak_raised(b)) {
+            return PICO_ERROR_GENERIC;
+        }
+        if (time_us_32() - start > timeout_us) {
+            return PICO_ERROR_TIMEOUT;
+        }
+    }
+
+    return nak_raised(b) ? PICO_ERROR_GENERIC : 0;
+}
+
+/**
+ * Finish the write-behind transfer in flight, if any, and latch its outcome
+ */
+static int finish_previous(pio_i2c_bus_t *b) {
+    if (!b->busy) {
+        return 0;
+    }
+
+    int result = wait_for_sm(b, b->busy_start_us, b->busy_timeout_us);
+    b->busy = false;
+    b->result_pending = true;
+    b->result_address = b->busy_address;
+    b->result_acked = (result == 0);
+
+    if (result != 0) {
+        if (result == PICO_ERROR_GENERIC) {
+            b->nak_count++;
+        } else {
+            debug_error("PIO_I2C: Timeout on bus %d (device 0x%02X)", (int)(b - pio_buses), b->busy_address);
+        }
+        resume_after_error(b);
+    }
+    return result == PICO_ERROR_TIMEOUT ? result : 0;
+}
+
+//--------------------------------------------------------------------+
+// Public API Implementation
+//--------------------------------------------------------------------+
+
+bool pio_i2c_init(uint8_t bus, uint sda_pin, uint32_t baudrate) {
+    if (bus >= PIO_I2C_MAX_BUSES || baudrate == 0) {
+        debug_error("PIO_I2C: Init failed - invalid parameters");
+        return false;
+    }
+
+    pio_i2c_bus_t *b = &pio_buses[bus];
+    if (b->initialized) {
+        return true;
+    }
+
+    // One copy of the program serves every bus
+    if (pio_i2c_offset < 0) {
+        if (!pio_can_add_program(pio_i2c_pio, &pio_i2c_program)) {
+            debug_error("PIO_I2C: No room for program in PIO0");
+            return false;
+        }
+        pio_i2c_offset = pio_add_program(pio_i2c_pio, &pio_i2c_program);
+    }
+
+    int sm = pio_claim_unused_sm(pio_i2c_pio, false);
+    if (sm < 0) {
+        debug_error("PIO_I2C: No free state machine for bus %d", bus);
+        return false;
+    }
+
+    b->tx_dma = dma_claim_unused_channel(false);
+    b->rx_dma = dma_claim_unused_channel(false);
+    if (b->tx_dma < 0 || b->rx_dma < 0) {
+        debug_error("PIO_I2C: No free DMA channels for bus %d", bus);
+        if (b->tx_dma >= 0) dma_channel_unclaim(b->tx_dma);
+        if (b->rx_dma >= 0) dma_channel_unclaim(b->rx_dma);
+        pio_sm_unclaim(pio_i2c_pio, sm);
+        return false;
+    }
+
+    b->sm = (uint)sm;
+    b->baudrate = baudrate;
+    pio_i2c_program_init(pio_i2c_pio, b->sm, pio_i2c_offset, sda_pin, sda_pin + 1, baudrate);
+
+    // TX: halfwords from the encoded buffer into the TX FIFO
+    dma_channel_config tx = dma_channel_get_default_config(b->tx_dma);
+    channel_config_set_transfer_data_size(&tx, DMA_SIZE_16);
+    channel_config_set_read_increment(&tx, true);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_dreq(&tx, pio_get_dreq(pio_i2c_pio, b->sm, true));
+    dma_channel_configure(b->tx_dma, &tx, &pio_i2c_pio->txf[b->sm], b->tx_words, 0, false);
+
+    // RX: every byte on the wire is pushed back; discard them on writes
+    dma_channel_config rx = dma_channel_get_default_config(b->rx_dma);
+    channel_config_set_transfer_data_size(&rx, DMA_SIZE_32);
+    channel_config_set_read_increment(&rx, false);
+    channel_config_set_write_increment(&rx, false);
+    channel_config_set_dreq(&rx, pio_get_dreq(pio_i2c_pio, b->sm, false));
+    dma_channel_configure(b->rx_dma, &rx, &b->rx_discard, &pio_i2c_pio->rxf[b->sm], 0, false);
+
+    b->initialized = true;
+    debug_info("PIO_I2C: Bus %d on SM%d at %d Hz (SDA=GP%d, SCL=GP%d)",
+               bus, b->sm, baudrate, sda_pin, sda_pin + 1);
+    return true;
+}
+
+bool pio_i2c_is_initialized(uint8_t bus) {
+    return bus < PIO_I2C_MAX_BUSES && pio_buses[bus].initialized;
+}
+
+int pio_i2c_write(uint8_t bus, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    if (!pio_i2c_is_initialized(bus) || (!src && len) || len > PIO_I2C_MAX_WRITE) {
+        return PICO_ERROR_GENERIC;
+    }
+
+    pio_i2c_bus_t *b = &pio_buses[bus];
+    if (finish_previous(b) == PICO_ERROR_TIMEOUT) {
+        return PICO_ERROR_TIMEOUT;
+    }
+
+    // Encode the whole transfer; only the last byte may be NAKed
+    uint8_t n = put_start(b->tx_words, 0, b->held);
+    b->tx_words[n++] = (uint16_t)(((addr << 1) << PIO_I2C_DATA_LSB) | (1u << PIO_I2C_NAK_LSB));
+    for (size_t i = 0; i < len; i++) {
+        bool last = (i == len - 1);
+        b->tx_words[n++] = (uint16_t)((src[i] << PIO_I2C_DATA_LSB) | (1u << PIO_I2C_NAK_LSB) |
+                                      (last ? (1u << PIO_I2C_FINAL_LSB) : 0));
+    }
+    if (!nostop) {
+        n = put_stop(b->tx_words, n);
+    }
+
+    b->busy = true;
+    b->busy_address = addr;
+    b->busy_start_us = time_us_32();
+    b->busy_timeout_us = wire_timeout_us(b, n);
+    b->held = nostop;
+
+    dma_channel_set_trans_count(b->rx_dma, len + 1, true);
+    dma_channel_transfer_from_buffer_now(b->tx_dma, b->tx_words, n);
+    return (int)len;
+}
+
+int pio_i2c_read(uint8_t bus, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    if (!pio_i2c_is_initialized(bus) || !dst || len == 0) {
+        return PICO_ERROR_GENERIC;
+    }
+
+    pio_i2c_bus_t *b = &pio_buses[bus];
+    if (finish_previous(b) == PICO_ERROR_TIMEOUT) {
+        return PICO_ERROR_TIMEOUT;
+    }
+
+    uint16_t words[5];
+    uint8_t n = put_start(words, 0, b->held);
+    for (uint8_t i = 0; i < n; i++) {
+        put_word_blocking(b, words[i]);
+    }
+    put_word_blocking(b, (uint16_t)((((addr << 1) | 1u) << PIO_I2C_DATA_LSB) | (1u << PIO_I2C_NAK_LSB)));
+
+    // Clock in the data by sending all-ones; ACK every byte but the last
+    uint32_t start = time_us_32();
+    uint32_t timeout = wire_timeout_us(b, len + 10);
+    size_t tx_remain = len;
+    size_t rx_remain = len + 1;     // First byte back is the address echo
+    int result = 0;
+
+    while (tx_remain || rx_remain) {
+        if (nak_raised(b)) {
+            result = PICO_ERROR_GENERIC;
+            break;
+        }
+        if (time_us_32() - start > timeout) {
+            result = PICO_ERROR_TIMEOUT;
+            break;
+        }
+        if (tx_remain && !pio_sm_is_tx_fifo_full(pio_i2c_pio, b->sm)) {
+            --tx_remain;
+            *(io_rw_16 *)&pio_i2c_pio->txf[b->sm] = (uint16_t)((0xFFu << PIO_I2C_DATA_LSB) |
+                (tx_remain ? 0 : (1u << PIO_I2C_FINAL_LSB) | (1u << PIO_I2C_NAK_LSB)));
+        }
+        if (rx_remain && !pio_sm_is_rx_fifo_empty(pio_i2c_pio, b->sm)) {
+            uint8_t byte = (uint8_t)pio_sm_get(pio_i2c_pio, b->sm);
+            if (rx_remain-- <= len) {
+                *dst++ = byte;
+            }
+        }
+    }
+
+    if (result == 0) {
+        if (!nostop) {
+            n = put_stop(words, 0);
+            for (uint8_t i = 0; i < n; i++) {
+                put_word_blocking(b, words[i]);
+            }
+        }
+        b->held = nostop;
+        result = wait_for_sm(b, start, timeout);
+    }
+
+    if (result != 0) {
+        if (result == PICO_ERROR_GENERIC) {
+            b->nak_count++;
+        }
+        resume_after_error(b);
+        return result;
+    }
+    return (int)len;
+}
+
+int pio_i2c_flush(uint8_t bus) {
+    if (!pio_i2c_is_initialized(bus)) {
+        return PICO_ERROR_GENERIC;
+    }
+
+    pio_i2c_bus_t *b = &pio_buses[bus];
+    if (finish_previous(b) == PICO_ERROR_TIMEOUT) {
+        return PICO_ERROR_TIMEOUT;
+    }
+    return (b->result_pending && !b->result_acked) ? PICO_ERROR_GENERIC : 0;
+}
+
+bool pio_i2c_take_completed(uint8_t bus, uint8_t *address, bool *acked) {
+    if (!pio_i2c_is_initialized(bus) || !pio_buses[bus].result_pending) {
+        return false;
+    }
+
+    pio_i2c_bus_t *b = &pio_buses[bus];
+    if (address) *address = b->result_address;
+    if (acked) *acked = b->result_acked;
+    b->result_pending = false;
+    return true;
+}
+
+uint32_t pio_i2c_get_nak_count(uint8_t bus) {
+    return pio_i2c_is_initialized(bus) ? pio_buses[bus].nak_count : 0;
+}
+
+uint32_t pio_i2c_get_baudrate(uint8_t bus) {
+    return pio_i2c_is_initialized(bus) ? pio_buses[bus].baudrate : 0;
+}
@@ -0,0 +1,111 @@
+#ifndef PIO_I2C_H
+#define PIO_I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+
+// Maximum number of PIO I2C buses (one state machine each)
+#define PIO_I2C_MAX_BUSES 4
+
+// Largest payload of a single write-behind transfer
+#define PIO_I2C_MAX_WRITE 48
+
+/**
+ * Initialize a PIO I2C bus
+ *
+ * All buses run the same PIO program on PIO0, one state machine per bus.
+ * Each bus claims two DMA channels: one feeds the TX FIFO, one drains the
+ * RX FIFO so the state machine never stalls on writes.
+ *
+ * @param bus Bus index (0 to PIO_I2C_MAX_BUSES - 1)
+ * @param sda_pin GPIO pin for SDA; SCL must be on sda_pin + 1
+ * @param baudrate Bus speed in Hz
+ * @return true if the bus is ready, false otherwise
+ */
+bool pio_i2c_init(uint8_t bus, uint sda_pin, uint32_t baudrate);
+
+/**
+ * Check whether a PIO I2C bus has been initialized
+ *
+ * @param bus Bus index
+ * @return true if the bus is ready
+ */
+bool pio_i2c_is_initialized(uint8_t bus);
+
+/**
+ * Queue a write on a PIO I2C bus (write-behind)
+ *
+ * The transfer is encoded into the bus' DMA buffer and started; the call
+ * returns without waiting for the bus. It only blocks if the previous
+ * transfer on the same bus is still running, so writes to different buses
+ * run at the same time.
+ *
+ * Returning len means the transfer was queued, not that the device
+ * acknowledged it. A NAK is found by the next call on the bus (write, read
+ * or pio_i2c_flush()), which reports it through pio_i2c_flush() and
+ * pio_i2c_take_completed(); the NAKed write's own call has already
+ * returned len.
+ *
+ * @param bus Bus index
+ * @param addr 7-bit device address
+ * @param src Data to write
+ * @param len Number of bytes (at most PIO_I2C_MAX_WRITE)
+ * @param nostop true to leave the bus held for a repeated start
+ * @return len if queued, PICO_ERROR_GENERIC on invalid parameters,
+ *         PICO_ERROR_TIMEOUT if the previous transfer never finished
+ */
+int pio_i2c_write(uint8_t bus, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+/**
+ * Read from a device on a PIO I2C bus (blocking)
+ *
+ * @param bus Bus index
+ * @param addr 7-bit device address
+ * @param dst Buffer for the data
+ * @param len Number of bytes to read
+ * @param nostop true to leave the bus held for a repeated start
+ * @return len on success, PICO_ERROR_GENERIC on NAK, PICO_ERROR_TIMEOUT on timeout
+ */
+int pio_i2c_read(uint8_t bus, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+/**
+ * Wait until the write-behind transfer in flight has finished
+ *
+ * Its outcome stays available to pio_i2c_take_completed().
+ *
+ * @param bus Bus index
+ * @return 0 if the last finished write was acknowledged (or there was
+ *         none), PICO_ERROR_GENERIC if it was NAKed and not yet taken,
+ *         PICO_ERROR_TIMEOUT if it never finished
+ */
+int pio_i2c_flush(uint8_t bus);
+
+/**
+ * Collect the outcome of the last finished write-behind transfer
+ *
+ * @param bus Bus index
+ * @param address Pointer to store the device address of the transfer
+ * @param acked Pointer to store whether the device acknowledged it
+ * @return true if a result was pending, false otherwise
+ */
+bool pio_i2c_take_completed(uint8_t bus, uint8_t *address, bool *acked);
+
+/**
+ * Get the number of NAKs seen on a bus
+ *
+ * @param bus Bus index
+ * @return NAK count
+ */
+uint32_t pio_i2c_get_nak_count(uint8_t bus);
+
+/**
+ * Get the speed a PIO I2C bus runs at
+ *
+ * @param bus Bus index
+ * @return Bus speed in Hz, 0 if the bus is not initialized
+ */
+uint32_t pio_i2c_get_baudrate(uint8_t bus);
+
+#endif // PIO_I2C_H
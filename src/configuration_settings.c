@@ -17,7 +17,7 @@
 /**
  * Calculate CRC16 for data integrity checking
  */
-static uint16_t calculate_crc16(const uint8_t *data, size_t length) {
+uint16_t config_calculate_crc16(const uint8_t *data, size_t length) {
     uint16_t crc = 0xFFFF;
     
     for (size_t i = 0; i < length; i++) {
@@ -105,7 +105,7 @@ void config_load_defaults(config_manager_t *ctx) {
     memset(s->reserved, 0, sizeof(s->reserved));
     
     // Calculate CRC (exclude the CRC field itself)
-    s->crc = calculate_crc16((uint8_t*)s, sizeof(config_settings_t) - sizeof(s->crc));
+    s->crc = config_calculate_crc16((uint8_t*)s, sizeof(config_settings_t) - sizeof(s->crc));
     
     debug_info("CONFIG: Defaults loaded - Ch:%d, Notes:%d-%d, IO:0x%02X",
                s->midi_channel, s->low_note, s->low_note + s->note_range - 1, s->io_expander_address);
@@ -133,8 +133,8 @@ bool config_validate(const config_settings_t *settings) {
     }
     
     // Validate CRC
-    uint16_t calculated_crc = calculate_crc16((uint8_t*)settings, 
-                                              sizeof(config_settings_t) - sizeof(settings->crc));
+    uint16_t calculated_crc = config_calculate_crc16((uint8_t*)settings, 
+                                                     sizeof(config_settings_t) - sizeof(settings->crc));
     if (calculated_crc != settings->crc) {
         debug_error("CONFIG: CRC mismatch (calculated=0x%04X, stored=0x%04X)",
                    calculated_crc, settings->crc);
@@ -224,8 +224,8 @@ bool config_save(config_manager_t *ctx) {
     debug_info("CONFIG: Saving configuration to EEPROM...");
     
     // Update CRC before saving
-    ctx->settings.crc = calculate_crc16((uint8_t*)&ctx->settings,
-                                        sizeof(config_settings_t) - sizeof(ctx->settings.crc));
+    ctx->settings.crc = config_calculate_crc16((uint8_t*)&ctx->settings,
+                                               sizeof(config_settings_t) - sizeof(ctx->settings.crc));
     
     // Write configuration to EEPROM
     if (!at24cxx_write(&ctx->eeprom, ctx->eeprom_start_address,
@@ -154,4 +154,13 @@ bool config_erase(config_manager_t *ctx);
  */
 bool config_validate(const config_settings_t *settings);
 
+/**
+ * Calculate the CRC16 (Modbus, polynomial 0xA001) used for the stored settings
+ * 
+ * @param data Pointer to data
+ * @param length Number of bytes
+ * @return CRC16 value
+ */
+uint16_t config_calculate_crc16(const uint8_t *data, size_t length);
+
 #endif // CONFIGURATION_SETTINGS_H
@@ -6,6 +6,14 @@
 #include "button_handler.h"
 #include "midi_handler.h"
 #include "menu_handler.h"
+#include "usb_midi.h"
+#include <string.h>
+
+#ifdef DISPLAY_CORE1
+#include "display_snapshot.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#endif
 
 // Internal state
 static void* display_i2c = NULL;
@@ -15,18 +23,84 @@ static bool screensaver_active = false;
 static bool screensaver_pending = false;
 
 // Timer configuration
-#define SCREENSAVER_TIMEOUT_MS 30000  // 30 seconds
 #define TIMER_CHECK_INTERVAL_MS 1000   // Check every 1 second
 
 static alarm_id_t timeout_alarm = 0;
+static uint32_t screensaver_timeout_ms = 0;   // From the stored display_timeout (0 = never)
+
+// Screensaver pacing: at most SCREENSAVER_FPS frames per second, and never
+// more than SCREENSAVER_BUS_PERCENT of the bus time spent on its frames
+#define SCREENSAVER_FPS         20
+#define SCREENSAVER_BUS_PERCENT 10
+
+static uint64_t screensaver_frame_us = 0;    // Start of the last frame
+static uint32_t screensaver_bus_mark = 0;    // Display bus time at that point
+
+// Piano roll: one row per tick, 64 rows on screen (3.2 s of history)
+#define PIANO_ROLL_TICK_MS 50
+
+static display_note_view_t note_view = DISPLAY_NOTE_VIEW_SINGLE;
+static bool piano_roll_running = false;
+static uint16_t piano_roll_held = 0;       // Lanes whose note is down
+static uint16_t piano_roll_struck = 0;     // Lanes played since the last tick
+static uint64_t piano_roll_next_us = 0;
+
+// Display traffic allowed per main loop pass (bounds the delay added to MIDI)
+#define DISPLAY_FLUSH_BUDGET_BYTES 0      // No byte limit
+#define DISPLAY_FLUSH_BUDGET_US    500
+
+// Framebuffer mirror: one SysEx message per interval at most. A message
+// (DISPLAY_MIRROR_MESSAGE_MAX bytes) fits the USB TX FIFO, so it never
+// blocks, and the stream stays under 5 kB/s, a small fraction of the
+// endpoint's 64 bytes per 1 ms frame.
+#define DISPLAY_MIRROR_INTERVAL_MS 10
+#define MIRROR_HEADER_SIZE         7      // F0 7D 00 61 page column start_line
+#define MIRROR_ENCODED_MAX         35     // Packs into 40 bytes of 7 bits (+ F7 = 48)
+
+static bool mirror_enabled = false;
+static bool mirror_pending = false;                    // Frame may differ from what the host has
+static uint32_t mirror_frame_count = 0;                // oled_get_frame_count() last compared
+static uint8_t mirror_frame[OLED_PAGES][OLED_WIDTH];   // What the host has been sent
+static uint8_t mirror_start_line = 0;
+static uint64_t mirror_next_us = 0;
+
+#ifdef DISPLAY_CORE1
+// Display on core1: on core0 the display calls only describe the screen in
+// a snapshot (see display_snapshot.h); core1 draws the latest one, ticks
+// the piano roll, paces the screensaver and sends the frames
+static volatile uint32_t snapshot_shown = 0;     // Publishes core1 has drawn and sent
+static volatile bool core1_mirror_idle = true;
+static bool core1_running = false;
+static uint32_t snapshot_text_dropped = 0;       // Text lines past DISPLAY_TEXT_MAX
+
+static display_snapshot_t snapshot_working;      // Core0: the screen described so far
+static display_notes_t notes_working;            // Core0: the note and roll lanes so far
+static display_snapshot_t snapshot_drawn;        // Core1: the snapshot read last
+static display_notes_t notes_drawn;              // Core1: the notes read last
+
+// Core1 state
+static uint32_t drawn_screen_id = 0;
+static uint8_t drawn_text = 0;                   // Text lines of the screen drawn so far
+static uint8_t roll_strikes_seen[OLED_PIANO_ROLL_MAX_LANES];
+static uint8_t mirror_epoch_seen = 0;
+
+static void display_core1_main(void);
+#endif
+
+// Mirror message on its way to USB, one at a time. The USB FIFO may take
+// part of it; the rest goes after it on later calls. With DISPLAY_CORE1,
+// core1 leaves the messages here for core0, which owns USB.
+static uint8_t mirror_outbox[DISPLAY_MIRROR_MESSAGE_MAX];
+static volatile uint8_t mirror_outbox_length = 0;  // 0 when empty
+static uint8_t mirror_outbox_sent = 0;             // Bytes the FIFO has taken (core0)
 
 // Timer callback - runs in interrupt context
 static int64_t timeout_check_callback(alarm_id_t id, void *user_data) {
     (void)id;
     (void)user_data;
     
-    // Don't start screensaver if menu active or already active
-    if (screensaver_active || menu_is_active()) {
+    // Don't start screensaver if disabled, menu active or already active
+    if (screensaver_timeout_ms == 0 || screensaver_active || menu_is_active()) {
         return TIMER_CHECK_INTERVAL_MS * 1000;  // Continue checking (return microseconds)
     }
     
@@ -39,10 +113,10 @@ static int64_t timeout_check_callback(alarm_id_t id, void *user_data) {
     // In this case, use boot time as reference
     if (last_activity == 0) {
         // No activity yet - check time since boot
-        if (current_time >= SCREENSAVER_TIMEOUT_MS) {
+        if (current_time >= screensaver_timeout_ms) {
             screensaver_pending = true;
         }
-    } else if ((current_time - last_activity) >= SCREENSAVER_TIMEOUT_MS) {
+    } else if ((current_time - last_activity) >= screensaver_timeout_ms) {
         // Set flag for main loop to start screensaver
         // (can't do display operations from interrupt context)
         screensaver_pending = true;
@@ -51,6 +125,65 @@ static int64_t timeout_check_callback(alarm_id_t id, void *user_data) {
     return TIMER_CHECK_INTERVAL_MS * 1000;  // Repeat every 1 second (return microseconds)
 }
 
+#ifdef DISPLAY_CORE1
+// Display calls on core0 only describe the screen once core1 draws it
+static bool drawing_deferred(void)
+{
+    return core1_running && get_core_num() == 0;
+}
+
+// Core0: start a screen drawn from scratch
+static void snapshot_new_screen(display_screen_t screen)
+{
+    snapshot_working.screen = screen;
+    snapshot_working.screen_id++;
+    snapshot_working.border = false;
+    snapshot_working.text_count = 0;
+}
+
+// Core0: add a text line to the screen
+static void snapshot_add_text(uint8_t x, uint8_t y, const char* text, bool inverted)
+{
+    // Text over the piano roll goes on a blank screen; its image is scrolled
+    if (snapshot_working.screen == DISPLAY_SCREEN_PIANO_ROLL) {
+        snapshot_new_screen(DISPLAY_SCREEN_TEXT);
+    }
+    if (snapshot_working.text_count == DISPLAY_TEXT_MAX) {
+        snapshot_text_dropped++;
+        debug_error("Display: More than %d text lines on a screen, \"%s\" dropped",
+                    DISPLAY_TEXT_MAX, text);
+        return;
+    }
+    
+    display_text_t* line = &snapshot_working.text[snapshot_working.text_count++];
+    line->x = x;
+    line->y = y;
+    line->inverted = inverted;
+    strncpy(line->text, text, DISPLAY_TEXT_CHARS - 1);
+    line->text[DISPLAY_TEXT_CHARS - 1] = '\0';
+}
+
+// Core0: describe the home screen
+static void snapshot_home(void)
+{
+    snapshot_new_screen(DISPLAY_SCREEN_TEXT);
+    snapshot_working.border = true;
+    snapshot_add_text(5, 20, "Zoft Synthesizer V1", false);
+}
+
+// Core0: hand the working snapshot to core1
+static void snapshot_publish(void)
+{
+    display_snapshot_publish(&snapshot_working);
+}
+
+// Core0: hand the working notes to core1 (before a screen showing them)
+static void notes_publish(void)
+{
+    display_snapshot_publish_notes(&notes_working);
+}
+#endif
+
 bool display_handler_init(void* i2c_inst)
 {
     display_i2c = i2c_inst;
@@ -67,8 +200,21 @@ bool display_handler_init(void* i2c_inst)
         oled_display();
         is_home_screen = true;
         
+        // From here on frames go out a slice per main loop pass
+        oled_set_flush_budget(DISPLAY_FLUSH_BUDGET_BYTES, DISPLAY_FLUSH_BUDGET_US);
+        
+#ifdef DISPLAY_CORE1
+        // Core1 takes the display over, starting from the boot screen
+        snapshot_home();
+        snapshot_publish();
+        core1_running = true;
+        multicore_launch_core1(display_core1_main);
+        debug_info("Display Handler: Rendering on core1");
+#endif
+        
         // Initialize activity tracking - set to current time so screensaver
-        // will start 30 seconds after boot if no activity
+        // will start display_timeout seconds after boot if no activity
+        screensaver_timeout_ms = midi_handler_get_display_timeout() * 1000u;
         extern void button_init_activity_time(void);
         extern void midi_handler_init_activity_time(void);
         button_init_activity_time();
@@ -86,6 +232,462 @@ bool display_handler_init(void* i2c_inst)
     }
 }
 
+// Lane of a note in the configured range, -1 if outside it
+static int piano_roll_lane(uint8_t note)
+{
+    uint8_t low = midi_handler_get_low_note();
+    uint8_t range = midi_handler_get_note_range();
+    if (range > OLED_PIANO_ROLL_MAX_LANES) {
+        range = OLED_PIANO_ROLL_MAX_LANES;
+    }
+    if (note < low || note >= low + range) {
+        return -1;
+    }
+    return note - low;
+}
+
+// Leave the piano roll before drawing over it; its image is scrolled
+static void piano_roll_stop(void)
+{
+    if (piano_roll_running) {
+        piano_roll_running = false;
+        oled_clear();
+    }
+}
+
+// Start drawing the screensaver from its first frame
+static void screensaver_begin(void)
+{
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        snapshot_new_screen(DISPLAY_SCREEN_SCREENSAVER);
+        snapshot_publish();
+        return;
+    }
+#endif
+    
+    piano_roll_running = false;
+    lissajous_screensaver_init();
+    screensaver_frame_us = 0;   // First frame right away
+}
+
+// Draw the next screensaver frame when the pacing allows it
+static void screensaver_step(void)
+{
+    // Let the last frame go out completely before drawing the next
+    if (!oled_flush_idle()) {
+        return;
+    }
+    
+    // Wait out the frame period, stretched if the last frame's bus time
+    // would push display traffic over its share of the bus
+    uint64_t now = time_us_64();
+    uint32_t bus_used = oled_get_bus_time_us() - screensaver_bus_mark;
+    uint64_t min_gap = 1000000 / SCREENSAVER_FPS;
+    uint64_t bus_gap = (uint64_t)bus_used * 100 / SCREENSAVER_BUS_PERCENT;
+    if (bus_gap > min_gap) {
+        min_gap = bus_gap;
+    }
+    if (screensaver_frame_us != 0 && now - screensaver_frame_us < min_gap) {
+        return;
+    }
+    
+    screensaver_frame_us = now;
+    screensaver_bus_mark = oled_get_bus_time_us();
+    lissajous_screensaver_update();
+}
+
+/**
+ * Run-length encode the changes of a page from a column on
+ * 
+ * The data is the XOR of the frame with what the host has, so unchanged
+ * columns are zero bytes, coded PackBits style: a header n of 0-127 is
+ * followed by n + 1 literal bytes, a header of 129-255 by one byte that
+ * repeats 257 - n times.
+ * 
+ * @param page Page to encode
+ * @param column First column
+ * @param last Last column to cover
+ * @param out Encoded bytes (at most MIRROR_ENCODED_MAX)
+ * @param length Set to the encoded length
+ * @return Columns covered
+ */
+static uint8_t mirror_encode(uint8_t page, uint8_t column, uint8_t last, uint8_t* out, uint8_t* length)
+{
+    const uint8_t* frame = oled_get_frame_page(page);
+    const uint8_t* sent = mirror_frame[page];
+    uint8_t n = 0;
+    uint16_t x = column;
+    
+    while (x <= last && n + 2 <= MIRROR_ENCODED_MAX) {
+        uint8_t delta = frame[x] ^ sent[x];
+        uint16_t run = 1;
+        while (x + run <= last && run < 128 && (frame[x + run] ^ sent[x + run]) == delta) {
+            run++;
+        }
+        
+        if (run >= 3) {
+            out[n++] = (uint8_t)(257 - run);
+            out[n++] = delta;
+            x += run;
+            continue;
+        }
+        
+        // Literal bytes up to the next run of three
+        uint8_t header = n++;
+        uint8_t count = 0;
+        while (x <= last && count < 128 && n < MIRROR_ENCODED_MAX) {
+            if (x + 2 <= last &&
+                (frame[x] ^ sent[x]) == (frame[x + 1] ^ sent[x + 1]) &&
+                (frame[x] ^ sent[x]) == (frame[x + 2] ^ sent[x + 2])) {
+                break;
+            }
+            out[n++] = frame[x] ^ sent[x];
+            count++;
+            x++;
+        }
+        out[header] = count - 1;
+    }
+    
+    *length = n;
+    return x - column;
+}
+
+/**
+ * Pack bytes into 7-bit SysEx data: each group of up to 7 bytes is sent
+ * as a byte holding their top bits (bit i for byte i) and their low 7 bits
+ * 
+ * @return Packed length
+ */
+static uint8_t mirror_pack7(const uint8_t* in, uint8_t length, uint8_t* out)
+{
+    uint8_t n = 0;
+    
+    for (uint8_t i = 0; i < length; i += 7) {
+        uint8_t msbs = n++;
+        out[msbs] = 0;
+        for (uint8_t j = 0; j < 7 && i + j < length; j++) {
+            out[msbs] |= (in[i + j] >> 7) << j;
+            out[n++] = in[i + j] & 0x7F;
+        }
+    }
+    return n;
+}
+
+// Core0: send what the USB FIFO has not taken yet of the outbox message
+static void mirror_outbox_send(void)
+{
+    uint8_t length = mirror_outbox_length;
+    if (length == 0) {
+        return;
+    }
+#ifdef DISPLAY_CORE1
+    __dmb();
+#endif
+    mirror_outbox_sent += usb_midi_send_sysex_part(&mirror_outbox[mirror_outbox_sent],
+                                                   length - mirror_outbox_sent);
+    if (mirror_outbox_sent == length) {
+        mirror_outbox_sent = 0;
+#ifdef DISPLAY_CORE1
+        __dmb();
+#endif
+        mirror_outbox_length = 0;
+    }
+}
+
+// Queue a mirror message (false while the last one is still going out)
+static bool mirror_post(const uint8_t* msg, uint8_t length)
+{
+    if (mirror_outbox_length != 0) {
+        return false;
+    }
+    memcpy(mirror_outbox, msg, length);
+#ifdef DISPLAY_CORE1
+    // Core0 sends it from display_handler_task()
+    __dmb();
+    mirror_outbox_length = length;
+#else
+    mirror_outbox_length = length;
+    mirror_outbox_send();
+#endif
+    return true;
+}
+
+// Send the first changed span of the frame (or just the start line)
+static void mirror_send_next(void)
+{
+    uint8_t start_line = oled_get_frame_start_line();
+    uint8_t page = 0;
+    int16_t column = -1;
+    int16_t last = -1;
+    
+    for (; page < OLED_PAGES && column < 0; page++) {
+        const uint8_t* frame = oled_get_frame_page(page);
+        for (uint8_t x = 0; x < OLED_WIDTH; x++) {
+            if (frame[x] != mirror_frame[page][x]) {
+                if (column < 0) {
+                    column = x;
+                }
+                last = x;
+            }
+        }
+    }
+    page--;
+    
+    if (column < 0 && start_line == mirror_start_line) {
+        mirror_pending = false;
+        return;
+    }
+    
+    uint8_t encoded[MIRROR_ENCODED_MAX];
+    uint8_t encoded_length = 0;
+    uint8_t columns = 0;
+    if (column < 0) {
+        page = 0;
+        column = 0;
+    } else {
+        columns = mirror_encode(page, column, last, encoded, &encoded_length);
+    }
+    
+    uint8_t msg[DISPLAY_MIRROR_MESSAGE_MAX];
+    uint8_t n = 0;
+    msg[n++] = 0xF0;
+    msg[n++] = MIDI_SYSEX_MANUFACTURER_ID;
+    msg[n++] = MIDI_SYSEX_DEVICE_ID;
+    msg[n++] = DISPLAY_MIRROR_SYSEX_CMD;
+    msg[n++] = page;
+    msg[n++] = column;
+    msg[n++] = start_line;
+    n += mirror_pack7(encoded, encoded_length, &msg[n]);
+    msg[n++] = 0xF7;
+    
+    if (!mirror_post(msg, n)) {
+        return;
+    }
+    memcpy(&mirror_frame[page][column], &oled_get_frame_page(page)[column], columns);
+    mirror_start_line = start_line;
+}
+
+static void mirror_task(void)
+{
+    uint64_t now = time_us_64();
+    if (!mirror_enabled || now < mirror_next_us) {
+        return;
+    }
+    
+    if (oled_get_frame_count() != mirror_frame_count) {
+        mirror_frame_count = oled_get_frame_count();
+        mirror_pending = true;
+    }
+    if (!mirror_pending) {
+        return;
+    }
+    
+    mirror_send_next();
+    mirror_next_us = now + DISPLAY_MIRROR_INTERVAL_MS * 1000;
+}
+
+// Start mirroring from a blank frame, or stop
+static void mirror_reset(bool enabled)
+{
+    mirror_enabled = enabled;
+    
+    // The host starts from a blank frame
+    memset(mirror_frame, 0, sizeof(mirror_frame));
+    mirror_start_line = 0;
+    mirror_pending = enabled;
+    mirror_next_us = 0;
+}
+
+// The host has been sent the current frame
+static bool mirror_caught_up(void)
+{
+    return !mirror_enabled || (!mirror_pending && oled_get_frame_count() == mirror_frame_count);
+}
+
+#ifdef DISPLAY_CORE1
+// Core1: bring the frame up to a snapshot and the notes read with it
+static void core1_draw(const display_snapshot_t* snapshot, bool new_notes)
+{
+    if (snapshot->mirror_epoch != mirror_epoch_seen) {
+        mirror_epoch_seen = snapshot->mirror_epoch;
+        mirror_reset(snapshot->mirror_enabled);
+    }
+    
+    if (snapshot->screen_id != drawn_screen_id) {
+        drawn_screen_id = snapshot->screen_id;
+        drawn_text = 0;
+        piano_roll_running = false;
+        
+        switch (snapshot->screen) {
+            case DISPLAY_SCREEN_TEXT:
+                oled_clear();
+                if (snapshot->border) {
+                    oled_draw_border();
+                }
+                break;
+                
+            case DISPLAY_SCREEN_NOTE:
+                oled_display_single_note(notes_drawn.note, notes_drawn.velocity, notes_drawn.channel);
+                break;
+                
+            case DISPLAY_SCREEN_PIANO_ROLL:
+                oled_piano_roll_begin(snapshot->roll_range);
+                piano_roll_running = true;
+                memset(roll_strikes_seen, 0, sizeof(roll_strikes_seen));
+                piano_roll_next_us = time_us_64();
+                break;
+                
+            case DISPLAY_SCREEN_SCREENSAVER:
+                screensaver_begin();
+                break;
+                
+            case DISPLAY_SCREEN_CUSTOM:
+                snapshot->draw(snapshot->state);
+                break;
+        }
+    } else if (new_notes && snapshot->screen == DISPLAY_SCREEN_NOTE) {
+        // Same screen, next note: the text goes back over it
+        oled_display_single_note(notes_drawn.note, notes_drawn.velocity, notes_drawn.channel);
+        drawn_text = 0;
+    }
+    
+    for (; drawn_text < snapshot->text_count; drawn_text++) {
+        const display_text_t* line = &snapshot->text[drawn_text];
+        if (line->inverted) {
+            oled_draw_string_inverted(line->x, line->y, line->text);
+        } else {
+            oled_draw_string(line->x, line->y, line->text);
+        }
+    }
+    oled_display();
+}
+
+// Core1: draw what core0 describes and keep the frames going out
+static void display_core1_main(void)
+{
+    uint32_t snapshot_count = 0;
+    uint32_t notes_count = 0;
+    
+    while (true) {
+        // The screen first: notes published before it are then read with it
+        uint32_t published = display_snapshot_count();
+        bool new_screen = display_snapshot_read(&snapshot_drawn, &snapshot_count);
+        bool new_notes = display_snapshot_read_notes(&notes_drawn, &notes_count);
+        if (new_screen || new_notes) {
+            core1_draw(&snapshot_drawn, new_notes);
+        }
+        
+        if (piano_roll_running && time_us_64() >= piano_roll_next_us) {
+            // A note shorter than a tick still leaves a mark
+            uint16_t struck = 0;
+            for (uint8_t lane = 0; lane < OLED_PIANO_ROLL_MAX_LANES; lane++) {
+                if (notes_drawn.roll_strikes[lane] != roll_strikes_seen[lane]) {
+                    roll_strikes_seen[lane] = notes_drawn.roll_strikes[lane];
+                    struck |= 1u << lane;
+                }
+            }
+            oled_piano_roll_tick(notes_drawn.roll_held | struck);
+            piano_roll_next_us = time_us_64() + PIANO_ROLL_TICK_MS * 1000;
+        }
+        
+        if (snapshot_drawn.screen == DISPLAY_SCREEN_SCREENSAVER) {
+            screensaver_step();
+        }
+        
+        oled_flush_step();
+        mirror_task();
+        
+        core1_mirror_idle = mirror_caught_up() && mirror_outbox_length == 0;
+        if (oled_flush_idle()) {
+            snapshot_shown = published;
+        }
+    }
+}
+#endif
+
+void display_handler_set_mirror(bool enabled)
+{
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        snapshot_working.mirror_enabled = enabled;
+        snapshot_working.mirror_epoch++;
+        snapshot_publish();
+        return;
+    }
+#endif
+    
+    mirror_reset(enabled);
+}
+
+bool display_handler_get_mirror(void)
+{
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        return snapshot_working.mirror_enabled;
+    }
+#endif
+    
+    return mirror_enabled;
+}
+
+bool display_handler_mirror_idle(void)
+{
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        return !snapshot_working.mirror_enabled || (core1_mirror_idle && snapshot_shown == display_snapshot_count());
+    }
+#endif
+    
+    return mirror_caught_up() && mirror_outbox_length == 0;
+}
+
+void display_handler_task(void)
+{
+    if (!display_initialized) {
+        return;
+    }
+    
+    // USB stays on core0
+    mirror_outbox_send();
+    
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        return;     // Core1 does the rest
+    }
+#endif
+    
+    if (piano_roll_running && time_us_64() >= piano_roll_next_us) {
+        // A note shorter than a tick still leaves a mark
+        oled_piano_roll_tick(piano_roll_held | piano_roll_struck);
+        piano_roll_struck = 0;
+        piano_roll_next_us = time_us_64() + PIANO_ROLL_TICK_MS * 1000;
+    }
+    
+    oled_flush_step();
+    mirror_task();
+}
+
+void display_handler_flush(void)
+{
+    if (!display_initialized) {
+        return;
+    }
+    
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        // Wait until core1 has drawn and sent all that is described so far
+        uint32_t target = display_snapshot_count();
+        while ((int32_t)(snapshot_shown - target) < 0) {
+            tight_loop_contents();
+        }
+        return;
+    }
+#endif
+    
+    oled_display_flush();
+}
+
 void display_handler_update_note(uint8_t note, uint8_t velocity, uint8_t channel)
 {
     if (!display_initialized) {
@@ -93,9 +695,105 @@ void display_handler_update_note(uint8_t note, uint8_t velocity, uint8_t channel
     }
     
     screensaver_active = false;
+    is_home_screen = false;
+    
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        // Only a new screen publishes the whole snapshot; a note on the
+        // screen already up publishes just the notes
+        bool new_screen;
+        if (note_view == DISPLAY_NOTE_VIEW_PIANO_ROLL) {
+            new_screen = snapshot_working.screen != DISPLAY_SCREEN_PIANO_ROLL;
+            if (new_screen) {
+                notes_working.roll_held = 0;
+                memset(notes_working.roll_strikes, 0, sizeof(notes_working.roll_strikes));
+            }
+            int lane = piano_roll_lane(note);
+            if (lane >= 0) {
+                notes_working.roll_held |= 1u << lane;
+                notes_working.roll_strikes[lane]++;
+            }
+        } else {
+            new_screen = snapshot_working.screen != DISPLAY_SCREEN_NOTE || snapshot_working.text_count > 0;
+            notes_working.note = note;
+            notes_working.velocity = velocity;
+            notes_working.channel = channel;
+        }
+        notes_publish();
+        
+        if (new_screen) {
+            if (note_view == DISPLAY_NOTE_VIEW_PIANO_ROLL) {
+                snapshot_new_screen(DISPLAY_SCREEN_PIANO_ROLL);
+                snapshot_working.roll_range = midi_handler_get_note_range();
+            } else {
+                snapshot_new_screen(DISPLAY_SCREEN_NOTE);
+            }
+            snapshot_publish();
+        }
+        return;
+    }
+#endif
+    
+    if (note_view == DISPLAY_NOTE_VIEW_PIANO_ROLL) {
+        if (!piano_roll_running) {
+            uint8_t range = midi_handler_get_note_range();
+            oled_piano_roll_begin(range);
+            piano_roll_running = true;
+            piano_roll_held = 0;
+            piano_roll_struck = 0;
+            piano_roll_next_us = time_us_64();
+        }
+        int lane = piano_roll_lane(note);
+        if (lane >= 0) {
+            piano_roll_held |= 1u << lane;
+            piano_roll_struck |= 1u << lane;
+        }
+        return;
+    }
+    
     // Display the MIDI note information
     oled_display_single_note(note, velocity, channel);
-    is_home_screen = false;
+}
+
+void display_handler_note_off(uint8_t note)
+{
+    int lane = piano_roll_lane(note);
+    
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        if (lane >= 0 && (notes_working.roll_held & (1u << lane))) {
+            notes_working.roll_held &= ~(1u << lane);
+            notes_publish();
+        }
+        return;
+    }
+#endif
+    
+    if (lane >= 0) {
+        piano_roll_held &= ~(1u << lane);
+    }
+}
+
+void display_handler_set_note_view(display_note_view_t view)
+{
+    note_view = view;
+    
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        // The roll stops with whatever is described next
+        if (snapshot_working.screen == DISPLAY_SCREEN_PIANO_ROLL) {
+            snapshot_new_screen(DISPLAY_SCREEN_TEXT);
+        }
+        return;
+    }
+#endif
+    
+    piano_roll_running = false;
+}
+
+display_note_view_t display_handler_get_note_view(void)
+{
+    return note_view;
 }
 
 void display_handler_clear(void)
@@ -104,6 +802,16 @@ void display_handler_clear(void)
         return;
     }
     
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        snapshot_new_screen(DISPLAY_SCREEN_TEXT);
+        snapshot_working.border = true;
+        snapshot_publish();
+        return;
+    }
+#endif
+    
+    piano_roll_running = false;
     oled_clear();
     oled_draw_border();
     oled_display();
@@ -115,6 +823,15 @@ void display_handler_writeline(uint8_t x, uint8_t y, const char* text)
         return;
     }
     
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        snapshot_add_text(x, y, text, false);
+        snapshot_publish();
+        return;
+    }
+#endif
+    
+    piano_roll_stop();
     oled_draw_string(x, y, text);
     oled_display();
 }
@@ -125,6 +842,15 @@ void display_handler_writeline_inverted(uint8_t x, uint8_t y, const char* text)
         return;
     }
     
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        snapshot_add_text(x, y, text, true);
+        snapshot_publish();
+        return;
+    }
+#endif
+    
+    piano_roll_stop();
     oled_draw_string_inverted(x, y, text);
     oled_display();
 }
@@ -136,6 +862,17 @@ void display_handler_show_home(void)
     }
     
     screensaver_active = false;
+    
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        snapshot_home();
+        snapshot_publish();
+        is_home_screen = true;
+        return;
+    }
+#endif
+    
+    piano_roll_running = false;
     oled_clear();
     oled_draw_border();
     oled_draw_string(5, 20, "Zoft Synthesizer V1");
@@ -156,7 +893,7 @@ void display_handler_screensaver_start(void)
     
     screensaver_active = true;
     is_home_screen = false;
-    lissajous_screensaver_init();
+    screensaver_begin();
 }
 
 void display_handler_screensaver_stop(void)
@@ -177,7 +914,10 @@ void display_handler_screensaver_update(void)
         return;
     }
     
-    lissajous_screensaver_update();
+#ifndef DISPLAY_CORE1
+    // With DISPLAY_CORE1, core1 paces the frames itself
+    screensaver_step();
+#endif
 }
 
 bool display_handler_is_screensaver_active(void)
@@ -191,7 +931,40 @@ void display_handler_check_timeout(void)
         screensaver_pending = false;
         screensaver_active = true;
         is_home_screen = false;
-        lissajous_screensaver_init();
+        screensaver_begin();
         debug_info("Display: Screensaver started by timer");
     }
 }
+
+void display_handler_show_screen(display_screen_fn_t draw, const void* state, uint16_t size)
+{
+    if (!display_initialized || draw == NULL) {
+        return;
+    }
+    if (size > DISPLAY_SCREEN_STATE_MAX) {
+        debug_error("Display: Screen state of %u bytes dropped", size);
+        return;
+    }
+    
+#ifdef DISPLAY_CORE1
+    if (drawing_deferred()) {
+        snapshot_new_screen(DISPLAY_SCREEN_CUSTOM);
+        snapshot_working.draw = draw;
+        snapshot_working.state_size = size;
+        memcpy(snapshot_working.state, state, size);
+        snapshot_publish();
+        return;
+    }
+#endif
+    
+    draw(state);
+}
+
+uint32_t display_handler_get_text_dropped(void)
+{
+#ifdef DISPLAY_CORE1
+    return snapshot_text_dropped;
+#else
+    return 0;
+#endif
+}
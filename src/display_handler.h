@@ -4,6 +4,27 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Framebuffer mirror messages: F0 7D 00 61 <page> <column> <start line> <data> F7
+#define DISPLAY_MIRROR_SYSEX_CMD    0x61
+#define DISPLAY_MIRROR_MESSAGE_MAX  48    // Bytes, F0 to F7 (16 USB-MIDI packets)
+
+/**
+ * What a Note On shows
+ */
+typedef enum {
+    DISPLAY_NOTE_VIEW_SINGLE = 0,     // Last note with velocity and channel
+    DISPLAY_NOTE_VIEW_PIANO_ROLL = 1  // Scrolling roll of the notes in range
+} display_note_view_t;
+
+// Largest state a screen shown with display_handler_show_screen() carries
+// (the menu page: three rows of rendered font columns)
+#define DISPLAY_SCREEN_STATE_MAX    360
+
+/**
+ * Draws a whole screen with the OLED library (see display_handler_show_screen())
+ */
+typedef void (*display_screen_fn_t)(const void* state);
+
 /**
  * @brief Initialize display handler
  * 
@@ -23,6 +44,27 @@ bool display_handler_init(void* i2c_inst);
  */
 void display_handler_update_note(uint8_t note, uint8_t velocity, uint8_t channel);
 
+/**
+ * @brief Tell the display a note was released (for the piano roll)
+ * 
+ * @param note MIDI note number (0-127)
+ */
+void display_handler_note_off(uint8_t note);
+
+/**
+ * @brief Select what a Note On shows
+ * 
+ * @param view DISPLAY_NOTE_VIEW_SINGLE or DISPLAY_NOTE_VIEW_PIANO_ROLL
+ */
+void display_handler_set_note_view(display_note_view_t view);
+
+/**
+ * @brief Get what a Note On shows
+ * 
+ * @return Current note view
+ */
+display_note_view_t display_handler_get_note_view(void);
+
 /**
  * @brief Clear the display
  */
@@ -46,6 +88,22 @@ void display_handler_writeline(uint8_t x, uint8_t y, const char* text);
  */
 void display_handler_writeline_inverted(uint8_t x, uint8_t y, const char* text);
 
+/**
+ * @brief Show a screen drawn by the caller
+ * 
+ * Calls draw(state) right away. With DISPLAY_CORE1 the state is copied
+ * into the snapshot and core1 calls draw with the copy: draw must take
+ * everything it shows from state, never from core0 (such as the MIDI
+ * settings), and commit the frame with oled_display(). The state only
+ * lives for the call: columns drawn with oled_draw_columns(), which tile
+ * mode keeps a pointer to, must be copied somewhere lasting first.
+ * 
+ * @param draw Function drawing the screen
+ * @param state What the screen shows (e.g. rendered menu rows)
+ * @param size Bytes of state, at most DISPLAY_SCREEN_STATE_MAX
+ */
+void display_handler_show_screen(display_screen_fn_t draw, const void* state, uint16_t size);
+
 /**
  * @brief Show the home screen
  */
@@ -86,4 +144,51 @@ bool display_handler_is_screensaver_active(void);
  */
 void display_handler_check_timeout(void);
 
+/**
+ * @brief Send the next slice of a pending display frame
+ * Call this from main loop
+ */
+void display_handler_task(void);
+
+/**
+ * @brief Send the pending display frame right away
+ * Use before holding a message on screen with a blocking delay
+ */
+void display_handler_flush(void);
+
+/**
+ * @brief Stream frame changes to the USB host as SysEx
+ * 
+ * Off by default. Turning it on sends the whole frame (as changes from a
+ * blank one), then only the columns that change, compressed and paced to
+ * at most one message every 10 ms. See SYSEX_COMMANDS.md.
+ * 
+ * @param enabled true to start mirroring, false to stop
+ */
+void display_handler_set_mirror(bool enabled);
+
+/**
+ * @brief Check whether the framebuffer mirror is on
+ * 
+ * @return true if frame changes are streamed over USB
+ */
+bool display_handler_get_mirror(void);
+
+/**
+ * @brief Check whether the USB host has been sent the current frame
+ * 
+ * @return true if the mirror is off or has caught up
+ */
+bool display_handler_mirror_idle(void);
+
+/**
+ * @brief Get the number of text lines dropped from full screens
+ * 
+ * With DISPLAY_CORE1 a screen holds DISPLAY_TEXT_MAX text lines; lines
+ * written past that are not shown. Always 0 without DISPLAY_CORE1.
+ * 
+ * @return Lines dropped since boot
+ */
+uint32_t display_handler_get_text_dropped(void);
+
 #endif // DISPLAY_HANDLER_H
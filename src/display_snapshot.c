@@ -0,0 +1,95 @@
+#include "display_snapshot.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+//--------------------------------------------------------------------+
+// Internal State
+//--------------------------------------------------------------------+
+
+typedef struct {
+    volatile uint32_t sequence[2];   // Per slot, odd while core0 writes it
+    volatile uint8_t slot;           // Slot published last
+    volatile uint32_t count;         // Publishes so far
+} display_buffer_t;
+
+static display_buffer_t snapshot_buffer;
+static display_snapshot_t snapshot_slots[2];
+static display_buffer_t notes_buffer;
+static display_notes_t notes_slots[2];
+static volatile uint32_t publish_count = 0;      // Snapshots and notes so far
+
+//--------------------------------------------------------------------+
+// Helpers
+//--------------------------------------------------------------------+
+
+static void buffer_publish(display_buffer_t* buffer, void* slots, const void* data, size_t size)
+{
+    // The slot core1 is not reading
+    uint8_t index = buffer->slot ^ 1;
+
+    buffer->sequence[index]++;
+    __dmb();
+    memcpy((uint8_t*)slots + index * size, data, size);
+    __dmb();
+    buffer->sequence[index]++;
+    buffer->slot = index;
+    __dmb();
+    buffer->count++;
+    publish_count++;
+}
+
+static bool buffer_read(const display_buffer_t* buffer, const void* slots, void* out, size_t size,
+                        uint32_t* count)
+{
+    uint32_t published = buffer->count;
+    if (published == *count) {
+        return false;
+    }
+    __dmb();
+
+    while (true) {
+        uint8_t index = buffer->slot;
+        uint32_t sequence = buffer->sequence[index];
+        __dmb();
+        if (sequence & 1) {
+            continue;       // Core0 is already past it: a newer slot follows
+        }
+        memcpy(out, (const uint8_t*)slots + index * size, size);
+        __dmb();
+        if (buffer->sequence[index] == sequence) {
+            break;
+        }
+    }
+
+    *count = published;
+    return true;
+}
+
+//--------------------------------------------------------------------+
+// Public API Implementation
+//--------------------------------------------------------------------+
+
+void display_snapshot_publish(const display_snapshot_t* snapshot)
+{
+    buffer_publish(&snapshot_buffer, snapshot_slots, snapshot, sizeof(*snapshot));
+}
+
+void display_snapshot_publish_notes(const display_notes_t* notes)
+{
+    buffer_publish(&notes_buffer, notes_slots, notes, sizeof(*notes));
+}
+
+bool display_snapshot_read(display_snapshot_t* out, uint32_t* count)
+{
+    return buffer_read(&snapshot_buffer, snapshot_slots, out, sizeof(*out), count);
+}
+
+bool display_snapshot_read_notes(display_notes_t* out, uint32_t* count)
+{
+    return buffer_read(&notes_buffer, notes_slots, out, sizeof(*out), count);
+}
+
+uint32_t display_snapshot_count(void)
+{
+    return publish_count;
+}
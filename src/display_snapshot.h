@@ -0,0 +1,103 @@
+#ifndef DISPLAY_SNAPSHOT_H
+#define DISPLAY_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "display_handler.h"
+#include "oled_display.h"
+
+//--------------------------------------------------------------------+
+// Display Snapshots (DISPLAY_CORE1)
+//--------------------------------------------------------------------+
+
+// Core0 describes the screen in a snapshot and publishes it; core1 reads
+// the latest one and draws it. Nothing is locked: core0 fills one slot of
+// a double buffer while core1 copies the other, and a slot's sequence is
+// odd while it is written, so a copy that raced a write is taken again.
+//
+// The note and the piano roll lanes change on every Note On and Off, so
+// they go through a second, small double buffer of their own instead of
+// the whole snapshot. Core0 publishes them before a screen showing them;
+// core1 reads the screen first, so it never draws a screen with notes
+// older than the ones it was published with.
+
+#define DISPLAY_TEXT_MAX    (OLED_HEIGHT / 8)   // A full panel of text, one line per page
+#define DISPLAY_TEXT_CHARS  22                  // 21 characters fit across the panel
+
+typedef enum {
+    DISPLAY_SCREEN_TEXT,          // Blank, with or without the border
+    DISPLAY_SCREEN_NOTE,          // oled_display_single_note()
+    DISPLAY_SCREEN_PIANO_ROLL,
+    DISPLAY_SCREEN_SCREENSAVER,
+    DISPLAY_SCREEN_CUSTOM         // display_handler_show_screen()
+} display_screen_t;
+
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+    bool inverted;
+    char text[DISPLAY_TEXT_CHARS];
+} display_text_t;
+
+typedef struct {
+    uint32_t screen_id;                               // Changes when the screen is drawn from scratch
+    display_screen_t screen;
+    bool border;
+    uint8_t roll_range;
+    bool mirror_enabled;
+    uint8_t mirror_epoch;                             // Bumped by display_handler_set_mirror()
+    uint8_t text_count;
+    display_text_t text[DISPLAY_TEXT_MAX];            // Drawn over the screen, in order
+    display_screen_fn_t draw;
+    uint16_t state_size;
+    uint32_t state[DISPLAY_SCREEN_STATE_MAX / sizeof(uint32_t)];  // Passed to draw
+} display_snapshot_t;
+
+typedef struct {
+    uint8_t note;                                     // DISPLAY_SCREEN_NOTE
+    uint8_t velocity;
+    uint8_t channel;
+    uint16_t roll_held;                               // Lanes whose note is down
+    uint8_t roll_strikes[OLED_PIANO_ROLL_MAX_LANES];  // Note Ons per lane (wraps)
+} display_notes_t;
+
+/**
+ * Core0: hand a snapshot to core1
+ *
+ * @param snapshot Screen described so far (copied)
+ */
+void display_snapshot_publish(const display_snapshot_t* snapshot);
+
+/**
+ * Core0: hand the notes to core1
+ *
+ * @param notes Note and piano roll lanes (copied)
+ */
+void display_snapshot_publish_notes(const display_notes_t* notes);
+
+/**
+ * Core1: copy the snapshot published last
+ *
+ * @param out Snapshot copy, whole and from a single publish
+ * @param count Snapshots published at the last copy, updated
+ * @return true if there was a new snapshot
+ */
+bool display_snapshot_read(display_snapshot_t* out, uint32_t* count);
+
+/**
+ * Core1: copy the notes published last
+ *
+ * @param out Notes copy, whole and from a single publish
+ * @param count Notes published at the last copy, updated
+ * @return true if there were new notes
+ */
+bool display_snapshot_read_notes(display_notes_t* out, uint32_t* count);
+
+/**
+ * Get the number of snapshots and notes published so far
+ *
+ * @return Publish count of both (wraps)
+ */
+uint32_t display_snapshot_count(void);
+
+#endif // DISPLAY_SNAPSHOT_H
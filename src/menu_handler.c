@@ -27,48 +27,60 @@ static const char* menu_names[MENU_OPTION_COUNT] = {
     "MIDI Channel",
     "Note Range",
     "Semitone Mode",
+    "Note View",
     "View Settings",
     "All Notes Off",
     "Exit Menu"
 };
 
+// Hold a message on screen; it has to be fully sent before the wait, since
+// the main loop that normally streams display frames out is blocked
+static void show_for_ms(uint32_t ms) {
+    display_handler_flush();
+    sleep_ms(ms);
+}
+
+// A menu line as font columns (" #. Menu Name", padded to 20 characters)
+#define MENU_LINE_CHARS   20
+#define MENU_LINE_COLUMNS (MENU_LINE_CHARS * 6)
+
+// What the menu page shows: the options in the three visible rows
+typedef struct {
+    uint8_t options[3];                     // Previous, selected (inverted), next
+} menu_page_t;
+
+// Used only where the page is drawn (core1 with DISPLAY_CORE1)
+static bool menu_page_drawn = false;        // Title and rule on screen
+static uint32_t menu_page_clear_count = 0;  // oled_clear() count when they were drawn
+static uint8_t menu_rows_shown[3][MENU_LINE_COLUMNS];  // Rows on screen (tile mode keeps pointers to them)
+
+static void render_menu_line(uint8_t option, uint8_t* columns) {
+    char line[32];
+    
+    // Format with number: " #. Menu Name", padded with spaces
+    snprintf(line, sizeof(line), " %d. %-*s", option + 1, MENU_LINE_CHARS - 4, menu_names[option]);
+    oled_render_string(line, columns, MENU_LINE_COLUMNS);
+}
+
 //--------------------------------------------------------------------+
 // Settings View Functions
 //--------------------------------------------------------------------+
 
-static void display_settings_view(void) {
-    const uint8_t max_lines = 6;  // Maximum lines that fit on display
+#define SETTINGS_VIEW_LINES 9     // Settings listed
+#define SETTINGS_VIEW_ROWS  6     // Lines that fit on the display
+
+// What the settings view shows, built from the current settings
+typedef struct {
+    uint8_t offset;                         // First line shown
+    char lines[SETTINGS_VIEW_LINES][22];    // 21 chars + null terminator
+} settings_view_t;
+
+// Draw the settings view (see display_handler_show_screen())
+static void draw_settings_view(const void* state) {
+    const settings_view_t* view = (const settings_view_t*)state;
     const uint8_t line_height = 10;
     const uint8_t start_y = 2;
     
-    // Get current settings
-    uint8_t channel = midi_handler_get_channel();
-    uint8_t semitone = midi_handler_get_semitone_mode();
-    uint8_t player_type = midi_handler_get_player_type();
-    uint8_t note_range = midi_handler_get_note_range();
-    uint8_t low_note = midi_handler_get_low_note();
-    uint8_t high_note = midi_handler_get_high_note();
-    uint8_t io_type = midi_handler_get_io_type();
-    uint8_t io_addr = midi_handler_get_io_address();
-    
-    const char* semitone_names[] = {"PLAY", "IGNORE", "SKIP"};
-    const char* player_names[] = {"I2C MIDI", "Mallet MIDI"};
-    const char* io_type_names[] = {"PCF8574", "CH423"};
-    
-    // Build settings array - increased to accommodate more settings
-    char settings[10][22];  // 10 settings, 21 chars + null terminator
-    uint8_t total_settings = 0;
-    
-    snprintf(settings[total_settings++], 22, "Channel: %d", channel);
-    snprintf(settings[total_settings++], 22, "Player: %s", player_names[player_type]);
-    snprintf(settings[total_settings++], 22, "Semitone: %s", semitone_names[semitone]);
-    snprintf(settings[total_settings++], 22, "Note Range: %d", note_range);
-    snprintf(settings[total_settings++], 22, "Low Note: %d", low_note);
-    snprintf(settings[total_settings++], 22, "High Note: %d", high_note);
-    snprintf(settings[total_settings++], 22, "I2C Freq: 400kHz");
-    snprintf(settings[total_settings++], 22, "IO Type: %s", io_type_names[io_type]);
-    snprintf(settings[total_settings++], 22, "IO Addr: 0x%02X", io_addr);
-    
     // Clear display
     display_handler_clear();
     
@@ -82,22 +94,54 @@ static void display_settings_view(void) {
     
     // Display settings starting from offset
     uint8_t y_pos = start_y + 13;
-    for (uint8_t i = 0; i < max_lines && (settings_view_offset + i) < total_settings; i++) {
-        display_handler_writeline(2, y_pos, settings[settings_view_offset + i]);
+    for (uint8_t i = 0; i < SETTINGS_VIEW_ROWS && (view->offset + i) < SETTINGS_VIEW_LINES; i++) {
+        display_handler_writeline(2, y_pos, view->lines[view->offset + i]);
         y_pos += line_height;
     }
     
     // Show scroll indicator if more settings available
-    if (settings_view_offset + max_lines < total_settings) {
+    if (view->offset + SETTINGS_VIEW_ROWS < SETTINGS_VIEW_LINES) {
         display_handler_writeline(110, 56, "v");
     }
-    if (settings_view_offset > 0) {
+    if (view->offset > 0) {
         display_handler_writeline(110, 1, "^");
     }
     
     oled_display();
 }
 
+static void display_settings_view(void) {
+    settings_view_t view;
+    
+    // Get current settings
+    uint8_t channel = midi_handler_get_channel();
+    uint8_t semitone = midi_handler_get_semitone_mode();
+    uint8_t player_type = midi_handler_get_player_type();
+    uint8_t note_range = midi_handler_get_note_range();
+    uint8_t low_note = midi_handler_get_low_note();
+    uint8_t high_note = midi_handler_get_high_note();
+    uint8_t io_type = midi_handler_get_io_type();
+    uint8_t io_addr = midi_handler_get_io_address();
+    
+    const char* semitone_names[] = {"PLAY", "IGNORE", "SKIP"};
+    const char* player_names[] = {"I2C MIDI", "Mallet MIDI"};
+    const char* io_type_names[] = {"PCF8574", "CH423"};
+    
+    uint8_t n = 0;
+    snprintf(view.lines[n++], 22, "Channel: %d", channel);
+    snprintf(view.lines[n++], 22, "Player: %s", player_names[player_type]);
+    snprintf(view.lines[n++], 22, "Semitone: %s", semitone_names[semitone]);
+    snprintf(view.lines[n++], 22, "Note Range: %d", note_range);
+    snprintf(view.lines[n++], 22, "Low Note: %d", low_note);
+    snprintf(view.lines[n++], 22, "High Note: %d", high_note);
+    snprintf(view.lines[n++], 22, "I2C Freq: 400kHz");
+    snprintf(view.lines[n++], 22, "IO Type: %s", io_type_names[io_type]);
+    snprintf(view.lines[n++], 22, "IO Addr: 0x%02X", io_addr);
+    view.offset = settings_view_offset;
+    
+    display_handler_show_screen(draw_settings_view, &view, sizeof(view));
+}
+
 //--------------------------------------------------------------------+
 // Menu Handler Implementation
 //--------------------------------------------------------------------+
@@ -113,6 +157,10 @@ bool menu_is_active(void) {
     return menu_active;
 }
 
+menu_option_t menu_get_current(void) {
+    return current_option;
+}
+
 void menu_enter(void) {
     if (menu_active) {
         return;  // Already in menu
@@ -152,10 +200,7 @@ void menu_next(void) {
     
     // If in settings view mode, scroll through settings
     if (settings_view_active) {
-        const uint8_t total_settings = 9;  // Total number of settings
-        const uint8_t max_lines = 6;        // Max lines visible
-        
-        if (settings_view_offset + max_lines < total_settings) {
+        if (settings_view_offset + SETTINGS_VIEW_ROWS < SETTINGS_VIEW_LINES) {
             settings_view_offset++;
             display_settings_view();
             debug_info("MENU: Settings view scroll: offset=%d", settings_view_offset);
@@ -175,7 +220,6 @@ void menu_next(void) {
         display_handler_clear();
         snprintf(msg, sizeof(msg), "Channel: %d", selected_channel);
         display_handler_writeline(30, 28, msg);
-        oled_display();
         
         debug_info("MENU: Channel selection: %d", selected_channel);
         return;
@@ -216,7 +260,7 @@ void menu_execute(void) {
         buzzer_success();  // Play success sound
         debug_info("MENU: MIDI channel set to %d", selected_channel);
         
-        sleep_ms(1500);
+        show_for_ms(1500);
         
         // Exit channel selection mode and return to menu
         channel_selection_active = false;
@@ -241,7 +285,7 @@ void menu_execute(void) {
                 display_handler_writeline(5, 28, "Reset Failed!");
                 debug_error("MENU: Failed to reset configuration");
             }
-            sleep_ms(3500);
+            show_for_ms(3500);
             menu_exit();
             break;
             
@@ -258,7 +302,7 @@ void menu_execute(void) {
                 buzzer_error();  // Play error sound
                 debug_error("MENU: Failed to save configuration");
             }
-            sleep_ms(3000);
+            show_for_ms(3000);
             menu_exit();
             break;
             
@@ -271,7 +315,6 @@ void menu_execute(void) {
             display_handler_clear();
             snprintf(msg, sizeof(msg), "Channel: %d", selected_channel);
             display_handler_writeline(30, 28, msg);
-            oled_display();
             
             debug_info("MENU: Entered channel selection mode (current: %d)", selected_channel);
             break;
@@ -282,7 +325,7 @@ void menu_execute(void) {
             display_handler_writeline(5, 20, "Note Range");
             display_handler_writeline(5, 35, "Use SysEx");
             debug_info("MENU: Note range - use SysEx commands");
-            sleep_ms(1500);
+            show_for_ms(1500);
             menu_update_display();
             break;
             
@@ -300,7 +343,7 @@ void menu_execute(void) {
                 display_handler_writeline(5, 35, msg);
                 debug_info("MENU: Player type set to %s", player_names[player_type]);
             }
-            sleep_ms(1500);
+            show_for_ms(1500);
             menu_update_display();
             break;
             
@@ -318,7 +361,25 @@ void menu_execute(void) {
                 display_handler_writeline(5, 35, msg);
                 debug_info("MENU: Semitone mode set to %s", mode_names[mode]);
             }
-            sleep_ms(1500);
+            show_for_ms(1500);
+            menu_update_display();
+            break;
+            
+        case MENU_OPTION_NOTE_VIEW:
+            // Toggle between the single note screen and the piano roll
+            {
+                display_note_view_t view = display_handler_get_note_view() == DISPLAY_NOTE_VIEW_SINGLE
+                                               ? DISPLAY_NOTE_VIEW_PIANO_ROLL : DISPLAY_NOTE_VIEW_SINGLE;
+                display_handler_set_note_view(view);
+                
+                const char* view_names[] = {"Single Note", "Piano Roll"};
+                snprintf(msg, sizeof(msg), "View: %s", view_names[view]);
+                display_handler_clear();
+                display_handler_writeline(5, 20, "Note View");
+                display_handler_writeline(5, 35, msg);
+                debug_info("MENU: Note view set to %s", view_names[view]);
+            }
+            show_for_ms(1500);
             menu_update_display();
             break;
             
@@ -336,7 +397,7 @@ void menu_execute(void) {
             display_handler_clear();
             display_handler_writeline(5, 28, "All Notes Off!");
             debug_info("MENU: All notes off");
-            sleep_ms(2000);
+            show_for_ms(2000);
             menu_exit();
             break;
             
@@ -349,54 +410,55 @@ void menu_execute(void) {
     }
 }
 
-void menu_update_display(void) {
-    if (!menu_active) {
-        return;
-    }
+// Draw the menu page (see display_handler_show_screen())
+static void draw_menu_page(const void* state) {
+    const menu_page_t* page = (const menu_page_t*)state;
     
-    // Clear the display first
-    display_handler_clear();
-    
-    // Display menu title - centered
-    // "MENU" is 4 chars * 6 pixels = 24 pixels, center at (128-24)/2 = 52
-    display_handler_writeline(52, 1, "MENU");
-    
-    // Draw horizontal line below heading
-    // Position: 1 (top border) + 1 (offset) + 8 (text height) + 1 (space) = 11 pixels from top
-    for (uint8_t x = 1; x < 127; x++) {
-        oled_set_pixel(x, 11, 1);
+    // Draw the static parts only if something else has been on screen
+    // since; otherwise just the three option rows change
+    if (!menu_page_drawn || oled_get_clear_count() != menu_page_clear_count) {
+        display_handler_clear();
+        
+        // Display menu title - centered
+        // "MENU" is 4 chars * 6 pixels = 24 pixels, center at (128-24)/2 = 52
+        oled_draw_string(52, 1, "MENU");
+        
+        // Draw horizontal line below heading
+        // Position: 1 (top border) + 1 (offset) + 8 (text height) + 1 (space) = 11 pixels from top
+        for (uint8_t x = 1; x < 127; x++) {
+            oled_set_pixel(x, 11, 1);
+        }
+        
+        menu_page_drawn = true;
+        menu_page_clear_count = oled_get_clear_count();
     }
-    oled_display();
     
-    // Display current menu option with selection indicator
-    char line[32];
+    // Show 3 options: previous, current (inverted), next
+    // This creates a scrolling menu effect. Column 0 is the border (lit in
+    // both states), so lines are drawn from column 1.
+    // Rows are rendered from the font into menu_rows_shown, which outlives
+    // the call; a row keeps its place there, so one drawn earlier over the
+    // same row shows the same columns.
+    for (uint8_t i = 0; i < 3; i++) {
+        uint8_t row = (i + 1) * 14 + 4;  // Rows at pixels 18, 32, 46
+        
+        render_menu_line(page->options[i], menu_rows_shown[i]);
+        oled_draw_columns(1, row, &menu_rows_shown[i][1], MENU_LINE_COLUMNS - 1, i == 1);
+    }
     
-    // Longest menu name is "Reset Defaults" (15 chars)
-    // With " #. " prefix (4 chars) = 19 chars total, pad to 20 for alignment
-    const uint8_t max_line_len = 20;
+    // One frame: only the bytes that changed go out
+    oled_display();
+}
+
+void menu_update_display(void) {
+    if (!menu_active) {
+        return;
+    }
     
-    // Show 3 options: previous, current (inverted), next
-    // This creates a scrolling menu effect
+    menu_page_t page;
     for (int8_t i = -1; i <= 1; i++) {
-        int8_t option_idx = (current_option + i + MENU_OPTION_COUNT) % MENU_OPTION_COUNT;
-        uint8_t row = (i + 2) * 14 + 4;  // Rows at pixels 18, 32, 46
-        
-        // Format with number: " #. Menu Name"
-        snprintf(line, sizeof(line), " %d. %s", option_idx + 1, menu_names[option_idx]);
-        
-        // Pad with spaces to max_line_len
-        uint8_t len = strlen(line);
-        while (len < max_line_len && len < sizeof(line) - 1) {
-            line[len++] = ' ';
-        }
-        line[len] = '\0';
-        
-        if (i == 0) {
-            // Current selection - show inverted (white background, black text)
-            display_handler_writeline_inverted(0, row, line);
-        } else {
-            // Other options - normal text
-            display_handler_writeline(0, row, line);
-        }
+        page.options[i + 1] = (current_option + i + MENU_OPTION_COUNT) % MENU_OPTION_COUNT;
     }
+    
+    display_handler_show_screen(draw_menu_page, &page, sizeof(page));
 }
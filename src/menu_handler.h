@@ -16,6 +16,7 @@ typedef enum {
     MENU_OPTION_MIDI_CHANNEL,
     MENU_OPTION_NOTE_RANGE,
     MENU_OPTION_SEMITONE_MODE,
+    MENU_OPTION_NOTE_VIEW,
     MENU_OPTION_VIEW_SETTINGS,
     MENU_OPTION_ALL_NOTES_OFF,
     MENU_OPTION_EXIT,
@@ -1,5 +1,7 @@
 #include "midi_handler.h"
 #include "i2c_midi.h"
+#include "i2c_bus.h"
+#include "i2c_trace.h"
 #include "../lib/mallet_midi/mallet_midi.h"
 #include "configuration_settings.h"
 #include "debug_uart.h"
@@ -33,8 +35,8 @@ static uint64_t last_activity_time = 0;
 
 // SysEx message handling
 #define SYSEX_BUFFER_SIZE 32
-#define SYSEX_MANUFACTURER_ID 0x7D  // Educational/development use
-#define SYSEX_DEVICE_ID 0x00        // Device ID for this synthesizer
+#define SYSEX_MANUFACTURER_ID MIDI_SYSEX_MANUFACTURER_ID
+#define SYSEX_DEVICE_ID MIDI_SYSEX_DEVICE_ID
 
 static uint8_t sysex_buffer[SYSEX_BUFFER_SIZE];
 static uint8_t sysex_index = 0;
@@ -60,6 +62,63 @@ static bool sysex_receiving = false;
 #define SYSEX_CMD_CONFIG_SAVE           0xF1
 #define SYSEX_CMD_CONFIG_QUERY          0xF2
 
+// I2C Trace SysEx Commands
+#define SYSEX_CMD_TRACE_PRINT           0x50
+#define SYSEX_CMD_TRACE_QUERY           0x51
+#define SYSEX_CMD_TRACE_RESET           0x52
+#define SYSEX_TRACE_ADDRESS_LIST        0x7F  // Query argument/reply tag for the address list
+
+// Display mirror SysEx Commands (frames go out as DISPLAY_MIRROR_SYSEX_CMD)
+#define SYSEX_CMD_DISPLAY_MIRROR        0x60
+
+//--------------------------------------------------------------------+
+// SysEx Replies
+//--------------------------------------------------------------------+
+
+// Append a value as five 7-bit bytes, least significant first (35 bits)
+static uint8_t sysex_put_u35(uint8_t* buf, uint8_t pos, uint64_t value)
+{
+    for (uint8_t i = 0; i < 5; i++) {
+        buf[pos++] = value & 0x7F;
+        value >>= 7;
+    }
+    return pos;
+}
+
+// Reply with the traffic counters of one address, or the list of active
+// addresses. One reply per query keeps each message inside the USB TX FIFO.
+static void send_trace_reply(uint8_t address)
+{
+    uint8_t reply[64];
+    uint8_t n = 0;
+    
+    reply[n++] = 0xF0;
+    reply[n++] = SYSEX_MANUFACTURER_ID;
+    reply[n++] = SYSEX_DEVICE_ID;
+    reply[n++] = SYSEX_CMD_TRACE_QUERY;
+    reply[n++] = address;
+    
+    if (address == SYSEX_TRACE_ADDRESS_LIST) {
+        i2c_trace_device_stats_t stats;
+        for (uint8_t addr = 0; addr < I2C_TRACE_NUM_ADDRESSES && n < sizeof(reply) - 1; addr++) {
+            if (i2c_trace_get_device_stats(addr, &stats)) {
+                reply[n++] = addr;
+            }
+        }
+    } else {
+        i2c_trace_device_stats_t stats;
+        i2c_trace_get_device_stats(address, &stats);
+        n = sysex_put_u35(reply, n, stats.transactions);
+        n = sysex_put_u35(reply, n, stats.bytes);
+        n = sysex_put_u35(reply, n, stats.errors);
+        n = sysex_put_u35(reply, n, stats.total_time_us);
+        n = sysex_put_u35(reply, n, stats.max_time_us);
+    }
+    
+    reply[n++] = 0xF7;
+    usb_midi_send_sysex(reply, n);
+}
+
 //--------------------------------------------------------------------+
 // SysEx Message Processing
 //--------------------------------------------------------------------+
@@ -140,6 +199,7 @@ static void process_sysex_message(void)
                       i2c_midi_ctx.config.low_note,
                       i2c_midi_ctx.config.high_note,
                       i2c_midi_ctx.config.semitone_mode);
+            i2c_bus_print_stats();
             break;
         
         // Configuration commands with EEPROM persistence
@@ -252,6 +312,34 @@ static void process_sysex_message(void)
             }
             break;
             
+        case SYSEX_CMD_TRACE_PRINT:
+            i2c_trace_print();
+            break;
+            
+        case SYSEX_CMD_TRACE_QUERY: {
+            // F0 7D 00 51 F7 lists active addresses, F0 7D 00 51 <addr> F7 returns counters
+            uint8_t address = (sysex_index >= 6) ? (sysex_buffer[4] & 0x7F) : SYSEX_TRACE_ADDRESS_LIST;
+            send_trace_reply(address);
+            break;
+        }
+            
+        case SYSEX_CMD_TRACE_RESET:
+            i2c_trace_reset();
+            debug_info("SysEx: I2C trace reset");
+            break;
+            
+        case SYSEX_CMD_DISPLAY_MIRROR: {
+            // F0 7D 00 60 <0|1> F7; the reply echoes the new state, and
+            // on 1 the host clears its copy before the frame data follows
+            bool enabled = (sysex_index >= 6) && sysex_buffer[4] != 0;
+            display_handler_set_mirror(enabled);
+            uint8_t reply[] = { 0xF0, SYSEX_MANUFACTURER_ID, SYSEX_DEVICE_ID,
+                                SYSEX_CMD_DISPLAY_MIRROR, enabled ? 1 : 0, 0xF7 };
+            usb_midi_send_sysex(reply, sizeof(reply));
+            debug_info("SysEx: Display mirror %s", enabled ? "on" : "off");
+            break;
+        }
+            
         default:
             debug_error("SysEx: Unknown command 0x%02X", command);
             break;
@@ -307,7 +395,7 @@ static void internal_midi_handler(uint8_t status, uint8_t data1, uint8_t data2,
     }
     else if (msg_type == 0x80 || (msg_type == 0x90 && data2 == 0)) // Note Off
     {
-        // Could clear display or show "Note Off" message if desired
+        display_handler_note_off(data1);
     }
     
     // Handle LED feedback if enabled
@@ -330,8 +418,15 @@ static void internal_midi_handler(uint8_t status, uint8_t data1, uint8_t data2,
 // Public API Implementation
 //--------------------------------------------------------------------+
 
+// IO expanders run at their own maximum, capped by the actuator clock
+static uint32_t io_expander_freq(io_expander_type_t io_type, uint32_t actuator_freq)
+{
+    uint32_t max_freq = i2c_midi_get_io_max_freq(io_type);
+    return (max_freq < actuator_freq) ? max_freq : actuator_freq;
+}
+
 bool midi_handler_init(void* i2c_inst, uint8_t sda_pin, uint8_t scl_pin, 
-                       uint32_t i2c_freq, uint8_t led_pin, 
+                       uint32_t i2c_freq, uint32_t actuator_freq, uint8_t led_pin, 
                        i2c_midi_semitone_mode_t semitone_mode)
 {
     debug_info("MIDI Handler: Initializing...");
@@ -339,11 +434,11 @@ bool midi_handler_init(void* i2c_inst, uint8_t sda_pin, uint8_t scl_pin,
     // CRITICAL FIX: Initialize I2C bus FIRST before accessing any I2C devices
     // This prevents system hang when trying to read EEPROM on uninitialized bus
     i2c_inst_t *i2c_port = (i2c_inst_t*)i2c_inst;
-    i2c_init(i2c_port, i2c_freq);
-    gpio_set_function(sda_pin, GPIO_FUNC_I2C);
-    gpio_set_function(scl_pin, GPIO_FUNC_I2C);
-    gpio_pull_up(sda_pin);
-    gpio_pull_up(scl_pin);
+    if (!i2c_bus_init(i2c_port, sda_pin, scl_pin, i2c_freq)) {
+        debug_error("MIDI Handler: Failed to initialize I2C bus");
+        return false;
+    }
+    i2c_bus_set_role(I2C_BUS_ROLE_ACTUATORS, i2c_port);
     debug_info("MIDI Handler: I2C bus initialized at %d Hz", i2c_freq);
     
     // Small delay to allow I2C bus to stabilize
@@ -351,7 +446,8 @@ bool midi_handler_init(void* i2c_inst, uint8_t sda_pin, uint8_t scl_pin,
     
     // Now try to initialize configuration manager with EEPROM
     // Using AT24C32 (4KB) at address 0x50, storing config at address 0x0000
-    if (config_init(&config_mgr, i2c_port, 0x50, 4, 0x0000)) {
+    // The EEPROM lives on the peripheral bus (same as i2c_port unless dual-bus)
+    if (config_init(&config_mgr, i2c_bus_get_role(I2C_BUS_ROLE_PERIPHERALS), 0x50, 4, 0x0000)) {
         config_initialized = true;
         debug_info("MIDI Handler: Configuration loaded from EEPROM");
         
@@ -403,6 +499,10 @@ bool midi_handler_init(void* i2c_inst, uint8_t sda_pin, uint8_t scl_pin,
                 .semitone_mode = (i2c_midi_semitone_mode_t)settings->semitone_mode
             };
             
+            // Register the expander speed before the driver sends its first write
+            i2c_bus_set_device_speed(i2c_port, midi_config.io_address,
+                                     io_expander_freq(midi_config.io_type, actuator_freq));
+            
             if (!i2c_midi_init_with_config(&i2c_midi_ctx, &midi_config, sda_pin, scl_pin, i2c_freq)) {
                 debug_error("MIDI Handler: Failed to initialize I2C MIDI with stored config");
                 config_initialized = false;
@@ -415,6 +515,13 @@ bool midi_handler_init(void* i2c_inst, uint8_t sda_pin, uint8_t scl_pin,
         
         // Fallback to default initialization
         // Note: I2C bus is already initialized above
+#ifdef USE_PCF857X_DRIVER
+        i2c_bus_set_device_speed(i2c_port, PCF857X_DEFAULT_ADDRESS,
+                                 io_expander_freq(IO_EXPANDER_PCF8574, actuator_freq));
+#elif defined(USE_CH423_DRIVER)
+        i2c_bus_set_device_speed(i2c_port, CH423_DEFAULT_ADDRESS,
+                                 io_expander_freq(IO_EXPANDER_CH423, actuator_freq));
+#endif
         if (!i2c_midi_init(&i2c_midi_ctx, i2c_inst, sda_pin, scl_pin, i2c_freq)) {
             debug_error("MIDI Handler: Failed to initialize I2C MIDI");
             return false;
@@ -437,8 +544,8 @@ bool midi_handler_init(void* i2c_inst, uint8_t sda_pin, uint8_t scl_pin,
         debug_info("MIDI Handler: LED feedback disabled");
     }
     
-    debug_info("MIDI Handler: I2C MIDI initialized (SDA=GP%d, SCL=GP%d, Freq=%dHz)", 
-               sda_pin, scl_pin, i2c_freq);
+    debug_info("MIDI Handler: I2C MIDI initialized (SDA=GP%d, SCL=GP%d, Freq=%dHz, Actuators=%dHz)", 
+               sda_pin, scl_pin, i2c_freq, actuator_freq);
     
     return true;
 }
@@ -658,4 +765,10 @@ uint8_t midi_handler_get_io_type(void)
 uint8_t midi_handler_get_io_address(void)
 {
     return i2c_midi_ctx.config.io_address;
+}
+
+uint8_t midi_handler_get_display_timeout(void)
+{
+    config_settings_t *settings = config_initialized ? config_get_settings(&config_mgr) : NULL;
+    return settings ? settings->display_timeout : 30;  // Firmware default without EEPROM
 }
\ No newline at end of file
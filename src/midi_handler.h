@@ -5,21 +5,30 @@
 #include <stdbool.h>
 #include "../lib/i2c_midi/i2c_midi.h"
 
+// SysEx framing: F0 <manufacturer> <device> <command> ... F7 (see SYSEX_COMMANDS.md)
+#define MIDI_SYSEX_MANUFACTURER_ID 0x7D  // Educational/development use
+#define MIDI_SYSEX_DEVICE_ID       0x00  // Device ID for this synthesizer
+
 /**
  * @brief Initialize MIDI handler
  * 
  * Initializes the MIDI message handler with I2C MIDI support and LED feedback.
+ * The I2C bus given here becomes the actuator bus. The configuration EEPROM is
+ * accessed on the peripheral bus, which must be initialized and assigned with
+ * i2c_bus_set_role() beforehand in a dual-bus build.
  * 
  * @param i2c_inst I2C instance for MIDI output (i2c0 or i2c1)
  * @param sda_pin GPIO pin for I2C SDA
  * @param scl_pin GPIO pin for I2C SCL
  * @param i2c_freq I2C frequency in Hz (e.g., 100000 for 100kHz)
+ * @param actuator_freq Highest I2C frequency in Hz for the IO expander; it runs at
+ *                      the lower of this and its chip maximum (400kHz for PCF8575/CH423)
  * @param led_pin GPIO pin for LED feedback (use 0xFF to disable LED)
  * @param semitone_mode Semitone handling mode (PLAY, IGNORE, or SKIP)
  * @return true if initialization successful, false otherwise
  */
 bool midi_handler_init(void* i2c_inst, uint8_t sda_pin, uint8_t scl_pin, 
-                       uint32_t i2c_freq, uint8_t led_pin, 
+                       uint32_t i2c_freq, uint32_t actuator_freq, uint8_t led_pin, 
                        i2c_midi_semitone_mode_t semitone_mode);
 
 /**
@@ -137,6 +146,13 @@ uint8_t midi_handler_get_io_type(void);
  */
 uint8_t midi_handler_get_io_address(void);
 
+/**
+ * @brief Get the display timeout from the configuration
+ * 
+ * @return Seconds without activity before the screensaver starts (0=never)
+ */
+uint8_t midi_handler_get_display_timeout(void);
+
 /**
  * @brief Send all notes off on all channels
  */
@@ -1,6 +1,9 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#ifdef OLED_SPI
+#include "hardware/spi.h"
+#endif
 #include "usb_midi.h"
 #include "midi_handler.h"
 #include "debug_uart.h"
@@ -8,6 +11,8 @@
 #include "button_handler.h"
 #include "menu_handler.h"
 #include "buzzer.h"
+#include "i2c_bus.h"
+#include "midi_synthesizer.h"
 
 //--------------------------------------------------------------------+
 // Hardware Configuration
@@ -22,18 +27,53 @@
 #define DEBUG_UART_RX_PIN   1
 #define DEBUG_UART_BAUD     115200
 
-// I2C MIDI Configuration
+// I2C Bus Topology (set by CMake option I2C_DUAL_BUS)
+// 0 = OLED and EEPROM share i2c1 with the actuators
+// 1 = OLED and EEPROM on i2c0, actuators have i2c1 to themselves
+#ifndef I2C_DUAL_BUS
+#define I2C_DUAL_BUS        0
+#endif
+
+// I2C MIDI Configuration (actuator bus)
 #define I2C_MIDI_INSTANCE   i2c1
 #define I2C_MIDI_SDA_PIN    2
 #define I2C_MIDI_SCL_PIN    3
-#define I2C_MIDI_FREQ       400000
+#define I2C_ACTUATOR_FREQ   1000000 // PCA9685 (Fast-mode Plus); expanders cap at their chip maximum
+#if I2C_DUAL_BUS
+#define I2C_MIDI_FREQ       I2C_ACTUATOR_FREQ  // Actuators only - no speed switching
+#else
+#define I2C_MIDI_FREQ       400000  // Bus default (EEPROM, OLED)
+#endif
+
+// Peripheral I2C Configuration (OLED display and EEPROM)
+#if I2C_DUAL_BUS
+#define I2C_PERIPH_INSTANCE i2c0
+#define I2C_PERIPH_SDA_PIN  20
+#define I2C_PERIPH_SCL_PIN  21
+#define I2C_PERIPH_FREQ     400000
+#else
+#define I2C_PERIPH_INSTANCE I2C_MIDI_INSTANCE  // Share I2C bus with MIDI
+#endif
+
+// OLED on SPI (set by CMake option OLED_SPI), pins in oled_display.h
+#ifdef OLED_SPI
+#define OLED_SPI_INSTANCE   spi1
+#endif
+
+// PIO I2C Actuator Buses (set by CMake option USE_PIO_I2C)
+// Devices are moved onto these with the pio_bus field of their config
+#ifdef I2C_BUS_USE_PIO
+// A PIO bus has one speed for all its devices: bus 1 for IO expanders
+// (at most 400 kHz), bus 2 for PCA9685 boards
+#define PIO_I2C_BUS1_FREQ       400000
+#define PIO_I2C_BUS2_FREQ       I2C_ACTUATOR_FREQ
+#define PIO_I2C_BUS1_SDA_PIN    6       // SCL on GP7
+#define PIO_I2C_BUS2_SDA_PIN    8       // SCL on GP9
+#endif
 
 // MIDI Semitone Handling
 #define SEMITONE_MODE       I2C_MIDI_SEMITONE_SKIP  // Options: I2C_MIDI_SEMITONE_PLAY, I2C_MIDI_SEMITONE_IGNORE, I2C_MIDI_SEMITONE_SKIP
 
-// OLED Display Configuration
-#define OLED_I2C_INSTANCE   I2C_MIDI_INSTANCE  // Share I2C bus with MIDI
-
 // LED Feedback Configuration
 #define LED_PIN             25
 
@@ -81,9 +121,9 @@ void handle_button_event(button_event_t event) {
 }
 
 //--------------------------------------------------------------------+
-// Main Entry Point
+// Firmware Setup and Main Loop
 //--------------------------------------------------------------------+
-int main()
+bool midi_synthesizer_setup(uint32_t* blink_ms)
 {
     // Initialize debug UART
     debug_uart_init(DEBUG_UART, DEBUG_UART_TX_PIN, DEBUG_UART_RX_PIN, DEBUG_UART_BAUD);
@@ -100,24 +140,38 @@ int main()
         debug_info("Buzzer initialized on GPIO %d", BUZZER_PIN);
     }
     
+#if I2C_DUAL_BUS
+    // Bring up the peripheral bus first - the MIDI handler loads its
+    // configuration from the EEPROM on this bus
+    if (!i2c_bus_init(I2C_PERIPH_INSTANCE, I2C_PERIPH_SDA_PIN, I2C_PERIPH_SCL_PIN, I2C_PERIPH_FREQ)) {
+        debug_error("Failed to initialize peripheral I2C bus");
+    }
+#endif
+    i2c_bus_set_role(I2C_BUS_ROLE_PERIPHERALS, I2C_PERIPH_INSTANCE);
+    
+#ifdef I2C_BUS_USE_PIO
+    // Extra actuator buses - must be up before any device is routed to them
+    i2c_bus_init_pio(1, PIO_I2C_BUS1_SDA_PIN, PIO_I2C_BUS1_FREQ);
+    i2c_bus_init_pio(2, PIO_I2C_BUS2_SDA_PIN, PIO_I2C_BUS2_FREQ);
+#endif
+    
     // Initialize MIDI handler with I2C MIDI and LED feedback
     if (!midi_handler_init(I2C_MIDI_INSTANCE, I2C_MIDI_SDA_PIN, I2C_MIDI_SCL_PIN, 
-                          I2C_MIDI_FREQ, LED_PIN, SEMITONE_MODE)) {
+                          I2C_MIDI_FREQ, I2C_ACTUATOR_FREQ, LED_PIN, SEMITONE_MODE)) {
         debug_error("Failed to initialize MIDI handler");
         buzzer_error();  // Play error sound
-        // Blink LED rapidly to indicate error
-        gpio_init(LED_PIN);
-        gpio_set_dir(LED_PIN, GPIO_OUT);
-        while (true) {
-            gpio_put(LED_PIN, 1);
-            sleep_ms(100);
-            gpio_put(LED_PIN, 0);
-            sleep_ms(100);
+        if (blink_ms) {
+            *blink_ms = MIDI_SYNTHESIZER_BLINK_MIDI_ERROR_MS;  // Blink LED rapidly
         }
+        return false;
     }
     
     // Initialize Display Handler
-    if (!display_handler_init(OLED_I2C_INSTANCE)) {
+#ifdef OLED_SPI
+    if (!display_handler_init(OLED_SPI_INSTANCE)) {
+#else
+    if (!display_handler_init(i2c_bus_get_role(I2C_BUS_ROLE_PERIPHERALS))) {
+#endif
         debug_error("Failed to initialize Display Handler");
     }
     
@@ -141,15 +195,10 @@ int main()
     // Initialize USB MIDI subsystem
     if (!usb_midi_init()) {
         debug_error("Failed to initialize USB MIDI");
-        // Blink LED slowly to indicate error
-        gpio_init(LED_PIN);
-        gpio_set_dir(LED_PIN, GPIO_OUT);
-        while (true) {
-            gpio_put(LED_PIN, 1);
-            sleep_ms(500);
-            gpio_put(LED_PIN, 0);
-            sleep_ms(500);
+        if (blink_ms) {
+            *blink_ms = MIDI_SYNTHESIZER_BLINK_USB_ERROR_MS;  // Blink LED slowly
         }
+        return false;
     }
     debug_info("USB MIDI initialized");
     
@@ -161,27 +210,61 @@ int main()
     
     //debug_info("MIDI Synthesizer Ready!");
     debug_info("Waiting for USB connection...");
+    
+    return true;
+}
+
+void midi_synthesizer_poll(void)
+{
+    // Update button state
+    button_update();
+    
+    // Process USB and MIDI tasks
+    usb_midi_task();
+    
+    // Update MIDI handler (for mallet striker timing)
+    midi_handler_update();
+    
+    // Check if timer has triggered screensaver timeout
+    display_handler_check_timeout();
+    
+    // Update screensaver if active
+    if (display_handler_is_screensaver_active()) {
+        display_handler_screensaver_update();
+    }
+    
+    // Send the next slice of any pending display frame
+    display_handler_task();
+    
+    // Add a small delay to prevent tight loop
+    sleep_us(100);
+}
+
+//--------------------------------------------------------------------+
+// Main Entry Point
+//--------------------------------------------------------------------+
+// The host simulator (host/) links the setup and loop above and drives
+// them itself, so it builds without main()
+#ifndef MIDI_SYNTHESIZER_NO_MAIN
+int main()
+{
+    uint32_t blink_ms = 0;
+    
+    if (!midi_synthesizer_setup(&blink_ms)) {
+        // Blink LED to indicate which init step failed
+        gpio_init(LED_PIN);
+        gpio_set_dir(LED_PIN, GPIO_OUT);
+        while (true) {
+            gpio_put(LED_PIN, 1);
+            sleep_ms(blink_ms);
+            gpio_put(LED_PIN, 0);
+            sleep_ms(blink_ms);
+        }
+    }
    
     // Main loop
     while (true) {
-        // Update button state
-        button_update();
-        
-        // Process USB and MIDI tasks
-        usb_midi_task();
-        
-        // Update MIDI handler (for mallet striker timing)
-        midi_handler_update();
-        
-        // Check if timer has triggered screensaver timeout
-        display_handler_check_timeout();
-        
-        // Update screensaver if active
-        if (display_handler_is_screensaver_active()) {
-            display_handler_screensaver_update();
-        }
-        
-        // Add a small delay to prevent tight loop
-        sleep_us(100);
+        midi_synthesizer_poll();
     }
 }
+#endif
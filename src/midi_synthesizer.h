@@ -0,0 +1,34 @@
+#ifndef MIDI_SYNTHESIZER_H
+#define MIDI_SYNTHESIZER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Error LED blink half-periods used by main() when setup fails
+ */
+#define MIDI_SYNTHESIZER_BLINK_MIDI_ERROR_MS  100   // MIDI handler failed
+#define MIDI_SYNTHESIZER_BLINK_USB_ERROR_MS   500   // USB MIDI failed
+
+/**
+ * @brief Initialize all firmware modules
+ * 
+ * Everything main() does before entering the main loop: debug UART,
+ * buzzer, I2C buses, MIDI handler, display, button, menu and USB MIDI,
+ * followed by the boot melody.
+ * 
+ * @param blink_ms Set to the error LED half-period if setup fails (may be NULL)
+ * @return true if the firmware is ready, false on a fatal error
+ */
+bool midi_synthesizer_setup(uint32_t* blink_ms);
+
+/**
+ * @brief Run one iteration of the main loop
+ * 
+ * Button, USB MIDI, MIDI handler and display updates followed by the
+ * 100us loop delay. main() calls this forever; the host simulator calls
+ * it against a virtual clock.
+ */
+void midi_synthesizer_poll(void);
+
+#endif // MIDI_SYNTHESIZER_H
@@ -192,3 +192,21 @@ int usb_midi_send_raw(const uint8_t* data, uint8_t length)
     
     return tud_midi_stream_write(0, data, length);
 }
+
+int usb_midi_send_sysex(const uint8_t* data, uint16_t length)
+{
+    if (!usb_mounted || !data || length < 2 || data[0] != 0xF0 || data[length - 1] != 0xF7) {
+        return 0;
+    }
+    
+    return tud_midi_stream_write(0, data, length);
+}
+
+int usb_midi_send_sysex_part(const uint8_t* data, uint16_t length)
+{
+    if (!usb_mounted || !data || length == 0) {
+        return 0;
+    }
+    
+    return tud_midi_stream_write(0, data, length);
+}
@@ -95,4 +95,25 @@ int usb_midi_send_pitch_bend(uint8_t channel, uint16_t value);
  */
 int usb_midi_send_raw(const uint8_t* data, uint8_t length);
 
+/**
+ * @brief Send a SysEx message
+ * 
+ * @param data Complete message including the F0 and F7 framing bytes
+ * @param length Number of bytes to send
+ * @return Number of bytes sent, or 0 if failed
+ */
+int usb_midi_send_sysex(const uint8_t* data, uint16_t length);
+
+/**
+ * @brief Send the next part of a SysEx message
+ * 
+ * The USB FIFO takes as much of a message as fits. Hand it the rest,
+ * from where the last call stopped, to carry on with the same message.
+ * 
+ * @param data Bytes not yet taken
+ * @param length Number of bytes
+ * @return Number of bytes taken (0 if the FIFO is full)
+ */
+int usb_midi_send_sysex_part(const uint8_t* data, uint16_t length);
+
 #endif // USB_MIDI_H